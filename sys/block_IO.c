@@ -169,6 +169,7 @@
 # include "bios.h"
 # include "info.h"
 # include "k_prot.h"
+# include "k_kthread.h"
 # include "kmemory.h"
 # include "pun.h"
 # include "proc.h"
@@ -265,6 +266,10 @@ static void	_cdecl bio_rel_resident	(UNIT *u);
 /* remove explicitly a cache unit without writing */
 static void	_cdecl bio_remove	(UNIT *u);
 
+/* asynchronous block I/O */
+static long	_cdecl bio_submit	(BIO_REQ *req);
+static long	_cdecl bio_wait		(BIO_REQ *req);
+
 BIO bio =
 {
 	BLOCK_IO_VERS, BLOCK_IO_REV, bio_config,
@@ -276,7 +281,8 @@ BIO bio =
 	bio_mark_modified, bio_sync_drv,
 	bio_validate, bio_invalidate,
 	bio_get_resident, bio_rel_resident,
-	bio_remove
+	bio_remove,
+	bio_submit, bio_wait
 };
 
 /* cache block */
@@ -355,6 +361,15 @@ static void	bio_unit_remove		(register UNIT *u);
 static UNIT *	bio_unit_get		(DI *di, ulong sector, ulong size, long *err);
 
 
+/* asynchronous request queue */
+
+INLINE int	bio_rq_adjacent		(BIO_REQ *a, BIO_REQ *b);
+static void	bio_rq_end		(BIO_REQ *req, long res);
+static void	bio_rq_run		(DI *di);
+static void	_cdecl bio_rq_thread	(void *arg);
+static void	bio_rq_flush		(DI *di);
+
+
 /* debugging functions */
 
 # ifndef BLOCK_IO_DEBUG
@@ -1860,6 +1875,7 @@ bio_free_di (DI *di)
 	BIO_DEBUG (("bio_free_di: di->lock = %u", di->lock));
 	BIO_ASSERT ((di->valid == 1));
 
+	bio_rq_flush (di);
 	bio_invalidate (di);
 
 	if (di->mode & BIO_REMOVABLE)
@@ -2278,6 +2294,281 @@ bio_pre_read (DI *di, ulong *sector, ulong blocks, ulong blocksize)
 /* END optional feature */
 /****************************************************************************/
 
+/****************************************************************************/
+/* BEGIN asynchronous request queue */
+
+/*
+ * Requests are queued per device sorted by sector and processed by
+ * the "bio" kernel thread. XHDI and SCSIDRV transfers are synchronous,
+ * so the thread does the transfers on behalf of the submitter and
+ * calls the completion callbacks.
+ */
+
+static struct proc *rq_proc = NULL;	/* the request thread */
+static long rq_pending = 0;		/* queued requests on all devices */
+
+INLINE int
+bio_rq_adjacent (BIO_REQ *a, BIO_REQ *b)
+{
+	return (a->rw == b->rw)
+		&& (a->blocksize == b->blocksize)
+		&& ((a->sector + a->blocks * (a->blocksize >> a->di->p_l_shift)) == b->sector);
+}
+
+static void
+bio_rq_end (BIO_REQ *req, long res)
+{
+	DI *di = req->di;
+
+	req->res = res;
+	req->state = BIO_REQ_DONE;
+
+	wake (IO_Q, (long) req);
+
+	/* must be the last access, the callback may release req */
+	if (req->done)
+		(*req->done)(req);
+
+	rq_pending--;
+	if (--di->rq_count == 0)
+		wake (IO_Q, (long) &di->rq_count);
+}
+
+/*
+ * process all requests currently queued on di in one ascending sweep;
+ * requests submitted meanwhile are processed by the next sweep
+ *
+ * ATTENTION: this function can/will block!
+ */
+
+static void
+bio_rq_run (DI *di)
+{
+	BIO_REQ *rq = di->rq_queue;
+
+	di->rq_queue = NULL;
+
+	while (rq)
+	{
+		BIO_REQ *last = rq;
+		BIO_REQ *next;
+		ulong blocks = rq->blocks;
+		ulong size = rq->blocks * rq->blocksize;
+		long direct = 1;
+		long r;
+
+		rq->state = BIO_REQ_ACTIVE;
+
+		/* collect the adjacent requests; requests with
+		 * scattered buffers are bounced through the buffer
+		 */
+		while ((next = last->next) && bio_rq_adjacent (last, next))
+		{
+			ulong nsize = next->blocks * next->blocksize;
+
+			if (direct && ((char *) last->buf + last->blocks * last->blocksize) == next->buf)
+				;
+			else if ((size + nsize) <= WB_BUFFER)
+				direct = 0;
+			else
+				break;
+
+			next->state = BIO_REQ_ACTIVE;
+
+			blocks += next->blocks;
+			size += nsize;
+			last = next;
+		}
+
+		BIO_DEBUG (("bio_rq_run [%c]: sector %lu, %lu bytes, %s", di->drv+'A', rq->sector, size, direct ? "direct" : "buffered"));
+
+		if (direct)
+		{
+			if (rq->rw)
+				r = bio_l_write (di, rq->sector, blocks, rq->blocksize, rq->buf);
+			else
+				r = bio_l_read (di, rq->sector, blocks, rq->blocksize, rq->buf);
+		}
+		else
+		{
+			BIO_REQ *t;
+			char *ptr;
+
+			buffer_lock ();
+
+			if (rq->rw)
+			{
+				for (t = rq, ptr = buffer; ; t = t->next)
+				{
+					register ulong tsize = t->blocks * t->blocksize;
+
+					quickmovb (ptr, t->buf, tsize);
+					ptr += tsize;
+
+					if (t == last)
+						break;
+				}
+
+				r = bio_l_write (di, rq->sector, blocks, rq->blocksize, buffer);
+			}
+			else
+			{
+				r = bio_l_read (di, rq->sector, blocks, rq->blocksize, buffer);
+				if (!r)
+				{
+					for (t = rq, ptr = buffer; ; t = t->next)
+					{
+						register ulong tsize = t->blocks * t->blocksize;
+
+						quickmovb (t->buf, ptr, tsize);
+						ptr += tsize;
+
+						if (t == last)
+							break;
+					}
+				}
+			}
+
+			buffer_unlock ();
+		}
+
+		/* complete the run; next pointers must be read first */
+		next = last->next;
+		for (;;)
+		{
+			BIO_REQ *t = rq->next;
+			int end = (rq == last);
+
+			bio_rq_end (rq, r);
+
+			if (end)
+				break;
+
+			rq = t;
+		}
+
+		rq = next;
+	}
+}
+
+static void _cdecl
+bio_rq_thread (void *arg)
+{
+	UNUSED (arg);
+
+	for (;;)
+	{
+		long i;
+
+		while (!rq_pending)
+			sleep (IO_Q, (long) &rq_pending);
+
+		for (i = 0; i < NUM_DRIVES; i++)
+		{
+			DI *di = &(bio_di [i]);
+
+			if (di->rq_queue)
+				bio_rq_run (di);
+		}
+	}
+}
+
+/*
+ * wait until all requests of di are completed
+ *
+ * ATTENTION: this function can/will block!
+ */
+
+static void
+bio_rq_flush (DI *di)
+{
+	while (di->rq_count)
+	{
+		/* called from a completion callback */
+		if (curproc == rq_proc)
+		{
+			if (!di->rq_queue)
+				break;
+
+			bio_rq_run (di);
+			continue;
+		}
+
+		sleep (IO_Q, (long) &di->rq_count);
+	}
+}
+
+static long _cdecl
+bio_submit (BIO_REQ *req)
+{
+	DI *di = req->di;
+	BIO_REQ **rqp;
+
+	BIO_DEBUG (("bio_submit: entry (sector = %lu, drv = %u, blocks = %lu, rw = %u)", req->sector, di->drv, req->blocks, req->rw));
+
+	if (!di->valid || !req->blocks || !(req->blocksize >> di->p_l_shift))
+		return EINVAL;
+
+	if (!rq_proc)
+	{
+		long r;
+
+		r = kthread_create (NULL, bio_rq_thread, NULL, &rq_proc, "bio");
+		if (r)
+		{
+			BIO_ALERT (("block_IO: can't create request thread (%li), fall back to synchronous I/O", r));
+			rq_proc = NULL;
+		}
+	}
+
+	req->state = BIO_REQ_QUEUED;
+	req->res = E_OK;
+
+	/* sorted insert, equal sectors keep the submission order */
+	rqp = &(di->rq_queue);
+	while (*rqp && (*rqp)->sector <= req->sector)
+		rqp = &((*rqp)->next);
+
+	req->next = *rqp;
+	*rqp = req;
+
+	di->rq_count++;
+	rq_pending++;
+
+	if (rq_proc)
+		wake (IO_Q, (long) &rq_pending);
+	else
+		bio_rq_run (di);
+
+	return E_OK;
+}
+
+static long _cdecl
+bio_wait (BIO_REQ *req)
+{
+	while (req->state != BIO_REQ_DONE)
+	{
+		/* called from a completion callback; a request
+		 * of the active sweep can't be waited for
+		 */
+		if (curproc == rq_proc)
+		{
+			if (!req->di->rq_queue)
+				return EDEADLK;
+
+			bio_rq_run (req->di);
+			continue;
+		}
+
+		sleep (IO_Q, (long) req);
+	}
+
+	return req->res;
+}
+
+/* END asynchronous request queue */
+/****************************************************************************/
+
 /****************************************************************************/
 /* BEGIN synchronization */
 
@@ -2346,6 +2637,9 @@ bio_sync_drv (DI *di)
 {
 	BIO_DEBUG (("bio_sync_drv: sync %c:", 'A' + di->drv));
 
+	/* pending requests */
+	bio_rq_flush (di);
+
 	/* writeback queue */
 	bio_wb_queue (di);
 
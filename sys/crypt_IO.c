@@ -29,7 +29,8 @@
  *
  *
  * Routines to de/encrypt blocks read/written in block_IO.c. The actual
- * cryptographic code (Blowfish) is in blowfish.c.
+ * cryptographic code is in blowfish.c and aes.c; the ciphers are
+ * selected per drive through the table below.
  *
  * History:
  * 2000-05-29: - crypt_block() now gets the physical record number, adapted
@@ -54,6 +55,7 @@
 # include "crypt_IO.h"
 # include "global.h"
 
+# include "libkern/aes.h"
 # include "libkern/blowfish.h"
 # include "libkern/libkern.h"
 # include "libkern/md5.h"
@@ -78,6 +80,48 @@ init_crypt_IO (void)
 
 # ifdef CRYPTO_CODE
 
+/* a cipher as selected by Dsetkey() */
+struct cipher
+{
+	const char *name;
+	void (*setkey)(CRYPT_KEY *key, const char *passphrase);
+	void (*encipher)(CRYPT_KEY *key, char *buf, ulong size, ulong rec, ulong secsize);
+	void (*decipher)(CRYPT_KEY *key, char *buf, ulong size, ulong rec, ulong secsize);
+};
+
+struct crypt_key
+{
+	const struct cipher *cipher;
+	union
+	{
+		BF_KEY		bf;
+		struct
+		{
+			struct aes_key	data_enc;
+			struct aes_key	data_dec;
+			struct aes_key	tweak;
+		} xts;
+	} u;
+};
+
+/*
+ * passphrase_hash
+ *
+ * Derives 128 key bits from the passphrase. salt is NULL for the first
+ * key, further keys are derived with the previous one as salt.
+ */
+static void
+passphrase_hash (const char *passphrase, const uchar *salt, uchar hash[16])
+{
+	struct MD5Context md5sum;
+
+	MD5Init (&md5sum);
+	if (salt)
+		MD5Update (&md5sum, salt, 16);
+	MD5Update (&md5sum, (const uchar *) passphrase, strlen (passphrase));
+	MD5Final (hash, &md5sum);
+}
+
 /*
  * cbc_encipher
  *
@@ -154,15 +198,14 @@ byte_copy (char *to, char *from, short bytes)
  * buf: Pointer to the buffer which is to be en/decrypted
  * size: How many bytes are in buf?
  * rec: The (physical!) starting record of buf on the drive
- * DI: The diskinfo structure of the drive
+ * blocksize: The physical sector size of the drive
  */
 static void
-crypt_block (BF_KEY *bfk, void (*crypt)(BF_KEY *, ulong *, ulong *), char *buf, ulong size, ulong rec, DI *di)
+crypt_block (BF_KEY *bfk, void (*crypt)(BF_KEY *, ulong *, ulong *), char *buf, ulong size, ulong rec, ulong blocksize)
 {
 	ulong feedback[2];
 	ulong count;
 	ulong block;
-	ulong blocksize;
 
 	/* Paranoia */
 	assert (((size % 8) == 0));
@@ -171,7 +214,6 @@ crypt_block (BF_KEY *bfk, void (*crypt)(BF_KEY *, ulong *, ulong *), char *buf,
 	feedback[0] = 0;
 	feedback[1] = block = rec;
 	count = 0;
-	blocksize = di->pssize;
 
 # ifdef M68000	/* No, bez jaj... */
 	if (((ulong) buf & 1L) && (mcpu < 20))
@@ -228,6 +270,149 @@ crypt_block (BF_KEY *bfk, void (*crypt)(BF_KEY *, ulong *, ulong *), char *buf,
 	}
 }
 
+static void
+bf_setkey (CRYPT_KEY *key, const char *passphrase)
+{
+	uchar hash [16];
+
+	passphrase_hash (passphrase, NULL, hash);
+	Blowfish_initialize (&key->u.bf, hash, 16);
+
+	mint_bzero (hash, sizeof (hash));
+}
+
+static void
+bf_encipher (CRYPT_KEY *key, char *buf, ulong size, ulong rec, ulong secsize)
+{
+	crypt_block (&key->u.bf, cbc_encipher, buf, size, rec, secsize);
+}
+
+static void
+bf_decipher (CRYPT_KEY *key, char *buf, ulong size, ulong rec, ulong secsize)
+{
+	crypt_block (&key->u.bf, cbc_decipher, buf, size, rec, secsize);
+}
+
+/*
+ * AES-128 in XTS mode (IEEE P1619)
+ *
+ * Every 16 byte block of a sector is XORed with a tweak before and
+ * after the encryption. The tweak of the first block is the encrypted
+ * sector number, and is multiplied by alpha in GF(2^128) from block
+ * to block. Unlike CBC there is no chaining, each block of a sector can
+ * be handled on its own, and identical plaintext never shows up as
+ * identical ciphertext at a different place on the drive.
+ *
+ * Data and tweak key are the passphrase hash and the hash of both.
+ */
+static void
+xts_setkey (CRYPT_KEY *key, const char *passphrase)
+{
+	uchar data [16];
+	uchar tweak [16];
+
+	passphrase_hash (passphrase, NULL, data);
+	passphrase_hash (passphrase, data, tweak);
+
+	AES_set_encrypt_key (&key->u.xts.data_enc, data);
+	AES_set_decrypt_key (&key->u.xts.data_dec, data);
+	AES_set_encrypt_key (&key->u.xts.tweak, tweak);
+
+	mint_bzero (data, sizeof (data));
+	mint_bzero (tweak, sizeof (tweak));
+}
+
+/* tweak * alpha, little endian as the sector number */
+INLINE void
+xts_next_tweak (uchar *t)
+{
+	uchar carry = t[15] & 0x80;
+	short i;
+
+	for (i = 15; i > 0; i--)
+		t[i] = (t[i] << 1) | (t[i - 1] >> 7);
+
+	t[0] = (t[0] << 1) ^ (carry ? 0x87 : 0);
+}
+
+static void
+xts_crypt (CRYPT_KEY *key, char *buf, ulong size, ulong rec, ulong secsize, short decipher)
+{
+	union { uchar b[16]; ulong l[4]; } t, x;
+
+	/* Paranoia */
+	assert (((secsize % AES_BLOCK) == 0));
+	assert (((size % secsize) == 0));
+
+	for (; size; size -= secsize, rec++)
+	{
+		ulong n;
+
+		mint_bzero (t.b, sizeof (t));
+		t.b[0] = rec;
+		t.b[1] = rec >> 8;
+		t.b[2] = rec >> 16;
+		t.b[3] = rec >> 24;
+
+		AES_encrypt (&key->u.xts.tweak, t.b, t.b);
+
+		for (n = secsize; n; n -= AES_BLOCK, buf += AES_BLOCK)
+		{
+			ulong *p = (ulong *) buf;
+# ifdef M68000
+			ulong lr[4];
+
+			/* long accesses need an even address */
+			if (((ulong) buf & 1L) && (mcpu < 20))
+			{
+				byte_copy ((char *) lr, buf, AES_BLOCK - 1);
+				p = lr;
+			}
+# endif
+			x.l[0] = p[0] ^ t.l[0];
+			x.l[1] = p[1] ^ t.l[1];
+			x.l[2] = p[2] ^ t.l[2];
+			x.l[3] = p[3] ^ t.l[3];
+
+			if (decipher)
+				AES_decrypt (&key->u.xts.data_dec, x.b, x.b);
+			else
+				AES_encrypt (&key->u.xts.data_enc, x.b, x.b);
+
+			p[0] = x.l[0] ^ t.l[0];
+			p[1] = x.l[1] ^ t.l[1];
+			p[2] = x.l[2] ^ t.l[2];
+			p[3] = x.l[3] ^ t.l[3];
+# ifdef M68000
+			if (p == lr)
+				byte_copy (buf, (char *) lr, AES_BLOCK - 1);
+# endif
+			xts_next_tweak (t.b);
+		}
+	}
+}
+
+static void
+xts_encipher (CRYPT_KEY *key, char *buf, ulong size, ulong rec, ulong secsize)
+{
+	xts_crypt (key, buf, size, rec, secsize, 0);
+}
+
+static void
+xts_decipher (CRYPT_KEY *key, char *buf, ulong size, ulong rec, ulong secsize)
+{
+	xts_crypt (key, buf, size, rec, secsize, 1);
+}
+
+/* indexed by the cipher argument of Dsetkey() */
+static const struct cipher ciphers [] =
+{
+	{ "Blowfish-CBC",	bf_setkey,	bf_encipher,	bf_decipher	},
+	{ "AES-128-XTS",	xts_setkey,	xts_encipher,	xts_decipher	}
+};
+
+# define CIPHERS	(sizeof (ciphers) / sizeof (ciphers[0]))
+
 static long _cdecl
 rwabs_crypto (DI *di, ushort rw, void *buf, ulong size, ulong rec)
 {
@@ -251,7 +436,7 @@ rwabs_crypto (DI *di, ushort rw, void *buf, ulong size, ulong rec)
 
 	/* Encipher the data before writing the buffer */
 	if (rw & 1)
-		crypt_block (di->crypt.key, cbc_encipher, crypt_buf, crypt_size, crypt_rec, di);
+		(*di->crypt.key->cipher->encipher)(di->crypt.key, crypt_buf, crypt_size, crypt_rec, di->pssize);
 
 	/* Do the real read/write operation */
 	r = (*di->crypt.rwabs)(di, rw, buf, size, rec);
@@ -260,7 +445,7 @@ rwabs_crypto (DI *di, ushort rw, void *buf, ulong size, ulong rec)
 		/* On success, always decipher the buffer, as we have
 		 * crypted data in it, anyway
 		 */
-		crypt_block (di->crypt.key, cbc_decipher, crypt_buf, crypt_size, crypt_rec, di);
+		(*di->crypt.key->cipher->decipher)(di->crypt.key, crypt_buf, crypt_size, crypt_rec, di->pssize);
 	}
 
 	return r;
@@ -280,8 +465,8 @@ rwabs_crypto (DI *di, ushort rw, void *buf, ulong size, ulong rec)
  * key: Pointer to the new passphrase; if this is an empty string, ciphering
  *      will be disabled for drv; it it is a NULL pointer, test current
  *      ciphering mode
- * cipher: Cipher type to use. Currently, only zero (Blowfish) is supported.
- *         Other values are reserved for future expansion.
+ * cipher: Cipher type to use: zero is Blowfish in CBC mode, one is AES-128
+ *         in XTS mode. Other values are reserved for future expansion.
  *
  * Returns:
  * (for key != NULL)
@@ -305,14 +490,8 @@ sys_d_setkey (llong dev, char *key, int cipher)
 	if (!suser (get_curproc()->p_cred->ucr))
 		return EPERM;
 
-	switch (cipher)
-	{
-	    case 0:
-		/* Blowfish */
-		break;
-	    default:
+	if (cipher < 0 || cipher >= CIPHERS)
 		return EINVAL;
-	}
 
 	if ((r = sys_d_lock (1, dev)) != E_OK)
 		return r;
@@ -337,12 +516,13 @@ sys_d_setkey (llong dev, char *key, int cipher)
 
 	if (*key)
 	{
-		struct MD5Context md5sum;
-		uchar hash [16];
+		if (di->pssize % AES_BLOCK)
+		{
+			bio.free_di (di);
+			(void) sys_d_lock (0, dev);
 
-		MD5Init (&md5sum);
-		MD5Update (&md5sum, (unsigned char *)key, strlen (key));
-		MD5Final ((unsigned char *)hash, &md5sum);
+			return EINVAL;
+		}
 
 		if (!(di->mode & BIO_ENCRYPTED))
 		{
@@ -363,7 +543,10 @@ sys_d_setkey (llong dev, char *key, int cipher)
 			di->mode |= BIO_ENCRYPTED;
 		}
 
-		Blowfish_initialize (di->crypt.key, (unsigned char *)hash, 16);
+		di->crypt.key->cipher = &ciphers[cipher];
+		(*ciphers[cipher].setkey)(di->crypt.key, key);
+
+		DEBUG (("Dsetkey: %s", ciphers[cipher].name));
 	}
 	else
 	{
@@ -338,72 +338,62 @@ bailout:
 	return r;
 }
 
+/*
+ * check that dir is a directory p may change to; dir is released
+ * on failure
+ */
 long
-sys_d_setpath0 (struct proc *p, const char *path)
+check_curdir (struct proc *p, fcookie *dir)
 {
-	struct cwd *cwd = p->p_cwd;
-
 	XATTR xattr;
-	fcookie dir;
-	int drv;
 	long r;
 
-	TRACE (("Dsetpath(%s)", path));
-	assert (cwd);
-
-	r = path2cookie (p, path, follow_links, &dir);
+	r = xfs_getxattr (dir->fs, dir, &xattr);
 	if (r)
 	{
-		DEBUG (("Dsetpath(%s): returning %ld", path, r));
-		return r;
-	}
-
-	if (path[0] && path[1] == ':')
-	{
-		char c = *path;
-
-		if (c >= 'a' && c <= 'z')
-			drv = c-'a';
-		else if (c >= 'A' && c <= 'Z'+6)  /* A..Z[\]^_` */
-			drv = c-'A';
-		else if (c >= '1' && c <= '6')  /* A..Z1..6 */
-			drv = c - '1'+26;
-	}
-
-	r = xfs_getxattr (dir.fs, &dir, &xattr);
-	if (r)
-	{
-		DEBUG (("Dsetpath: file '%s': attributes not found", path));
-		release_cookie (&dir);
+		DEBUG (("check_curdir: attributes not found"));
+		release_cookie (dir);
 		return r;
 	}
 
 	if (!(xattr.attr & FA_DIR))
 	{
-		DEBUG (("Dsetpath(%s): not a directory", path));
-		release_cookie (&dir);
+		DEBUG (("check_curdir: not a directory"));
+		release_cookie (dir);
 		return ENOTDIR;
 	}
 
 	if (denyaccess (p->p_cred->ucr, &xattr, S_IXOTH))
 	{
-		DEBUG (("Dsetpath(%s): access denied", path));
-		release_cookie (&dir);
+		DEBUG (("check_curdir: access denied"));
+		release_cookie (dir);
 		return EACCES;
 	}
 
+	return E_OK;
+}
+
+/*
+ * make dir the current directory of p; the cookie is taken over
+ */
+void
+set_curdir (struct proc *p, fcookie *dir)
+{
+	struct cwd *cwd = p->p_cwd;
+	int drv;
+
 	/* watch out for symbolic links; if c:\foo is a link to d:\bar, then
 	 * "cd c:\foo" should also change the drive to d:
 	 */
 	drv = cwd->curdrv;
-	if (drv != UNIDRV && dir.dev != cwd->root[drv].dev)
+	if (drv != UNIDRV && dir->dev != cwd->root[drv].dev)
 	{
 		int i;
 
 		for (i = 0; i < NUM_DRIVES; i++)
 		{
-			if (cwd->root[i].dev == dir.dev
-				&& cwd->root[i].fs == dir.fs)
+			if (cwd->root[i].dev == dir->dev
+				&& cwd->root[i].fs == dir->fs)
 			{
 				if (cwd->curdrv == drv)
 					cwd->curdrv = i;
@@ -415,8 +405,33 @@ sys_d_setpath0 (struct proc *p, const char *path)
 	}
 
 	release_cookie (&cwd->curdir[drv]);
-	cwd->curdir[drv] = dir;
+	cwd->curdir[drv] = *dir;
+}
+
+long
+sys_d_setpath0 (struct proc *p, const char *path)
+{
+	fcookie dir;
+	long r;
+
+	TRACE (("Dsetpath(%s)", path));
+	assert (p->p_cwd);
+
+	r = path2cookie (p, path, follow_links, &dir);
+	if (r)
+	{
+		DEBUG (("Dsetpath(%s): returning %ld", path, r));
+		return r;
+	}
 
+	r = check_curdir (p, &dir);
+	if (r)
+	{
+		DEBUG (("Dsetpath(%s): returning %ld", path, r));
+		return r;
+	}
+
+	set_curdir (p, &dir);
 	return E_OK;
 }
 
@@ -1368,6 +1383,80 @@ sys_d_xreaddir (int len, long handle, char *buf, XATTR *xattr, long *xret)
 	return r;
 }
 
+/* Dreaddirx: like Dxreaddir, but fills buf with as many struct
+ * dirstat records (see mint/stat.h) as fit, so a whole directory
+ * can be listed with a few traps. Returns the number of bytes used,
+ * 0 at the end of the directory.
+ *
+ * Filesystems with FS_EXT_4 do this natively, for all others it's
+ * a readdir/stat64 loop here. That loop can't push an entry back,
+ * so it stops while a record with a maximal name still fits.
+ */
+# define DX_NAMEMAX	255
+
+long _cdecl
+sys_d_readdirx (long handle, char *buf, long len)
+{
+	struct proc *p = get_curproc();
+	DIR *dirh = (DIR *) handle;
+	char name[DX_NAMEMAX + 1 + sizeof (long)];
+	char *nm;
+	fcookie fc;
+	long used;
+	long r;
+	DIR **where;
+
+	where = &p->p_fd->searches;
+	while (*where && *where != dirh)
+		where = &((*where)->next);
+
+	if (!*where)
+	{
+		DEBUG(("Dreaddirx: not an open directory"));
+		return EBADF;
+	}
+
+	if (!dirh->fc.fs)
+		return EBADF;
+
+	if (len < 0)
+		return EBADARG;
+
+	if (dirh->fc.fs->fsflags & FS_EXT_4)
+		return xfs_readdirx (dirh->fc.fs, dirh, buf, len);
+
+	if (len < DIRSTAT_RECLEN (DX_NAMEMAX))
+		return ERANGE;
+
+	/* non-TOS readdir puts the index in front of the name */
+	nm = (dirh->flags & TOS_SEARCH) ? name : name + sizeof (long);
+
+	used = 0;
+	while (len - used >= DIRSTAT_RECLEN (DX_NAMEMAX))
+	{
+		struct dirstat *d = (struct dirstat *) (buf + used);
+
+		r = xfs_readdir (dirh->fc.fs, dirh, name, sizeof (name), &fc);
+		if (r != E_OK)
+		{
+			if (r == ENMFILES || used)
+				break;
+
+			return r;
+		}
+
+		d->namelen = strlen (nm);
+		d->reclen = DIRSTAT_RECLEN (d->namelen);
+		d->ret = xfs_stat64 (fc.fs, &fc, &d->st);
+		strcpy (d->name, nm);
+
+		release_cookie (&fc);
+		used += d->reclen;
+	}
+
+	return used;
+}
+
 
 long _cdecl
 sys_d_rewind (long handle)
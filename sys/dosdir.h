@@ -20,6 +20,8 @@ long _cdecl sys_d_getdrv	(void);
 long _cdecl sys_d_free		(long *buf, int d);
 long _cdecl sys_d_create	(const char *path);
 long _cdecl sys_d_delete	(const char *path);
+long        check_curdir	(struct proc *p, fcookie *dir);
+void        set_curdir	(struct proc *p, fcookie *dir);
 long        sys_d_setpath0	(struct proc *p, const char *path);
 long _cdecl sys_d_setpath	(const char *path);
 long _cdecl sys_d_getpath	(char *path, int drv);
@@ -35,6 +37,7 @@ long _cdecl sys_d_pathconf	(const char *name, int which);
 long _cdecl sys_d_opendir	(const char *path, int flags);
 long _cdecl sys_d_readdir	(int len, long handle, char *buf);
 long _cdecl sys_d_xreaddir	(int len, long handle, char *buf, XATTR *xattr, long *xret);
+long _cdecl sys_d_readdirx	(long handle, char *buf, long len);
 long _cdecl sys_d_rewind	(long handle);
 long _cdecl sys_d_closedir	(long handle);
 long _cdecl sys_f_xattr		(int flag, const char *name, XATTR *xattr);
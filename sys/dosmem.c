@@ -109,6 +109,8 @@ _do_malloc (MMAP map, long size, int mode)
 	}
 
 	m = get_region(map, size, mode);
+	if (!m && reclaim_memory())
+		m = get_region(map, size, mode);
 	if (!m)
 	{
 		return 0;
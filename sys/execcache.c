@@ -0,0 +1,364 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *
+ * executable image cache
+ *
+ * Programs that are started again and again (think of the shell
+ * utilities during a build) are kept relocated in memory. A hit
+ * copies the image and moves the fixups by the difference of the load
+ * addresses instead of reading and relocating the file again; if the
+ * program lands on the same address as last time even that is skipped.
+ *
+ * Every fixup is text base + offset, independent of the section the
+ * offset points to (see load_and_reloc), so one delta fits them all.
+ *
+ * Images are identified like file mappings by device, inode, size and
+ * modification time, and are only cached on their second load. As FAT
+ * keeps the modification time to 2 seconds only, an image is also
+ * dropped when the file is closed after being opened for writing.
+ *
+ * The copies are only kept in alternate RAM. Their regions are marked
+ * M_CACHE, so Malloc(-1) and the TPA sizing count them as free, and they
+ * are given back as soon as an allocation fails (see reclaim_memory in
+ * memory.c).
+ *
+ */
+
+# include "execcache.h"
+# include "global.h"
+
+# include "libkern/libkern.h"
+# include "mint/file.h"
+# include "mint/stat.h"
+
+# include "arch/cpu.h"		/* cpushi */
+# include "arch/mprot.h"
+
+# include "kmemory.h"
+# include "memory.h"
+# include "xfs_xdd.h"
+
+
+# define EXEC_CACHE		8		/* max. number of images */
+# define EXEC_CACHE_MAX		(256L * 1024L)	/* max. text + data size */
+
+struct ximage
+{
+	struct ximage	*next;
+	llong		dev;		/* file identity */
+	ulong		ino;
+	struct time	mtime;		/* file state at load time */
+	llong		size;
+	MEMREGION	*reg;		/* relocated text + data, NULL if seen once */
+	long		base;		/* text base the image is relocated for */
+	long		len;		/* text + data */
+	long		first;		/* first fixup, 0 if none */
+	uchar		*relocs;	/* rest of the fixup stream */
+	long		rlen;
+};
+
+static struct ximage *ximages = NULL;
+static long nximages = 0;
+static int nxregions = 0;	/* images holding a region */
+
+
+static void
+ximage_drop (struct ximage *xi)
+{
+	if (xi->reg)
+	{
+		xi->reg->links--;
+		free_region (xi->reg);
+		xi->reg = NULL;
+		nxregions--;
+	}
+
+	if (xi->relocs)
+	{
+		kfree (xi->relocs);
+		xi->relocs = NULL;
+	}
+}
+
+static void
+ximage_release (struct ximage *xi)
+{
+	TRACE (("exec_cache: release %lx", xi->ino));
+
+	ximage_drop (xi);
+	kfree (xi);
+	nximages--;
+}
+
+/*
+ * give back the memory of all cached images;
+ * returns the number of images dropped
+ */
+int
+exec_cache_flush (void)
+{
+	struct ximage *xi;
+	int n = 0;
+
+	for (xi = ximages; xi; xi = xi->next)
+	{
+		if (xi->reg)
+			n++;
+
+		ximage_drop (xi);
+	}
+
+	return n;
+}
+
+/*
+ * number of images currently holding memory
+ */
+int
+exec_cache_used (void)
+{
+	return nxregions;
+}
+
+/*
+ * fc was open for writing and is closed now; size and modification
+ * time may not show that it changed, so forget it
+ */
+void
+exec_cache_invalidate (fcookie *fc)
+{
+	struct ximage **xip = &ximages;
+	struct stat st;
+
+	if (!ximages || !fc->fs || xfs_stat64 (fc->fs, fc, &st) != E_OK)
+		return;
+
+	while (*xip)
+	{
+		struct ximage *xi = *xip;
+
+		if (xi->ino == st.ino && xi->dev == st.dev)
+		{
+			TRACE (("exec_cache: %lx written, dropped", xi->ino));
+
+			*xip = xi->next;
+			ximage_release (xi);
+			return;
+		}
+
+		xip = &(xi->next);
+	}
+}
+
+static struct ximage *
+ximage_lookup (const struct stat *st)
+{
+	struct ximage **xip = &ximages;
+
+	while (*xip)
+	{
+		struct ximage *xi = *xip;
+
+		if (xi->ino == st->ino && xi->dev == st->dev)
+		{
+			*xip = xi->next;
+
+			if (xi->size == st->size
+				&& xi->mtime.time == st->mtime.time
+				&& xi->mtime.nanoseconds == st->mtime.nanoseconds)
+			{
+				/* move to front */
+				xi->next = ximages;
+				ximages = xi;
+
+				return xi;
+			}
+
+			/* program changed */
+			ximage_release (xi);
+			return NULL;
+		}
+
+		xip = &(xi->next);
+	}
+
+	return NULL;
+}
+
+static void
+ximage_insert (const struct stat *st)
+{
+	struct ximage *xi;
+
+	if (nximages >= EXEC_CACHE)
+	{
+		struct ximage **xip = &ximages;
+
+		/* the least recently used one */
+		while ((*xip)->next)
+			xip = &((*xip)->next);
+
+		xi = *xip;
+		*xip = NULL;
+		ximage_release (xi);
+	}
+
+	xi = kmalloc (sizeof (*xi));
+	if (!xi)
+		return;
+
+	mint_bzero (xi, sizeof (*xi));
+
+	xi->dev = st->dev;
+	xi->ino = st->ino;
+	xi->mtime = st->mtime;
+	xi->size = st->size;
+
+	xi->next = ximages;
+	ximages = xi;
+	nximages++;
+}
+
+/*
+ * keep a copy of the freshly loaded and relocated program
+ */
+static void
+ximage_fill (struct ximage *xi, FILEPTR *f, FILEHEAD *fh, BASEPAGE *b)
+{
+	long len = fh->ftext + fh->fdata;
+	long pos, r;
+
+	xi->len = len;
+	xi->base = b->p_tbase;
+
+	if (!fh->reloc)
+	{
+		pos = sizeof (FILEHEAD) + fh->ftext + fh->fdata + fh->fsym;
+
+		r = xdd_lseek (f, pos, SEEK_SET);
+		if (r >= 0)
+			r = xdd_read (f, (char *) &xi->first, 4);
+		if (r != 4)
+			xi->first = 0;
+
+		xi->rlen = xi->first ? xi->size - pos - 4 : 0;
+		if (xi->rlen > 0)
+		{
+			xi->relocs = kmalloc (xi->rlen);
+			if (!xi->relocs)
+				return;
+
+			r = xdd_read (f, (char *) xi->relocs, xi->rlen);
+			if (r != xi->rlen)
+			{
+				DEBUG (("exec_cache: short read on fixups (%li)", r));
+				ximage_drop (xi);
+				return;
+			}
+		}
+	}
+
+	/* ST-RAM is too precious to keep images around */
+	xi->reg = get_region (alt, len, PROT_S);
+	if (!xi->reg)
+	{
+		ximage_drop (xi);
+		return;
+	}
+
+	xi->reg->mflags |= M_CACHE;
+	nxregions++;
+
+	quickmove ((char *) xi->reg->loc, (char *) b->p_tbase, len);
+
+	TRACE (("exec_cache: cached %lx, %li bytes, %li fixup bytes", xi->ino, len, xi->rlen));
+}
+
+/*
+ * move all fixups of the image at where by delta
+ */
+static void
+ximage_reloc (struct ximage *xi, char *where, long delta)
+{
+	uchar *next = xi->relocs;
+	uchar *end = xi->relocs + xi->rlen;
+	long fixup = xi->first;
+	uchar c;
+
+	if (!fixup)
+		return;
+
+	do {
+		if (fixup >= xi->len)
+			break;
+
+		*((long *)(where + fixup)) += delta;
+
+		do {
+			c = (next < end) ? *next++ : 0;
+			if (c == 1) fixup += 254;
+		}
+		while (c == 1);
+
+		fixup += ((unsigned) c) & 0xff;
+	}
+	while (c);
+}
+
+/*
+ * load the text and data of the executable f to b->p_tbase,
+ * from the cache if possible
+ */
+long
+exec_cache_load (FILEPTR *f, FILEHEAD *fh, BASEPAGE *b)
+{
+	struct stat st;
+	struct ximage *xi = NULL;
+	long len = fh->ftext + fh->fdata;
+	long r;
+
+	if (f->fc.fs && len <= EXEC_CACHE_MAX
+		&& xfs_stat64 (f->fc.fs, &f->fc, &st) == E_OK)
+	{
+		xi = ximage_lookup (&st);
+		if (xi && xi->reg)
+		{
+			TRACE (("exec_cache: hit %lx at %lx (cached for %lx)", xi->ino, b->p_tbase, xi->base));
+
+			quickmove ((char *) b->p_tbase, (char *) xi->reg->loc, len);
+			if (b->p_tbase != xi->base)
+				ximage_reloc (xi, (char *) b->p_tbase, b->p_tbase - xi->base);
+
+			cpushi ((void *) b->p_tbase, b->p_tlen);
+			return E_OK;
+		}
+
+		if (!xi)
+			ximage_insert (&st);
+	}
+
+	r = load_and_reloc (f, fh, (char *) b->p_tbase, 0, len, b);
+
+	/* second load, worth to keep it */
+	if (r == E_OK && xi)
+		ximage_fill (xi, f, fh, b);
+
+	return r;
+}
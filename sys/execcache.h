@@ -0,0 +1,36 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ * 
+ * 
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ */
+
+# ifndef _execcache_h
+# define _execcache_h
+
+# include "mint/mint.h"
+# include "mint/basepage.h"
+# include "mint/mem.h"
+
+
+long	exec_cache_load		(FILEPTR *f, FILEHEAD *fh, BASEPAGE *b);
+void	exec_cache_invalidate	(fcookie *fc);
+int	exec_cache_flush	(void);
+int	exec_cache_used		(void);
+
+
+# endif /* _execcache_h */
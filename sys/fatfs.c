@@ -372,6 +372,7 @@
 # include "proc.h"
 # include "time.h"
 # include "unicode.h"
+# include "xfs_xdd.h"
 
 
 /*
@@ -557,6 +558,7 @@ static long	_cdecl fatfs_rename	(fcookie *olddir, char *oldname, fcookie *newdir
 
 static long	_cdecl fatfs_opendir	(DIR *dirh, int flags);
 static long	_cdecl fatfs_readdir	(DIR *dirh, char *nm, int nmlen, fcookie *);
+static long	_cdecl fatfs_readdirx	(DIR *dirh, char *buf, long len);
 static long	_cdecl fatfs_rewinddir	(DIR *dirh);
 static long	_cdecl fatfs_closedir	(DIR *dirh);
 
@@ -594,6 +596,7 @@ FILESYS fatfs_filesys =
 	 * FS_EXT_1		extensions level 1 - mknod & unmount
 	 * FS_EXT_2		extensions level 2 - additional place at the end
 	 * FS_EXT_3		extensions level 3 - stat & native UTC timestamps
+	 * FS_EXT_4		extensions level 4 - bulk readdirx
 	 */
 	FS_CASESENSITIVE	|
 	FS_NOXBIT		|
@@ -602,7 +605,8 @@ FILESYS fatfs_filesys =
 	FS_DO_SYNC		|
 	FS_OWN_MEDIACHANGE	|
 	FS_EXT_1		|
-	FS_EXT_2		,
+	FS_EXT_2		|
+	FS_EXT_4		,
 
 	root:			fatfs_root,
 	lookup:			fatfs_lookup,
@@ -643,7 +647,9 @@ FILESYS fatfs_filesys =
 
 	/* FS_EXT_3 */
 	stat64:			NULL,
-	res1:			0,
+
+	/* FS_EXT_4 */
+	readdirx:		fatfs_readdirx,
 	res2:			0,
 	res3:			0,
 
@@ -6996,6 +7002,58 @@ fatfs_readdir (DIR *dirh, char *nm, int nmlen, fcookie *fc)
 	return ENOMEM;
 }
 
+/*
+ * readdir and getxattr on the cookie readdir just built, without going
+ * through the cookie lookup of stat64 again; __nextdir can't step back,
+ * so stop while a record for the longest name still fits
+ */
+static long _cdecl
+fatfs_readdirx (DIR *dirh, char *buf, long len)
+{
+	char name[VFAT_NAMEMAX + sizeof (long)];
+	char *nm;
+	fcookie fc;
+	XATTR xattr;
+	long used;
+	long r;
+
+	FAT_DEBUG (("fatfs_readdirx [%s]: enter", ((COOKIE *) dirh->fc.index)->name));
+
+	if (len < DIRSTAT_RECLEN (VFAT_NAMEMAX - 1))
+		return ERANGE;
+
+	/* non-TOS readdir puts the index in front of the name */
+	nm = (dirh->flags & TOS_SEARCH) ? name : name + sizeof (long);
+
+	used = 0;
+	while (len - used >= DIRSTAT_RECLEN (VFAT_NAMEMAX - 1))
+	{
+		struct dirstat *d = (struct dirstat *) (buf + used);
+
+		r = fatfs_readdir (dirh, name, sizeof (name), &fc);
+		if (r != E_OK)
+		{
+			if (r == ENMFILES || used)
+				break;
+
+			return r;
+		}
+
+		d->namelen = strlen (nm);
+		d->reclen = DIRSTAT_RECLEN (d->namelen);
+		d->ret = fatfs_getxattr (&fc, &xattr);
+		if (!d->ret)
+			xattr2stat64 (&xattr, &d->st);
+		strcpy (d->name, nm);
+
+		fatfs_release (&fc);
+		used += d->reclen;
+	}
+
+	FAT_DEBUG (("fatfs_readdirx: leave ok (%li bytes)", used));
+	return used;
+}
+
 static long _cdecl
 fatfs_rewinddir (DIR *dirh)
 {
@@ -44,6 +44,7 @@
 # include "kmemory.h"
 # include "memory.h"
 # include "module.h"
+# include "namecache.h"
 # include "proc.h"
 # include "signal.h"
 # include "time.h"
@@ -1106,7 +1107,18 @@ restart_mount:
 
 		PATH2COOKIE_DB (("relpath2cookie: looking up [%s]", lastname));
 
-		r = xfs_lookup (dir.fs, &dir, lastname, res);
+		r = nc_lookup (&dir, lastname, res);
+		if (r == NC_MISS)
+		{
+			ulong gen = nc_generation;
+
+			r = xfs_lookup (dir.fs, &dir, lastname, res);
+			if (r == 0)
+				nc_enter (&dir, lastname, res, gen);
+			else if (r == ENOENT)
+				nc_enter (&dir, lastname, NULL, gen);
+		}
+
 		if (r == EMOUNT)
 		{
 			fcookie mounteddir;
@@ -0,0 +1,66 @@
+/*
+ *	Stand-in for the kernel headers to build ramfsbench with the
+ *	host compiler (make ramfsbench). Only provides what the DIR
+ *	part of ramfs.c needs.
+ *
+ *	The system headers that might use the MiNT type names
+ *	themselves are pulled in before the names are defined.
+ */
+
+# ifndef _host_kernel_h
+# define _host_kernel_h
+
+# include <ctype.h>
+# include <errno.h>
+# include <stdint.h>
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <strings.h>
+# include <time.h>
+# include <sys/types.h>
+
+# define ulong		uint32_t
+# define ushort		uint16_t
+# define uchar		uint8_t
+
+# define INLINE		static inline
+# define FUNCTION	__func__
+
+# define str(x)		_stringify (x)
+# define _stringify(x)	#x
+
+/* kernel error codes are negative */
+# undef EACCES
+# undef ENOMEM
+# define E_OK		0
+# define EACCES		(-36)
+# define ENOMEM		(-39)
+
+# define FORCE(x)
+# define ALERT(x)
+# define DEBUG(x)
+# define TRACE(x)
+
+# ifndef _tolower
+# define _tolower(c)	((c) - 'A' + 'a')
+# endif
+
+# define stricmp(a,b)		strcasecmp (a, b)
+# define mint_bzero(p,n)	memset (p, 0, n)
+
+# define _kmalloc(size,func)	malloc (size)
+# define _kfree(place,func)	free (place)
+
+/* only the parts of the file attributes the DIR part touches */
+typedef struct
+{
+	long	size;
+	ushort	mode;
+} STAT;
+
+typedef struct fileptr	FILEPTR;
+typedef struct ilock	LOCK;
+
+
+# endif /* _host_kernel_h */
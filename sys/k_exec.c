@@ -54,6 +54,7 @@
 # include "k_resource.h"	/* sys_prenice */
 # include "kmemory.h"
 # include "memory.h"
+# include "mmap.h"
 # include "proc.h"
 # include "proc_help.h"
 # include "procfs.h"
@@ -774,6 +775,8 @@ exec_region(struct proc *p, MEMREGION *mem, int thread)
 						mark_proc_region(p->p_mem, m, PROT_I, p->pid);
 					}
 # endif
+					if (m->mflags & M_MMAP)
+						mmap_unref(m);
 				}
 			}
 		}
@@ -873,6 +876,258 @@ exec_region(struct proc *p, MEMREGION *mem, int thread)
 	return p;
 }
 
+/*
+ * Pspawn() support
+ *
+ * spawn_prepare checks the file actions against the caller's descriptor
+ * table, opens the files for SPAWN_OPEN, takes the references for
+ * SPAWN_DUP2 and resolves the SPAWN_CHDIR directories in the caller's
+ * context, so that nothing can fail once the child exists; a thread
+ * sharing the table may close descriptors while the program is loaded. spawn_files and spawn_attrs then apply everything
+ * to the child before and after exec_region.
+ */
+
+static long
+spawn_prepare(struct proc *p, const struct spawn_attr *attr, FILEPTR **files, fcookie *dir)
+{
+	struct filedesc *fd = p->p_fd;
+	FILEPTR **ftab;
+	long r = E_OK;
+	int i;
+
+	/* the table as the child will see it */
+	ftab = kmalloc(fd->nfiles * sizeof(*ftab));
+	if (!ftab)
+		return ENOMEM;
+
+	for (i = 0; i < fd->nfiles; i++)
+	{
+		/* (FILEPTR *) 1 is a slot that is only reserved */
+		ftab[i] = fd->ofiles[i];
+		if (ftab[i] == (FILEPTR *) 1)
+			ftab[i] = NULL;
+	}
+
+# define SPAWN_FD_OK(x)	((x) >= 0 && (x) < fd->nfiles)
+
+	for (i = 0; i < attr->nactions; i++)
+	{
+		const struct spawn_action *a = &attr->actions[i];
+
+		switch (a->cmd)
+		{
+			case SPAWN_CLOSE:
+			{
+				if (!SPAWN_FD_OK(a->fd))
+					r = EBADF;
+				else
+					ftab[a->fd] = NULL;
+				break;
+			}
+			case SPAWN_DUP2:
+			{
+				FILEPTR *f;
+
+				if (!SPAWN_FD_OK(a->fd) || !SPAWN_FD_OK(a->newfd) || !ftab[a->fd])
+				{
+					r = EBADF;
+					break;
+				}
+
+				/* dup2(fd, fd) only clears close-on-exec */
+				if (a->fd == a->newfd)
+					break;
+
+				f = ftab[a->fd];
+				f->links++;
+
+				files[i] = f;
+				ftab[a->newfd] = f;
+				break;
+			}
+			case SPAWN_OPEN:
+			{
+				FILEPTR *f;
+				short mode;
+
+				if (!SPAWN_FD_OK(a->fd))
+				{
+					r = EBADF;
+					break;
+				}
+
+				/* see sys_f_open */
+				mode = a->flags & O_USER;
+				if ((mode & O_RWMODE) == O_EXEC)
+					mode = (mode & ~O_RWMODE) | O_RDWR;
+
+				r = FP_ALLOC(p, &f);
+				if (r)
+					break;
+
+				r = do_open(&f, a->path, mode, 0, NULL);
+				if (r)
+				{
+					DEBUG(("Pspawn: open(%s) failed (%li)", a->path, r));
+					f->links--;
+					FP_FREE(f);
+					break;
+				}
+
+				files[i] = f;
+				ftab[a->fd] = f;
+				break;
+			}
+			case SPAWN_CHDIR:
+			{
+				fcookie newdir;
+
+				/* relative to an earlier SPAWN_CHDIR, if any */
+				if (dir->fs)
+					r = relpath2cookie(p, dir, a->path, follow_links, &newdir, 0);
+				else
+					r = path2cookie(p, a->path, follow_links, &newdir);
+
+				if (!r)
+					r = check_curdir(p, &newdir);
+
+				if (r)
+				{
+					DEBUG(("Pspawn: chdir(%s) failed (%li)", a->path, r));
+					break;
+				}
+
+				if (dir->fs)
+					release_cookie(dir);
+				*dir = newdir;
+				break;
+			}
+			default:
+			{
+				r = EINVAL;
+				break;
+			}
+		}
+
+		if (r)
+			break;
+	}
+
+# undef SPAWN_FD_OK
+
+	kfree(ftab);
+	return r;
+}
+
+static void
+spawn_install(struct proc *p, short fd, FILEPTR *f)
+{
+	FILEPTR *old = p->p_fd->ofiles[fd];
+
+	p->p_fd->ofiles[fd] = f;
+	p->p_fd->ofileflags[fd] = 0;
+
+	if (old)
+		do_close(p, old);
+}
+
+static void
+spawn_files(struct proc *p, const struct spawn_attr *attr, FILEPTR **files, fcookie *dir)
+{
+	struct filedesc *fd = p->p_fd;
+	int i;
+
+	for (i = 0; i < attr->nactions; i++)
+	{
+		const struct spawn_action *a = &attr->actions[i];
+		FILEPTR *f;
+
+		switch (a->cmd)
+		{
+			case SPAWN_CLOSE:
+			{
+				f = fd->ofiles[a->fd];
+				if (f)
+				{
+					FD_REMOVE(p, a->fd);
+					do_close(p, f);
+				}
+				break;
+			}
+			case SPAWN_DUP2:
+			{
+				if (a->fd == a->newfd)
+				{
+					/* only clears close-on-exec */
+					fd->ofileflags[a->newfd] = 0;
+					break;
+				}
+
+				/* the reference spawn_prepare took */
+				spawn_install(p, a->newfd, files[i]);
+				files[i] = NULL;
+				break;
+			}
+			case SPAWN_OPEN:
+			{
+				/* the child owns it now */
+				spawn_install(p, a->fd, files[i]);
+				files[i] = NULL;
+				break;
+			}
+			case SPAWN_CHDIR:
+			{
+				/* resolved by spawn_prepare, see below */
+				break;
+			}
+		}
+	}
+
+	if (dir->fs)
+	{
+		/* the child owns it now */
+		set_curdir(p, dir);
+		dir->fs = NULL;
+	}
+}
+
+/* after exec_region, which resets the signal state */
+static void
+spawn_attrs(struct proc *p, const struct spawn_attr *attr)
+{
+	if (attr->flags & SPAWN_SETPGROUP)
+		p->pgrp = attr->pgroup ? attr->pgroup : p->pid;
+
+	if (attr->flags & SPAWN_SETSIGMASK)
+		p->p_sigmask = attr->sigmask & ~UNMASKABLE;
+
+	if (attr->flags & SPAWN_SETSIGDEF)
+	{
+		int i;
+
+		for (i = 1; i < NSIG; i++)
+		{
+			if (attr->sigdefault & (1UL << i))
+			{
+				struct sigaction *sigact = &SIGACTION(p, i);
+
+				sigact->sa_handler = SIG_DFL;
+				sigact->sa_mask = 0;
+				sigact->sa_flags = 0;
+			}
+		}
+	}
+
+	if (attr->flags & SPAWN_RESETIDS)
+	{
+		struct pcred *cred = p->p_cred;
+
+		cred->ucr = copy_cred(cred->ucr);
+		cred->ucr->euid = cred->ruid;
+		cred->ucr->egid = cred->rgid;
+	}
+}
+
 long _cdecl
 create_process(const void *filename, const void *cmdline, const void *newenv,
 	       struct proc **pret, long stack, struct create_process_opts *opts)
@@ -976,6 +1231,9 @@ create_process(const void *filename, const void *cmdline, const void *newenv,
 			proc_setgid(p, opts->gid);
 	}
 
+	if (opts && (opts->mode & CREATE_PROCESS_OPTS_SPAWN))
+		spawn_files(p, opts->spawn, opts->spawn_files, opts->spawn_dir);
+
 	/* notify proc extensions */
 	proc_ext_on_exec(get_curproc());
 
@@ -992,6 +1250,9 @@ create_process(const void *filename, const void *cmdline, const void *newenv,
 	attach_region(p, env);
 	attach_region(p, base);
 
+	if (opts && (opts->mode & CREATE_PROCESS_OPTS_SPAWN))
+		spawn_attrs(p, opts->spawn);
+
 	/* interesting coincidence:
 	 * if a process needs a name, it usually needs to have
 	 * its domain reset to DOM_TOS. Doing it this way
@@ -1018,3 +1279,79 @@ leave:
 
 	return r;
 }
+
+/*
+ * Pspawn(path, cmdline, env, attr): create a process running the
+ * program path, like Pexec(100, ...) with the file actions and
+ * attributes in attr applied to the child; the caller keeps running.
+ * cmdline is a Pexec() command tail, env NULL for the caller's
+ * environment. Returns the pid of the child.
+ */
+long _cdecl
+sys_p_spawn(const char *path, const char *cmdline, const char *env,
+	    const struct spawn_attr *attr)
+{
+	struct create_process_opts opts;
+	FILEPTR **files = NULL;
+	fcookie dir;
+	struct proc *p;
+	long r;
+	int i;
+
+	TRACE(("Pspawn(%s, %p)", path, attr));
+
+	if (!path)
+		return EFAULT;
+
+	mint_bzero(&opts, sizeof(opts));
+	mint_bzero(&dir, sizeof(dir));
+
+	if (attr)
+	{
+		if (attr->nactions < 0 || attr->nactions > SPAWN_MAX_ACTIONS)
+			return EINVAL;
+
+		if (attr->nactions)
+		{
+			if (!attr->actions)
+				return EFAULT;
+
+			files = kmalloc(attr->nactions * sizeof(*files));
+			if (!files)
+				return ENOMEM;
+
+			mint_bzero(files, attr->nactions * sizeof(*files));
+
+			r = spawn_prepare(get_curproc(), attr, files, &dir);
+			if (r)
+				goto leave;
+		}
+
+		opts.mode = CREATE_PROCESS_OPTS_SPAWN;
+		opts.spawn = attr;
+		opts.spawn_files = files;
+		opts.spawn_dir = &dir;
+	}
+
+	r = create_process(path, cmdline, env, &p, 0, attr ? &opts : NULL);
+	if (!r)
+		r = p ? p->pid : EINTERNAL;
+
+leave:
+	if (files)
+	{
+		/* not handed over to a child */
+		for (i = 0; i < attr->nactions; i++)
+		{
+			if (files[i])
+				do_close(get_curproc(), files[i]);
+		}
+
+		kfree(files);
+	}
+
+	if (dir.fs)
+		release_cookie(&dir);
+
+	return r;
+}
@@ -30,6 +30,7 @@
 # define _k_exec_h
 
 # include "mint/mint.h"
+# include "mint/spawn.h"
 
 struct create_process_opts
 {
@@ -39,12 +40,16 @@ struct create_process_opts
 #define CREATE_PROCESS_OPTS_DEFDIR	0x04
 #define CREATE_PROCESS_OPTS_UID		0x08
 #define CREATE_PROCESS_OPTS_GID		0x10
+#define CREATE_PROCESS_OPTS_SPAWN	0x20
 	
 	long maxcore;
 	long nicelevel;
 	const char *defdir;
 	unsigned short uid;
 	unsigned short gid;
+	const struct spawn_attr *spawn;	/* Pspawn() attributes and actions */
+	struct file **spawn_files;	/* files for SPAWN_OPEN and SPAWN_DUP2 */
+	fcookie *spawn_dir;		/* resolved SPAWN_CHDIR directory */
 };
 
 #if __KERNEL__ == 1
@@ -52,6 +57,8 @@ struct create_process_opts
 void rts (void); /* XXX */
 
 long _cdecl sys_pexec (short mode, const void *ptr1, const void *ptr2, const void *ptr3);
+long _cdecl sys_p_spawn (const char *path, const char *cmdline, const char *env,
+			  const struct spawn_attr *attr);
 
 long _cdecl create_process(const void *ptr1, const void *ptr2, const void *ptr3,
 			   struct proc **pret, long stack, struct create_process_opts *);
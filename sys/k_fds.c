@@ -39,6 +39,7 @@
 
 # include "biosfs.h"
 # include "dosfile.h"
+# include "execcache.h"
 # include "filesys.h"
 # include "k_prot.h"
 # include "kerinfo.h"
@@ -713,6 +714,10 @@ do_close (struct proc *p, FILEPTR *f)
 
 	if (f->links <= 0)
 	{
+		/* a cached image of the program may be stale now */
+		if ((f->flags & O_RWMODE) == O_WRONLY || (f->flags & O_RWMODE) == O_RDWR)
+			exec_cache_invalidate (&f->fc);
+
 		release_cookie (&f->fc);
 		FP_FREE (f);
 	}
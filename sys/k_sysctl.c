@@ -43,8 +43,10 @@
 # include "info.h"
 # include "k_prot.h"
 # include "keyboard.h"
+# include "kprof.h"
 # include "memory.h"
 # include "proc.h"
+# include "sctrace.h"
 # include "time.h"
 
 
@@ -219,6 +221,34 @@ kern_sysctl (long *name, ulong namelen, void *oldp, ulong *oldlenp,
 
 		case KERN_SYSDIR:
 			return sysctl_rdstring (oldp, oldlenp, newp, sysdir);
+
+		case KERN_SCTRACE:
+		{
+			long on = sctrace_on;
+
+			ret = sysctl_long (oldp, oldlenp, newp, newlen, &on);
+			if (ret || newp == NULL)
+				return ret;
+
+			return sctrace_enable (on);
+		}
+
+		case KERN_SCTRACE_PID:
+			return sysctl_long (oldp, oldlenp, newp, newlen, &sctrace_pid);
+
+		case KERN_SCTRACE_MASK:
+			return sysctl_long (oldp, oldlenp, newp, newlen, &sctrace_mask);
+
+		case KERN_PROFILE:
+		{
+			long on = kprof_on;
+
+			ret = sysctl_long (oldp, oldlenp, newp, newlen, &on);
+			if (ret || newp == NULL)
+				return ret;
+
+			return kprof_enable (on);
+		}
 	}
 
 	return EOPNOTSUPP;
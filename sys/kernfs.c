@@ -62,10 +62,12 @@
 # include "filesys.h"
 # include "kernget.h"
 # include "kmemory.h"
+# include "kprof.h"
 # include "memory.h"
 # include "nullfs.h"
 # include "proc.h"
 # include "procfs.h"
+# include "sctrace.h"
 # include "signal.h"
 # include "time.h"
 # include "unifs.h"
@@ -234,6 +236,10 @@ struct ktab
 # define ROOTDIR_BUILDINFO	0x12
 # define ROOTDIR_STAT       	0x13
 # define ROOTDIR_SYSDIR		0x14
+# define ROOTDIR_SLABINFO	0x15
+# define ROOTDIR_SCTRACE	0x16
+# define ROOTDIR_PROFILE	0x17
+# define ROOTDIR_PROFMAP	0x18
 
 static KENTRY __rootdir [] =
 {
@@ -252,7 +258,11 @@ static KENTRY __rootdir [] =
 	{ ROOTDIR_MEMDEBUG,	S_IFREG | 0444,	"memdebug",	kern_get_memdebug	},
 # endif
 	{ ROOTDIR_MEMINFO,	S_IFREG | 0444,	"meminfo",	kern_get_meminfo	},
+	{ ROOTDIR_PROFILE,	S_IFREG | 0444,	"profile",	kern_get_profile	},
+	{ ROOTDIR_PROFMAP,	S_IFREG | 0444,	"profmap",	kern_get_profmap	},
+	{ ROOTDIR_SCTRACE,	S_IFREG | 0444,	"sctrace",	kern_get_sctrace	},
 	{ ROOTDIR_SELF,		S_IFLNK | 0777,	"self",		kern_get_unimplemented	},
+	{ ROOTDIR_SLABINFO,	S_IFREG | 0444,	"slabinfo",	kern_get_slabinfo	},
 	{ ROOTDIR_STAT,		S_IFREG | 0444,	"stat",		kern_get_stat		},
 	{ ROOTDIR_SYSDIR,	S_IFREG | 0444, "sysdir",	kern_get_sysdir		},
 	{ ROOTDIR_TIME,		S_IFREG | 0444,	"time",		kern_get_time		},
@@ -82,6 +82,7 @@
 # define S2_MAGIC	(0x5332)
 # define LB_MAGIC	(0x5333)
 # define ST_MAGIC	(0x5334)
+# define KC_MAGIC	(0x5335)
 
 # define MR_SIZE	((sizeof (MEMREGION) + MR_HEAD + 3) & ~3)
 # define S1_SIZE	(16UL * 3)
@@ -177,6 +178,7 @@ typedef struct km_mr KM_MR;
 typedef struct km_s1 KM_S1;
 typedef struct km_s2 KM_S2;
 typedef struct km_lb KM_LB;
+typedef struct km_kc KM_KC;
 
 
 struct list
@@ -218,6 +220,13 @@ struct km_p
 			ulong	size;
 # endif
 		} s2;
+
+		struct
+		{
+			KM_KC	*free;
+			KMEM_CACHE *cache;
+			ushort	used;
+		} kc;
 	} s;
 # define P__HEAD	((sizeof (KM_P) + 15) & ~15)
 };
@@ -307,6 +316,13 @@ struct km_s2
 
 # endif  /* KMEMORY_DEBUG */
 
+struct km_kc
+{
+	KM_S	s;
+# define KC_HEAD	(S__HEAD)
+	KM_KC	*next;	/* overlays the object while it is free */
+};
+
 
 /*
  * internal prototypes
@@ -1362,6 +1378,299 @@ km_lb_dump (void)
 /* END large block alloc */
 /****************************************************************************/
 
+/****************************************************************************/
+/* BEGIN object cache alloc */
+
+/*
+ * A cache hands out objects of one size and alignment from slabs of
+ * PAGESIZE. Every slot carries the usual KM_S head, the free objects
+ * of a slab are linked through their first long.
+ *
+ * Slabs with free objects are on the partial list, completely used
+ * slabs on the full list. One empty slab per cache is kept to avoid
+ * trashing on alloc/free sequences around a slab boundary.
+ */
+
+struct kmem_cache
+{
+	KMEM_CACHE	*next;		/* list of all caches */
+	const char	*name;
+	ulong		size;		/* object size */
+	ulong		stride;		/* slot size including KC_HEAD */
+	ulong		first;		/* offset of the first slot */
+	ulong		perslab;	/* objects per slab */
+	LIST		partial;	/* slabs with free objects */
+	LIST		full;		/* slabs without free objects */
+	ulong		empty;		/* # of empty slabs */
+	ulong		slabs;		/* # of slabs */
+	ulong		inuse;		/* # of allocated objects */
+	ulong		allocs;		/* statistics */
+	ulong		fails;
+};
+
+/* below this a cache doesn't pay off, use kmalloc */
+# define KC_MINOBJS	8
+
+static KMEM_CACHE *kc_caches = NULL;
+
+static KM_P *
+km_kc_grow (KMEM_CACHE *cache)
+{
+	MEMREGION *m;
+	KM_P *page;
+
+	m = kmr_get ();
+	if (!m)
+		return NULL;
+
+	page = km_malloc (PAGESIZE, m, NULL);
+	if (!page)
+	{
+		kmr_free (m);
+		return NULL;
+	}
+
+	page->magic = KC_MAGIC;
+	page->s.kc.cache = cache;
+	page->s.kc.used = 0;
+
+	{
+		register char *ptr = (char *) page + cache->first;
+		register KM_KC *temp = NULL;
+		register ulong i;
+
+		page->s.kc.free = (KM_KC *) ptr;
+
+		for (i = cache->perslab; i; i--)
+		{
+			temp = (KM_KC *) ptr;
+			temp->s.page = page;
+
+			ptr += cache->stride;
+
+			temp->next = (KM_KC *) ptr;
+		}
+
+		temp->next = NULL;
+	}
+
+	km_list_insert (&cache->partial, page);
+
+	cache->slabs++;
+	cache->empty++;
+
+	return page;
+}
+
+static void
+km_kc_shrink (KMEM_CACHE *cache, KM_P *page)
+{
+	KM_ASSERT ((page->s.kc.used == 0));
+
+	km_list_remove (&cache->partial, page);
+
+	cache->slabs--;
+	cache->empty--;
+
+	km_free (page->self);
+}
+
+KMEM_CACHE *
+kmem_cache_create (const char *name, unsigned long size, unsigned long align)
+{
+	KMEM_CACHE *cache;
+	ulong first, stride;
+
+	if (align < 4)
+		align = 4;
+
+	/* page start is only 16 byte aligned */
+	if (align > 16 || (align & (align - 1)) || !size)
+	{
+		KM_ALERT (("kmem_cache_create(%s): invalid size %lu or align %lu", name, size, align));
+		return NULL;
+	}
+
+	if (size < sizeof (KM_KC *))
+		size = sizeof (KM_KC *);
+
+	first = ((P__HEAD + KC_HEAD + align - 1) & ~(align - 1)) - KC_HEAD;
+	stride = (KC_HEAD + size + align - 1) & ~(align - 1);
+
+	if ((PAGESIZE - first) / stride < KC_MINOBJS)
+	{
+		KM_ALERT (("kmem_cache_create(%s): object size %lu too large", name, size));
+		return NULL;
+	}
+
+	cache = kmalloc (sizeof (*cache));
+	if (!cache)
+		return NULL;
+
+	mint_bzero (cache, sizeof (*cache));
+
+	cache->name = name;
+	cache->size = size;
+	cache->stride = stride;
+	cache->first = first;
+	cache->perslab = (PAGESIZE - first) / stride;
+
+	km_list_init (&cache->partial);
+	km_list_init (&cache->full);
+
+	cache->next = kc_caches;
+	kc_caches = cache;
+
+	return cache;
+}
+
+void
+kmem_cache_destroy (KMEM_CACHE *cache)
+{
+	KMEM_CACHE **list;
+
+	if (cache->inuse)
+	{
+		/* leak it, the objects still point into the slabs */
+		KM_ALERT (("kmem_cache_destroy(%s): %lu objects in use", cache->name, cache->inuse));
+		return;
+	}
+
+	KM_ASSERT ((km_list_empty (&cache->full)));
+
+	while (cache->partial.head)
+		km_kc_shrink (cache, cache->partial.head);
+
+	for (list = &kc_caches; *list; list = &((*list)->next))
+	{
+		if (*list == cache)
+		{
+			*list = cache->next;
+			break;
+		}
+	}
+
+	kfree (cache);
+}
+
+void *
+kmem_cache_alloc (KMEM_CACHE *cache)
+{
+	register KM_P *page = cache->partial.head;
+	register KM_KC *new;
+
+	if (!page)
+	{
+		page = km_kc_grow (cache);
+		if (!page)
+		{
+			cache->fails++;
+
+			KM_ALERT (("kmem_cache_alloc(%s) fail, out of memory?", cache->name));
+			return NULL;
+		}
+	}
+
+	new = page->s.kc.free;
+
+	KM_ASSERT ((new->s.page == page));
+
+	if (page->s.kc.used++ == 0)
+		cache->empty--;
+
+	page->s.kc.free = new->next;
+	if (!page->s.kc.free)
+	{
+		km_list_remove (&cache->partial, page);
+		km_list_insert (&cache->full, page);
+	}
+
+	cache->inuse++;
+	cache->allocs++;
+
+	return ((char *) new + KC_HEAD);
+}
+
+void
+kmem_cache_free (KMEM_CACHE *cache, void *obj)
+{
+	register KM_KC *ptr = (KM_KC *)((char *) obj - KC_HEAD);
+	register KM_P *page = ptr->s.page;
+
+	if (!page || page->magic != KC_MAGIC || page->s.kc.cache != cache)
+		FATAL ("kmem_cache_free(%s): 0x%lx not from this cache!", cache->name, (ulong) obj);
+
+# ifdef KMEMORY_DEBUG
+	mint_bzero (obj, cache->size);
+# endif
+
+	if (!page->s.kc.free)
+	{
+		km_list_remove (&cache->full, page);
+		km_list_insert (&cache->partial, page);
+	}
+
+	ptr->next = page->s.kc.free;
+	page->s.kc.free = ptr;
+
+	cache->inuse--;
+
+	if (--page->s.kc.used == 0)
+	{
+		/* keep only one spare slab */
+		if (cache->empty++)
+			km_kc_shrink (cache, page);
+	}
+}
+
+# if WITH_KERNFS
+long
+kern_get_slabinfo (SIZEBUF **buffer, const struct proc *p)
+{
+	KMEM_CACHE *cache;
+	SIZEBUF *info;
+	ulong len = 128;
+	ulong i;
+	char *crs;
+
+	UNUSED (p);
+
+	for (cache = kc_caches; cache; cache = cache->next)
+		len += 96;
+
+	info = kmalloc (sizeof (*info) + len);
+	if (!info)
+		return ENOMEM;
+
+	crs = info->buf;
+
+	i = ksprintf (crs, len, "# name             active     objs objsize  slab  slabs     allocs  fails\n");
+	crs += i; len -= i;
+
+	for (cache = kc_caches; cache; cache = cache->next)
+	{
+		i = ksprintf (crs, len, "%16s %8lu %8lu %7lu %5lu %6lu %10lu %6lu\n",
+				cache->name,
+				cache->inuse,
+				cache->slabs * cache->perslab,
+				cache->size,
+				cache->perslab,
+				cache->slabs,
+				cache->allocs,
+				cache->fails);
+		crs += i; len -= i;
+	}
+
+	info->len = crs - info->buf;
+	*buffer = info;
+
+	return 0;
+}
+# endif
+
+/* END object cache alloc */
+/****************************************************************************/
+
 /****************************************************************************/
 /* BEGIN kernel memory alloc */
 
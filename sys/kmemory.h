@@ -51,6 +51,18 @@ void *	_cdecl	_dmabuf_alloc	(unsigned long size, short cmode, const char *func);
 
 # define dmabuf_alloc(size,cm)	_dmabuf_alloc(size, cm, FUNCTION)
 
+/* object caches
+ *
+ * fixed size objects from per cache slabs, alloc and free are O(1);
+ * objects must be released with kmem_cache_free, not kfree
+ */
+typedef struct kmem_cache KMEM_CACHE;
+
+KMEM_CACHE *	kmem_cache_create	(const char *name, unsigned long size, unsigned long align);
+void		kmem_cache_destroy	(KMEM_CACHE *cache);
+void *		kmem_cache_alloc	(KMEM_CACHE *cache);
+void		kmem_cache_free		(KMEM_CACHE *cache, void *obj);
+
 void		init_kmemory	(void); /* initalize km allocator */
 long		km_config	(long mode, long arg);
 
@@ -59,4 +71,8 @@ long		km_config	(long mode, long arg);
 
 long		km_trace_lookup	(void *ptr, char *buf, unsigned long buflen);
 
+# if WITH_KERNFS
+long		kern_get_slabinfo (SIZEBUF **buffer, const struct proc *p);
+# endif
+
 # endif /* _kmemory_h */
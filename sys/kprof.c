@@ -0,0 +1,207 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *
+ * system wide profiling
+ *
+ * While kern.profile is set the 200 Hz timer interrupt records the
+ * interrupted PC together with the current process into a ring
+ * buffer, no matter if it hits the kernel, a driver, XaAES or a user
+ * program. /kern/profile hands out the samples and /kern/profmap the
+ * text segments of the kernel, the modules, the shared libraries and
+ * the processes to resolve them.
+ *
+ */
+
+# include "kprof.h"
+# include "global.h"
+
+# include "libkern/libkern.h"
+# include "mint/basepage.h"
+# include "mint/proc.h"
+
+# include "arch/kernel.h"	/* in_kernel */
+
+# include "kmemory.h"
+# include "module.h"
+# include "slb.h"
+
+
+short kprof_on = 0;
+
+static struct kprof_sample *samples = NULL;
+static ulong nsamples = 0;
+
+
+/*
+ * kern.profile: nonzero starts a new profile, 0 stops it;
+ * the samples stay readable until the next start
+ */
+long
+kprof_enable (long on)
+{
+	if (!on)
+	{
+		kprof_on = 0;
+		return E_OK;
+	}
+
+	if (!samples)
+	{
+		samples = kmalloc (KPROF_SAMPLES * sizeof (*samples));
+		if (!samples)
+			return ENOMEM;
+	}
+
+	/* not while the interrupt writes */
+	kprof_on = 0;
+	nsamples = 0;
+
+	kprof_on = 1;
+
+	return E_OK;
+}
+
+/*
+ * called from the 5ms interrupt, keep it short
+ */
+void _cdecl
+kprof_sample (ulong pc, ulong sr)
+{
+	struct kprof_sample *s = &samples[nsamples++ % KPROF_SAMPLES];
+
+	s->pc = pc;
+	s->pid = curproc->pid;
+	s->flags = 0;
+
+	if (sr & 0x2000)
+		s->flags |= KPROF_SUPER;
+	if (in_kernel)
+		s->flags |= KPROF_KERNEL;
+}
+
+# if WITH_KERNFS
+/*
+ * the samples in binary form, oldest first; the interrupt
+ * may overwrite the oldest ones while we copy, that's not worth
+ * blocking it for
+ */
+long
+kern_get_profile (SIZEBUF **buffer, const struct proc *p)
+{
+	SIZEBUF *info;
+	struct kprof_sample *out;
+	ulong first, last, i;
+
+	UNUSED (p);
+
+	last = nsamples;
+	first = (last > KPROF_SAMPLES) ? last - KPROF_SAMPLES : 0;
+
+	info = kmalloc (sizeof (*info) + (last - first) * sizeof (*out));
+	if (!info)
+		return ENOMEM;
+
+	out = (struct kprof_sample *) info->buf;
+
+	for (i = first; i < last; i++)
+		*out++ = samples[i % KPROF_SAMPLES];
+
+	info->len = (char *) out - info->buf;
+	*buffer = info;
+
+	return 0;
+}
+
+/*
+ * text segments, one per line:
+ * start end pid type name
+ * where pid is 0 for everything that isn't process specific
+ */
+long
+kern_get_profmap (SIZEBUF **buffer, const struct proc *p)
+{
+	struct kernel_module *km;
+	SHARED_LIB *slb;
+	struct proc *q;
+	SIZEBUF *info;
+	ulong len = 128;
+	ulong i;
+	char *crs;
+
+	UNUSED (p);
+
+	for (km = loaded_modules; km; km = km->next)
+		len += 96;
+	for (slb = slb_list; slb; slb = slb->slb_next)
+		len += 96;
+	for (q = proclist; q; q = q->gl_next)
+		len += 64;
+
+	info = kmalloc (sizeof (*info) + len);
+	if (!info)
+		return ENOMEM;
+
+	crs = info->buf;
+
+	i = ksprintf (crs, len, "%08lx %08lx %5d kernel %s\n",
+			_base->p_tbase, _base->p_tbase + _base->p_tlen, 0, "mint");
+	crs += i; len -= i;
+
+	for (km = loaded_modules; km; km = km->next)
+	{
+		i = ksprintf (crs, len, "%08lx %08lx %5d module %s\n",
+				km->b->p_tbase, km->b->p_tbase + km->b->p_tlen, 0, km->name);
+		crs += i; len -= i;
+	}
+
+	for (slb = slb_list; slb; slb = slb->slb_next)
+	{
+		BASEPAGE *b;
+
+		if (!slb->slb_proc || !slb->slb_proc->p_mem)
+			continue;
+
+		b = slb->slb_proc->p_mem->base;
+
+		i = ksprintf (crs, len, "%08lx %08lx %5d slb %s\n",
+				b->p_tbase, b->p_tbase + b->p_tlen, 0, slb->slb_name);
+		crs += i; len -= i;
+	}
+
+	for (q = proclist; q; q = q->gl_next)
+	{
+		BASEPAGE *b;
+
+		if (!q->p_mem || !q->p_mem->base || q == rootproc)
+			continue;
+
+		b = q->p_mem->base;
+
+		i = ksprintf (crs, len, "%08lx %08lx %5d proc %s\n",
+				b->p_tbase, b->p_tbase + b->p_tlen, q->pid, q->name);
+		crs += i; len -= i;
+	}
+
+	info->len = crs - info->buf;
+	*buffer = info;
+
+	return 0;
+}
+# endif
@@ -0,0 +1,295 @@
+/*
+ * This file belongs to FreeMiNT.  It's not in the original MiNT 1.12
+ * distribution.  See the file Changes.MH for a detailed log of changes.
+ * 
+ * 
+ * aes.c
+ * 
+ * AES-128 (FIPS-197) in the usual 32 bit table driven form: one
+ * round is 16 table lookups. Only one table per direction is kept
+ * (the others are rotations of it), so everything fits into 2.5 kB
+ * that are computed on first use instead of being stored.
+ * 
+ * Without M68000 the rounds are unrolled.
+ * 
+ */
+
+# include "aes.h"
+
+
+static __u32 Te[256];
+static __u32 Td[256];
+static unsigned char S[256];
+static unsigned char Si[256];
+static short aes_ready = 0;
+
+# define ROTR8(x)	(((x) >> 8) | ((x) << 24))
+# define ROTR16(x)	(((x) >> 16) | ((x) << 16))
+# define ROTR24(x)	(((x) >> 24) | ((x) << 8))
+
+# define Te0(x)		Te[x]
+# define Te1(x)		ROTR8 (Te[x])
+# define Te2(x)		ROTR16 (Te[x])
+# define Te3(x)		ROTR24 (Te[x])
+
+# define Td0(x)		Td[x]
+# define Td1(x)		ROTR8 (Td[x])
+# define Td2(x)		ROTR16 (Td[x])
+# define Td3(x)		ROTR24 (Td[x])
+
+# define B0(x)		((x) >> 24)
+# define B1(x)		(((x) >> 16) & 0xff)
+# define B2(x)		(((x) >> 8) & 0xff)
+# define B3(x)		((x) & 0xff)
+
+# define GETU32(p)	(((__u32)(p)[0] << 24) | ((__u32)(p)[1] << 16) | ((__u32)(p)[2] << 8) | (__u32)(p)[3])
+# define PUTU32(p, v)	{ (p)[0] = (v) >> 24; (p)[1] = (v) >> 16; (p)[2] = (v) >> 8; (p)[3] = (v); }
+
+
+static unsigned char
+xtime (unsigned char x)
+{
+	return (x << 1) ^ ((x & 0x80) ? 0x1b : 0);
+}
+
+static unsigned char
+gmul (unsigned char a, unsigned char b)
+{
+	unsigned char r = 0;
+
+	while (b)
+	{
+		if (b & 1)
+			r ^= a;
+
+		a = xtime (a);
+		b >>= 1;
+	}
+
+	return r;
+}
+
+static void
+aes_init (void)
+{
+	unsigned char p = 1, q = 1;
+	int i;
+
+	/* walk the field with generator 3 and its inverse */
+	do {
+		unsigned char x;
+
+		p = p ^ xtime (p);
+
+		q ^= q << 1;
+		q ^= q << 2;
+		q ^= q << 4;
+		if (q & 0x80)
+			q ^= 0x09;
+
+		/* affine transformation of the inverse q of p */
+		x = q ^ ((q << 1) | (q >> 7)) ^ ((q << 2) | (q >> 6))
+		      ^ ((q << 3) | (q >> 5)) ^ ((q << 4) | (q >> 4));
+
+		S[p] = x ^ 0x63;
+	}
+	while (p != 1);
+
+	S[0] = 0x63;
+
+	for (i = 0; i < 256; i++)
+		Si[S[i]] = i;
+
+	for (i = 0; i < 256; i++)
+	{
+		unsigned char s = S[i];
+		unsigned char si = Si[i];
+
+		Te[i] = ((__u32) xtime (s) << 24) | ((__u32) s << 16)
+			| ((__u32) s << 8) | (__u32) (xtime (s) ^ s);
+
+		Td[i] = ((__u32) gmul (si, 0x0e) << 24) | ((__u32) gmul (si, 0x09) << 16)
+			| ((__u32) gmul (si, 0x0d) << 8) | (__u32) gmul (si, 0x0b);
+	}
+
+	aes_ready = 1;
+}
+
+void
+AES_set_encrypt_key (struct aes_key *key, const unsigned char userkey[16])
+{
+	__u32 *rk = key->rk;
+	unsigned char rc = 1;
+	int i;
+
+	if (!aes_ready)
+		aes_init ();
+
+	rk[0] = GETU32 (userkey);
+	rk[1] = GETU32 (userkey + 4);
+	rk[2] = GETU32 (userkey + 8);
+	rk[3] = GETU32 (userkey + 12);
+
+	for (i = 0; i < AES_ROUNDS; i++)
+	{
+		__u32 temp = rk[3];
+
+		rk[4] = rk[0]
+			^ ((__u32) S[B1 (temp)] << 24)
+			^ ((__u32) S[B2 (temp)] << 16)
+			^ ((__u32) S[B3 (temp)] << 8)
+			^ ((__u32) S[B0 (temp)])
+			^ ((__u32) rc << 24);
+		rk[5] = rk[1] ^ rk[4];
+		rk[6] = rk[2] ^ rk[5];
+		rk[7] = rk[3] ^ rk[6];
+
+		rc = xtime (rc);
+		rk += 4;
+	}
+}
+
+void
+AES_set_decrypt_key (struct aes_key *key, const unsigned char userkey[16])
+{
+	__u32 *rk = key->rk;
+	int i, j;
+
+	AES_set_encrypt_key (key, userkey);
+
+	/* reverse the order of the round keys */
+	for (i = 0, j = 4 * AES_ROUNDS; i < j; i += 4, j -= 4)
+	{
+		int k;
+
+		for (k = 0; k < 4; k++)
+		{
+			__u32 temp = rk[i + k];
+
+			rk[i + k] = rk[j + k];
+			rk[j + k] = temp;
+		}
+	}
+
+	/* apply the inverse MixColumn to all but the first and last */
+	for (i = 4; i < 4 * AES_ROUNDS; i++)
+	{
+		__u32 w = rk[i];
+
+		rk[i] = Td0 (S[B0 (w)]) ^ Td1 (S[B1 (w)]) ^ Td2 (S[B2 (w)]) ^ Td3 (S[B3 (w)]);
+	}
+}
+
+# define ENC_ROUND(d0, d1, d2, d3, s0, s1, s2, s3, rk) \
+	d0 = Te0 (B0 (s0)) ^ Te1 (B1 (s1)) ^ Te2 (B2 (s2)) ^ Te3 (B3 (s3)) ^ (rk)[0]; \
+	d1 = Te0 (B0 (s1)) ^ Te1 (B1 (s2)) ^ Te2 (B2 (s3)) ^ Te3 (B3 (s0)) ^ (rk)[1]; \
+	d2 = Te0 (B0 (s2)) ^ Te1 (B1 (s3)) ^ Te2 (B2 (s0)) ^ Te3 (B3 (s1)) ^ (rk)[2]; \
+	d3 = Te0 (B0 (s3)) ^ Te1 (B1 (s0)) ^ Te2 (B2 (s1)) ^ Te3 (B3 (s2)) ^ (rk)[3]
+
+# define ENC_LAST(s0, s1, s2, s3, rk) \
+	(((__u32) S[B0 (s0)] << 24) ^ ((__u32) S[B1 (s1)] << 16) \
+	 ^ ((__u32) S[B2 (s2)] << 8) ^ (__u32) S[B3 (s3)] ^ (rk))
+
+# define DEC_ROUND(d0, d1, d2, d3, s0, s1, s2, s3, rk) \
+	d0 = Td0 (B0 (s0)) ^ Td1 (B1 (s3)) ^ Td2 (B2 (s2)) ^ Td3 (B3 (s1)) ^ (rk)[0]; \
+	d1 = Td0 (B0 (s1)) ^ Td1 (B1 (s0)) ^ Td2 (B2 (s3)) ^ Td3 (B3 (s2)) ^ (rk)[1]; \
+	d2 = Td0 (B0 (s2)) ^ Td1 (B1 (s1)) ^ Td2 (B2 (s0)) ^ Td3 (B3 (s3)) ^ (rk)[2]; \
+	d3 = Td0 (B0 (s3)) ^ Td1 (B1 (s2)) ^ Td2 (B2 (s1)) ^ Td3 (B3 (s0)) ^ (rk)[3]
+
+# define DEC_LAST(s0, s1, s2, s3, rk) \
+	(((__u32) Si[B0 (s0)] << 24) ^ ((__u32) Si[B1 (s1)] << 16) \
+	 ^ ((__u32) Si[B2 (s2)] << 8) ^ (__u32) Si[B3 (s3)] ^ (rk))
+
+void
+AES_encrypt (const struct aes_key *key, const unsigned char in[16], unsigned char out[16])
+{
+	const __u32 *rk = key->rk;
+	__u32 s0, s1, s2, s3, t0, t1, t2, t3;
+
+	s0 = GETU32 (in     ) ^ rk[0];
+	s1 = GETU32 (in +  4) ^ rk[1];
+	s2 = GETU32 (in +  8) ^ rk[2];
+	s3 = GETU32 (in + 12) ^ rk[3];
+
+# ifdef M68000
+	{
+		int r;
+
+		for (r = 1; r < AES_ROUNDS; r++)
+		{
+			ENC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 4 * r);
+			s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+		}
+	}
+# else
+	ENC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk +  4);
+	ENC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk +  8);
+	ENC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 12);
+	ENC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk + 16);
+	ENC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 20);
+	ENC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk + 24);
+	ENC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 28);
+	ENC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk + 32);
+	ENC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 36);
+	s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+# endif
+
+	rk += 4 * AES_ROUNDS;
+
+	t0 = ENC_LAST (s0, s1, s2, s3, rk[0]);
+	t1 = ENC_LAST (s1, s2, s3, s0, rk[1]);
+	t2 = ENC_LAST (s2, s3, s0, s1, rk[2]);
+	t3 = ENC_LAST (s3, s0, s1, s2, rk[3]);
+
+	PUTU32 (out     , t0);
+	PUTU32 (out +  4, t1);
+	PUTU32 (out +  8, t2);
+	PUTU32 (out + 12, t3);
+}
+
+void
+AES_decrypt (const struct aes_key *key, const unsigned char in[16], unsigned char out[16])
+{
+	const __u32 *rk = key->rk;
+	__u32 s0, s1, s2, s3, t0, t1, t2, t3;
+
+	s0 = GETU32 (in     ) ^ rk[0];
+	s1 = GETU32 (in +  4) ^ rk[1];
+	s2 = GETU32 (in +  8) ^ rk[2];
+	s3 = GETU32 (in + 12) ^ rk[3];
+
+# ifdef M68000
+	{
+		int r;
+
+		for (r = 1; r < AES_ROUNDS; r++)
+		{
+			DEC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 4 * r);
+			s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+		}
+	}
+# else
+	DEC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk +  4);
+	DEC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk +  8);
+	DEC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 12);
+	DEC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk + 16);
+	DEC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 20);
+	DEC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk + 24);
+	DEC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 28);
+	DEC_ROUND (s0, s1, s2, s3, t0, t1, t2, t3, rk + 32);
+	DEC_ROUND (t0, t1, t2, t3, s0, s1, s2, s3, rk + 36);
+	s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+# endif
+
+	rk += 4 * AES_ROUNDS;
+
+	t0 = DEC_LAST (s0, s3, s2, s1, rk[0]);
+	t1 = DEC_LAST (s1, s0, s3, s2, rk[1]);
+	t2 = DEC_LAST (s2, s1, s0, s3, rk[2]);
+	t3 = DEC_LAST (s3, s2, s1, s0, rk[3]);
+
+	PUTU32 (out     , t0);
+	PUTU32 (out +  4, t1);
+	PUTU32 (out +  8, t2);
+	PUTU32 (out + 12, t3);
+}
@@ -25,12 +25,14 @@
 # include "arch/user_things.h"
 
 # include "bios.h"
+# include "execcache.h"
 # include "filesys.h"
 # include "info.h"
 # include "init.h"		/* boot_printf() */
 # include "k_exec.h"
 # include "k_fds.h"
 # include "kmemory.h"
+# include "mmap.h"
 # include "proc_help.h"
 # include "util.h"
 
@@ -113,6 +115,222 @@ unsigned long initialmem = 1024;	/* ditto */
 /* macro for testing whether a memory region is free */
 # define ISFREE(m) ((m)->links == 0)
 
+/*
+ * free region index
+ *
+ * The free regions of the core and alt map are also kept in
+ * segregated lists; bucket n holds the regions of 2^n up to
+ * 2^(n+1) - 1 quanta. The address ordered map is the master copy,
+ * the index is only a hint: entries are validated on use, stale ones
+ * (region in use again or resized) are moved or dropped, and a miss
+ * rebuilds the index from the map before an allocation fails.
+ *
+ * The one hard rule: a descriptor must leave the index before it is
+ * given back with kmr_free().
+ */
+
+# define FI_BUCKETS	24
+
+struct findex
+{
+	MEMREGION	*bucket [FI_BUCKETS];
+	short		valid;		/* index is built */
+};
+
+static struct findex core_findex;
+static struct findex alt_findex;
+
+static struct findex *
+fi_get (MMAP map)
+{
+	if (map == core)
+		return &core_findex;
+	if (map == alt)
+		return &alt_findex;
+
+	return NULL;
+}
+
+static long
+fi_bucket (ulong len)
+{
+	ulong q = len / QUANTUM;
+	long b = 0;
+
+	while ((q >>= 1) && b < FI_BUCKETS - 1)
+		b++;
+
+	return b;
+}
+
+static void
+fi_remove (MEMREGION *m)
+{
+	struct findex *fi;
+
+	if (!m->fbucket)
+		return;
+
+	fi = (m->mflags & M_CORE) ? &core_findex : &alt_findex;
+
+	if (m->fprev)
+		m->fprev->fnext = m->fnext;
+	else
+		fi->bucket [m->fbucket - 1] = m->fnext;
+
+	if (m->fnext)
+		m->fnext->fprev = m->fprev;
+
+	m->fnext = m->fprev = NULL;
+	m->fbucket = 0;
+}
+
+/* (re)index a region of the core or alt map according to its state */
+static void
+fi_update (MEMREGION *m)
+{
+	struct findex *fi;
+	long b;
+
+	fi_remove (m);
+
+	if (m->mflags & M_CORE)
+		fi = &core_findex;
+	else if (m->mflags & M_ALT)
+		fi = &alt_findex;
+	else
+		return;
+
+	if (!fi->valid || !ISFREE (m) || !m->len)
+		return;
+
+	b = fi_bucket (m->len);
+
+	m->fprev = NULL;
+	m->fnext = fi->bucket [b];
+	if (m->fnext)
+		m->fnext->fprev = m;
+
+	fi->bucket [b] = m;
+	m->fbucket = b + 1;
+}
+
+static void
+fi_build (MMAP map)
+{
+	struct findex *fi = fi_get (map);
+	MEMREGION *m;
+	long b;
+
+	if (!fi)
+		return;
+
+	for (b = 0; b < FI_BUCKETS; b++)
+	{
+		while (fi->bucket [b])
+			fi_remove (fi->bucket [b]);
+	}
+
+	fi->valid = 1;
+
+	for (m = *map; m; m = m->next)
+		fi_update (m);
+}
+
+/*
+ * find a free region of at least size bytes:
+ * the best fit, or with kernel_flag the one at the highest address
+ */
+static MEMREGION *
+fi_lookup (MMAP map, ulong size, short kernel_flag)
+{
+	struct findex *fi = fi_get (map);
+	MEMREGION *m, *next, *best = NULL;
+	long b;
+
+	if (!fi)
+		return NULL;
+
+	if (!fi->valid)
+		fi_build (map);
+
+	for (b = fi_bucket (size); b < FI_BUCKETS; b++)
+	{
+		for (m = fi->bucket [b]; m; m = next)
+		{
+			next = m->fnext;
+
+			if (!ISFREE (m))
+			{
+				/* in use again */
+				fi_remove (m);
+				continue;
+			}
+
+			if (fi_bucket (m->len) != b)
+				/* resized, but still a candidate */
+				fi_update (m);
+
+			if (m->len < size)
+				continue;
+
+			if (kernel_flag)
+			{
+				if (!best || m->loc > best->loc)
+					best = m;
+			}
+			else if (!best || m->len < best->len)
+			{
+				best = m;
+				if (m->len == size)
+					return m;
+			}
+		}
+
+		if (best && !kernel_flag)
+			break;
+	}
+
+	return best;
+}
+
+/* the biggest free region of the map */
+static MEMREGION *
+fi_largest (MMAP map)
+{
+	struct findex *fi = fi_get (map);
+	MEMREGION *m, *next, *best = NULL;
+	long b;
+
+	if (!fi)
+		return NULL;
+
+	if (!fi->valid)
+		fi_build (map);
+
+	for (b = FI_BUCKETS - 1; b >= 0 && !best; b--)
+	{
+		for (m = fi->bucket [b]; m; m = next)
+		{
+			next = m->fnext;
+
+			if (!ISFREE (m))
+			{
+				fi_remove (m);
+				continue;
+			}
+
+			if (fi_bucket (m->len) != b)
+				fi_update (m);
+
+			if (!best || m->len > best->len)
+				best = m;
+		}
+	}
+
+	return best;
+}
+
 
 /**
  * Initialize memory routines.
@@ -277,6 +495,7 @@ add_region (MMAP map, ulong place, ulong size, ushort mflags)
 		m->next = *map;
 		m->mflags = mflags;
 		*map = m;
+		fi_update (m);
 	}
 	else
 	{
@@ -560,7 +779,12 @@ unref_memreg(struct proc *p, MEMREGION *m)
 	if (!m->links)
 		free_region(m);
 	else
+	{
 		mark_proc_region(p->p_mem, m, PROT_I, p->pid);
+
+		if (m->mflags & M_MMAP)
+			mmap_unref(m);
+	}
 }
 /*
  * detach_region(proc, reg): remove region from the procedure's address
@@ -685,7 +909,7 @@ get_region (MMAP map, ulong size, short mode)
 MEMREGION *
 _get_region (MMAP map, ulong s, short mode, short cmode, MEMREGION *m, short kernel_flag)
 {
-	MEMREGION *n, *k = NULL;
+	MEMREGION *n;
 	unsigned long size = s;
 
 	size = ROUND(s);
@@ -728,67 +952,59 @@ _get_region (MMAP map, ulong s, short mode, short cmode, MEMREGION *m, short ker
 		size = ROUND (size);
 	}
 #endif
-	n = *map;
+	n = fi_lookup (map, size, kernel_flag);
+	if (!n)
+	{
+		/* the index is only a hint */
+		fi_build (map);
+		n = fi_lookup (map, size, kernel_flag);
+	}
+	if (!n) {
+		TRACELOW (("get_region: no memory left in this map"));
+		goto fail;
+	}
+
+	if (n->len == size) {
+		if (m) kmr_free(m);
+		goto win;
+	}
+
+	assert(n->len > size);
+
+	if (!m) {
+		DEBUG(("_get_region: no regions left"));
+		goto fail;
+	}
+
+	mint_bzero(m, sizeof(*m));
+	m->mflags = n->mflags & M_MAP;
+	m->next = n->next;
+	n->next = m;
+
 	if (kernel_flag) {
-		while (n) {
-			if (ISFREE(n) && n->len >= size)
-				k = n;
-			n = n->next;
-		}
-		if (k) {
-			if (k->len == size) {
-				kmr_free(m);
-				n = k;
-			} else {
-				assert(k->len > size);
-				mint_bzero(m, sizeof(*m));
-				m->mflags = k->mflags & M_MAP;
-				m->next = k->next;
-				k->next = m;
-
-				k->len = k->len - size;
-				m->len = size;
-				m->loc = k->loc + k->len;
-				n = m;
-			}
-			goto win;
-		} else {
-			TRACELOW (("get_region: no memory left in this map"));
-			goto fail;
-		}
+		/* slice off the top, the rest stays free */
+		n->len = n->len - size;
+		m->len = size;
+		m->loc = n->loc + n->len;
+
+		fi_update(n);
+		n = m;
 	} else {
-		while (n) {
-			if (ISFREE(n)) {
-				if (n->len == size) {
-					if (m) kmr_free(m);
-					goto win;
-				}
-				if (n->len > size) {
-					if (m) {
-						mint_bzero(m, sizeof(*m));
-						m->mflags = n->mflags & M_MAP;
-
-						m->next = n->next;
-						n->next = m;
-						m->loc = n->loc + size;
-						m->len = n->len - size;
-						n->len = size;
-						assert(n->loc + n->len == m->loc);
-						goto win;
-					} else {
-						DEBUG(("_get_region: no regions left"));
-						goto fail;
-					}
-				}
-			}
-			n = n->next;
-		}
+		m->loc = n->loc + size;
+		m->len = n->len - size;
+		n->len = size;
+		assert(n->loc + n->len == m->loc);
+
+		fi_update(m);
 	}
+	goto win;
+
 fail:
 	SANITY_CHECK (map);
 	return NULL;
 win:
 	n->links++;
+	fi_remove (n);
 
 	mark_region (n, mode & PROT_PROTMODE, cmode);
 	if (mode & M_KEEP)
@@ -889,6 +1105,7 @@ free_region (MEMREGION *reg)
 		if (shdw->next == reg)
 		{
 			shdw->next = reg->next;
+			fi_remove (reg);
 			kmr_free (reg);
 		}
 		else
@@ -938,6 +1155,7 @@ free_region (MEMREGION *reg)
 			*map = reg->next;
 
 			reg->next = NULL;
+			fi_remove (reg);
 			kmr_free (reg);
 
 			goto end;
@@ -960,6 +1178,7 @@ free_region (MEMREGION *reg)
 		m->next = reg->next;
 
 		reg->next = NULL;
+		fi_remove (reg);
 		kmr_free (reg);
 
 		if (ISFREE (m))
@@ -976,6 +1195,7 @@ free_region (MEMREGION *reg)
 		assert(m->next == reg);
 		m->next = reg->next;
 		reg->next = NULL;
+		fi_remove (reg);
 		kmr_free (reg);
 		reg = m;
 	}
@@ -988,9 +1208,12 @@ merge_after:
 		reg->len += m->len;
 		reg->next = m->next;
 		m->next = 0;
+		fi_remove (m);
 		kmr_free (m);
 	}
 
+	fi_update (reg);
+
 end:
 	SANITY_CHECK_MAPS ();
 }
@@ -1074,6 +1297,7 @@ shrink_region (MEMREGION *reg, unsigned long nsize)
 		 * (part of it is already invalid; that's OK)
 		 */
 		mark_region (n, PROT_I, 0);
+		fi_update (n);
 		DEBUG(("shrink_region: nloc %lx, nlen %ld", n->loc, n->len));
 	}
 	else
@@ -1095,6 +1319,7 @@ shrink_region (MEMREGION *reg, unsigned long nsize)
 
 		/* MEMPROT: invalidate the new, free region */
 		mark_region (n, PROT_I, 0);
+		fi_update (n);
 		DEBUG(("shrink_region: aint free 2"));
 	}
 
@@ -1110,6 +1335,10 @@ leave:
  * shared text regions, else count them all as free.
  * @return The length of the biggest free region in the given memory map,
  * or 0 if no regions remain.
+ *
+ * The core and alt map are answered from the free index, unless the
+ * exec cache holds memory: its M_CACHE regions take the place of the
+ * shared text regions, an allocation that needs them drops the cache.
  */
 long
 max_rsize (MMAP map, long needed)
@@ -1117,6 +1346,12 @@ max_rsize (MMAP map, long needed)
 	const MEMREGION *m;
 	long size = 0, lastsize = 0, end = 0;
 
+	if (fi_get (map) && !exec_cache_used ())
+	{
+		m = fi_largest (map);
+		return m ? m->len : 0;
+	}
+
 	if (needed)
 	{
 		for (m = *map; m; m = m->next)
@@ -1145,7 +1380,8 @@ max_rsize (MMAP map, long needed)
 	}
 	for (m = *map; m; m = m->next)
 	{
-		if (ISFREE(m) || (m->links == -2/*0xfffe*/ && !m->shadow) || (m->links == -1/*0xffff*/))
+		if (ISFREE(m) || (m->links == -2/*0xfffe*/ && !m->shadow) || (m->links == -1/*0xffff*/)
+			|| (m->mflags & M_CACHE))
 		{
 			if (end == m->loc)
 			{
@@ -1233,6 +1469,23 @@ freephysmem (void)
 	return size;
 }
 
+/*
+ * Give back memory the kernel only keeps as a cache; returns nonzero
+ * if anything was freed and a failed allocation is worth a retry.
+ * Nothing in here may allocate.
+ */
+int
+reclaim_memory (void)
+{
+	int n;
+
+	n = exec_cache_flush ();
+	n += mmap_flush ();
+
+	TRACE (("reclaim_memory: %i regions freed", n));
+	return n;
+}
+
 /**
  * Allocate a new region and attach it to the current process.
  * @param mode The memory protection mode to pass get_region(), and in turn to mark_region().
@@ -1254,6 +1507,8 @@ alloc_region (MMAP map, ulong size, short mode)
 	}
 
 	m = get_region(map, size, mode);
+	if (!m && reclaim_memory())
+		m = get_region(map, size, mode);
 	if (!m)
 	{
 		TRACELOW(("alloc_region: get_region failed"));
@@ -1329,6 +1584,8 @@ fork_region (MEMREGION *reg, long txtsize)
 	 */
 	*shdw = *reg;
 	shdw->links = 1;
+	shdw->fbucket = 0;
+	shdw->fnext = shdw->fprev = NULL;
 	reg->links--;
 	if (!shdw->shadow)
 		shdw->shadow = reg;
@@ -1560,7 +1817,7 @@ load_region (const char *filename, MEMREGION *env, const char *cmdlin, XATTR *xp
 	FILEPTR *f;
 	MEMREGION *reg;
 	BASEPAGE *b;
-	long size, start;
+	long size;
 	FILEHEAD fh;
 
 	*err = FP_ALLOC (get_curproc(), &f);
@@ -1608,6 +1865,8 @@ failed:
 
 	if (env) env->links++;
 	reg = create_base (cmdlin, env, fh.flag, size, err);
+	if (!reg && *err == ENOMEM && reclaim_memory ())
+		reg = create_base (cmdlin, env, fh.flag, size, err);
 	if (env) env->links--;
 
 	if (!reg)
@@ -1631,10 +1890,7 @@ failed:
 	b->p_bbase = b->p_dbase + b->p_dlen;
 	b->p_blen = fh.fbss;
 
-	size = fh.ftext + fh.fdata;
-	start = 0;
-
-	*err = load_and_reloc (f, &fh, (char *)b + 256, start, size, b);
+	*err = exec_cache_load (f, &fh, b);
 	if (*err)
 	{
 		detach_region (get_curproc(), reg);
@@ -2058,6 +2314,7 @@ realloc_region (MEMREGION *reg, long newsize)
 		{
 			if (newm) kmr_free (newm);
 			lastfit->links++;
+			fi_remove (lastfit);
 			mark_region (lastfit, PROT_G, 0);
 			return (long) lastfit;
 		}
@@ -2074,6 +2331,7 @@ realloc_region (MEMREGION *reg, long newsize)
 		newm->next = lastfit->next;
 		lastfit->next = newm;
 		mark_region (newm, PROT_G, 0);
+		fi_update (lastfit);
 
 		SANITY_CHECK (map);
 		return (long) newm;
@@ -2121,6 +2379,7 @@ realloc_region (MEMREGION *reg, long newsize)
 
 			mark_region (prevptr, PROT_I, 0);
 			mark_region (reg, PROT_G, 0);
+			fi_update (prevptr);
 
 			SANITY_CHECK (map);
 			return reg->loc;
@@ -2155,6 +2414,7 @@ realloc_region (MEMREGION *reg, long newsize)
 			*map = m;
 		m->next = reg;
 		mark_region (m, PROT_I, 0);
+		fi_update (m);
 		mark_region (reg, PROT_G, 0);
 		SANITY_CHECK (map);
 		return reg->loc;
@@ -2201,6 +2461,7 @@ realloc_region (MEMREGION *reg, long newsize)
 
 		reg->len += foo->len;
 		reg->next = foo->next;
+		fi_remove (foo);
 		kmr_free (foo);
 		mark_region (reg, PROT_G, 0);
 		if (reg->len >= newsize)
@@ -2233,8 +2494,11 @@ realloc_region (MEMREGION *reg, long newsize)
 					}
 				}
 			}
+			fi_remove (prevptr);
 			kmr_free (prevptr);
 		}
+		else
+			fi_update (prevptr);
 		mark_region (reg, PROT_G, 0);
 	}
 
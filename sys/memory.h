@@ -37,6 +37,7 @@ long	max_rsize (MMAP map, long needed);
 long	tot_rsize (MMAP map, short flag);
 long	totalphysmem (void);
 long	freephysmem (void);
+int	reclaim_memory (void);
 long 	alloc_region (MMAP map, ulong size, short mode);
 MEMREGION *fork_region (MEMREGION *reg, long txtsize);
 MEMREGION *create_env (const char *env, ulong flags);
@@ -45,11 +45,12 @@ typedef struct di	DI;
 typedef struct unit	UNIT;
 typedef struct cbl	CBL;
 typedef struct bio	BIO;
+typedef struct bio_req	BIO_REQ;
 
 
 struct crypt
 {
-	BF_KEY	*key;
+	CRYPT_KEY *key;		/* cipher and its key schedule */
 	long	_cdecl (*rwabs)(DI *di, ushort rw, void *buf, ulong size, ulong lrecno);
 };
 
@@ -93,7 +94,9 @@ struct di
 	/* revision 3 extension - xfs error callback */
 	long	_cdecl (*uniterror)(DI *di, long err);
 	
-	long	res [2];
+	/* revision 3 extension - asynchronous request queue */
+	BIO_REQ	*rq_queue;		/* internal: queued requests, sorted by sector */
+	long	rq_count;		/* internal: queued and active requests */
 	
 	ushort	pad;
 	ushort	links;			/* use counter */
@@ -130,6 +133,29 @@ struct unit
 	uchar	io_sleep;		/* process(es) sleep on this unit flag */
 };
 
+/* asynchronous request
+ * 
+ * filled in by the caller and handed to submit(); the structure
+ * must stay valid until it is completed
+ */
+struct bio_req
+{
+	BIO_REQ	*next;			/* internal: next in device queue */
+	DI	*di;			/* device identifikator */
+	ulong	sector;			/* logical start sector on device */
+	ulong	blocks;			/* number of blocks */
+	ulong	blocksize;		/* size of one block in bytes */
+	void	*buf;			/* data buffer */
+	ushort	rw;			/* 0 = read, 1 = write */
+	ushort	state;			/* internal: request state */
+# define BIO_REQ_QUEUED		1
+# define BIO_REQ_ACTIVE		2
+# define BIO_REQ_DONE		4
+	long	res;			/* result, valid after completion */
+	void	_cdecl (*done)(BIO_REQ *req);	/* completion callback or NULL */
+	void	*arg;			/* free for the caller */
+};
+
 
 /*
  * interface
@@ -141,7 +167,7 @@ struct bio
 	ushort	revision;		/* buffer cache revision */
 	
 # define BLOCK_IO_VERS	3		/* our existing version - incompatible interface change */
-# define BLOCK_IO_REV	2		/* actual revision - compatible interface change */
+# define BLOCK_IO_REV	3		/* actual revision - compatible interface change */
 	
 	long	_cdecl (*config)	(const ushort drv, const long config, const long mode);
 	
@@ -194,8 +220,21 @@ struct bio
 	 */
 	void	_cdecl (*remove)	(UNIT *u);
 	
+	/* revision 3 extension: asynchronous block I/O
+	 * 
+	 * submit queues the request and returns at once; adjacent
+	 * requests are merged and done is called from the block I/O
+	 * thread once the transfer is finished, it must not block
+	 * wait sleeps until the request is completed and returns the result;
+	 * don't use it on requests which are released by their callback
+	 * 
+	 * requests on the same device are ordered by sector, not by
+	 * submission; overlapping requests must wait for each other
+	 */
+	long	_cdecl (*submit)	(BIO_REQ *req);
+	long	_cdecl (*wait)		(BIO_REQ *req);
 	
-	long	res[3];			/* reserved for future */
+	long	res[1];			/* reserved for future */
 };
 
 
@@ -92,6 +92,7 @@ struct filesys
 # define FS_EXT_1		0x0200	/* extensions level 1 - mknod & unmount */
 # define FS_EXT_2		0x0400	/* extensions level 2 - additional place at the end */
 # define FS_EXT_3		0x0800	/* extensions level 3 - stat & native UTC timestamps */
+# define FS_EXT_4		0x1000	/* extensions level 4 - bulk readdirx */
 	
 	/* filesystem functions
 	 */
@@ -128,7 +129,16 @@ struct filesys
 	long	_cdecl (*unmount)	(int drv);
 	long	_cdecl (*stat64)	(fcookie *file, STAT *stat);
 	
-	long	res1, res2, res3;	/* reserved */
+	/* FS_EXT_4
+	 * 
+	 * fill buf with struct dirstat records, starting at the current
+	 * position of dirh; the position must only advance past entries
+	 * that were stored. Returns the number of bytes used, 0 at the end
+	 * of the directory and ERANGE if not even one entry fits.
+	 */
+	long	_cdecl (*readdirx)	(DIR *dirh, char *buf, long len);
+	
+	long	res2, res3;		/* reserved */
 	
 	/* experimental extension
 	 */
@@ -0,0 +1,39 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+# ifndef _mint_kprof_h
+# define _mint_kprof_h
+
+
+/* one sample of the 200 Hz timer as read from /kern/profile */
+struct kprof_sample
+{
+	unsigned long	pc;		/* interrupted program counter */
+	short		pid;		/* current process */
+	unsigned short	flags;
+# define KPROF_SUPER	0x0001		/* pc in supervisor mode */
+# define KPROF_KERNEL	0x0002		/* inside a system call */
+};
+
+# define KPROF_SAMPLES		8192	/* ring buffer size, ~40 seconds */
+
+
+# endif /* _mint_kprof_h */
@@ -101,6 +101,7 @@ typedef struct proc		PROC;
 /* forward declarations: misc
  */
 typedef struct bf_key		BF_KEY;
+typedef struct crypt_key	CRYPT_KEY;
 typedef struct bdevmap		BDEVMAP;
 typedef struct dma		DMA;
 typedef struct pollfd		POLLFD;
@@ -27,10 +27,12 @@ struct memregion
         unsigned long	len;		///< Length of memory region.
         long		links;		///< Number of users of region.
         unsigned short	mflags;		///< E.g. which map this came from.
-	short		reservd;
+	short		fbucket;	///< Free index bucket + 1, 0 if not indexed.
         MEMREGION *save;	///< Used to save inactive shadows.
         MEMREGION *shadow;	///< Ring of shadows or 0.
         MEMREGION *next;	///< Next region in memory map.
+        MEMREGION *fnext;	///< Next in free index bucket.
+        MEMREGION *fprev;	///< Previous in free index bucket.
 };
 
 # define M_CORE		0x0001	///< Region came from core map.
@@ -43,8 +45,8 @@ struct memregion
 # define M_FSAVED	0x0040	///< Region is saved memory of a forked process
 # define M_SHARED	0x0080	///< Region is shared memory region
 # define M_KEEP		0x0100	///< don't free region on process termination
-                     /* 0x0200  unused */
-                     /* 0x0400  unused */
+# define M_MMAP		0x0200	///< Region is a file mapping (Fmmap)
+# define M_CACHE	0x0400	///< Region only holds a kernel cache (see reclaim_memory)
                      /* 0x0800  unused */
 # define M_UMALLOC	0x1000	///< Region used by umalloc
 # define M_KMALLOC	0x4000	///< Region used by kmalloc
@@ -0,0 +1,41 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ * 
+ * 
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ */
+
+# ifndef _mint_mman_h
+# define _mint_mman_h
+
+
+/* Fmmap() protection */
+# define PROT_NONE	0x0
+# define PROT_READ	0x1		/* pages can be read */
+# define PROT_WRITE	0x2		/* pages can be written */
+# define PROT_EXEC	0x4		/* pages can be executed */
+
+/* Fmmap() flags */
+# define MAP_SHARED	0x01		/* share changes */
+# define MAP_PRIVATE	0x02		/* changes are private */
+# define MAP_TYPE	0x0f		/* mask for type of mapping */
+# define MAP_FIXED	0x10		/* interpret addr exactly */
+
+# define MAP_FAILED	((void *) -1)
+
+
+# endif /* _mint_mman_h */
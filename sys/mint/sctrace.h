@@ -0,0 +1,50 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+# ifndef _mint_sctrace_h
+# define _mint_sctrace_h
+
+
+/* call classes, kern.sctrace_mask */
+# define SCTRACE_GEMDOS		0x01
+# define SCTRACE_BIOS		0x02
+# define SCTRACE_XBIOS		0x04
+# define SCTRACE_ALL		0x07
+
+/* one system call as read from /kern/sctrace */
+struct sctrace_rec
+{
+	unsigned long	seq;		/* running number, gaps mean lost records */
+	unsigned long	enter;		/* 200 Hz timer at entry */
+	unsigned long	leave;		/* and at return */
+	long		ret;		/* return value */
+	short		pid;
+	unsigned char	trap;		/* 1, 13 or 14 */
+	unsigned char	done;		/* 0 while the call is still running */
+	unsigned short	nr;		/* function number */
+	unsigned short	res;
+	long		args[4];	/* first 16 bytes of the arguments */
+};
+
+# define SCTRACE_RECS		1024	/* ring buffer size */
+
+
+# endif /* _mint_sctrace_h */
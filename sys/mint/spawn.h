@@ -0,0 +1,59 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ * 
+ * 
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ */
+
+# ifndef _mint_spawn_h
+# define _mint_spawn_h
+
+
+/* Pspawn() file actions, applied to the child in order */
+struct spawn_action
+{
+	short		cmd;
+# define SPAWN_CLOSE	1		/* close fd */
+# define SPAWN_DUP2	2		/* duplicate fd to newfd */
+# define SPAWN_OPEN	3		/* open path with flags as fd */
+# define SPAWN_CHDIR	4		/* change directory to path */
+	short		fd;
+	short		newfd;
+	short		res;
+	long		flags;		/* SPAWN_OPEN: Fopen() mode */
+	const char	*path;
+};
+
+/* Pspawn() attributes */
+struct spawn_attr
+{
+	long		flags;
+# define SPAWN_SETPGROUP	0x01	/* set process group to pgroup */
+# define SPAWN_SETSIGMASK	0x02	/* set signal mask to sigmask */
+# define SPAWN_SETSIGDEF	0x04	/* default the signals in sigdefault */
+# define SPAWN_RESETIDS		0x08	/* effective ids = real ids */
+	short		pgroup;		/* 0: the child's pid */
+	short		nactions;
+	unsigned long	sigmask;
+	unsigned long	sigdefault;
+	const struct spawn_action *actions;
+};
+
+# define SPAWN_MAX_ACTIONS	64
+
+
+# endif /* _mint_spawn_h */
@@ -58,6 +58,19 @@ struct stat
 	long		res[7];		/* sizeof = 128 bytes */
 };
 
+/* record returned by Dreaddirx, one per directory entry */
+struct dirstat
+{
+	ushort		reclen;		/* size of this record */
+	ushort		namelen;	/* length of name, without the '\0' */
+	long		ret;		/* result of the stat for this entry */
+	struct stat	st;		/* attributes, not following links */
+	char		name[4];	/* '\0' terminated, padded to reclen */
+};
+
+/* record size for a name of length n, always a multiple of 4 */
+# define DIRSTAT_RECLEN(n)	((sizeof (struct dirstat) - 4 + (n) + 1 + 3) & ~3)
+
 
 /* file types */
 # define S_IFMT		0170000		/* file type mask */
@@ -124,7 +124,11 @@ struct ctlname
 # define KERN_BOOTTIME		13	/* struct: time kernel was booted */
 # define KERN_INITIALTPA	14	/* int: max TPA size of a process */
 # define KERN_SYSDIR		15	/* the system directory */
-# define KERN_MAXID		16	/* number of valid kern ids */
+# define KERN_SCTRACE		16	/* int: system call tracing on/off */
+# define KERN_SCTRACE_PID	17	/* int: trace only this pid, 0 = all */
+# define KERN_SCTRACE_MASK	18	/* int: call classes to trace */
+# define KERN_PROFILE		19	/* int: system wide profiling on/off */
+# define KERN_MAXID		20	/* number of valid kern ids */
 
 # define CTL_KERN_NAMES \
 { \
@@ -144,6 +148,10 @@ struct ctlname
 	{ "boottime", CTLTYPE_STRUCT }, \
 	{ "initialtpa", CTLTYPE_LONG }, \
 	{ "sysdir", CTLTYPE_STRING }, \
+	{ "sctrace", CTLTYPE_LONG }, \
+	{ "sctrace_pid", CTLTYPE_LONG }, \
+	{ "sctrace_mask", CTLTYPE_LONG }, \
+	{ "profile", CTLTYPE_LONG }, \
 }
 
 
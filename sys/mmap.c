@@ -0,0 +1,399 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *
+ * file mappings
+ *
+ * A mapping is a memory region that is loaded from the file at
+ * Fmmap() time. The MMU fault handlers can't restart a faulting
+ * instruction, so there is no lazy population; on the other hand
+ * this works the same with and without memory protection.
+ *
+ * Read-only mappings are kept in a small cache and shared by all
+ * processes mapping the same range of an unchanged file. An entry
+ * goes away with the last process that has the mapping, so the cache
+ * never pins memory on its own. With memory protection enabled the
+ * pages are write protected for everyone. Writable private mappings
+ * always get their own copy.
+ *
+ */
+
+# include "mmap.h"
+# include "global.h"
+
+# include "libkern/libkern.h"
+# include "mint/file.h"
+# include "mint/stat.h"
+
+# include "arch/mprot.h"
+
+# include "dosfile.h"
+# include "k_fds.h"
+# include "kmemory.h"
+# include "memory.h"
+# include "proc.h"
+# include "xfs_xdd.h"
+
+
+# define MMAP_CACHE	16		/* max. number of cached mappings */
+
+/* a cached read-only mapping */
+struct mfile
+{
+	struct mfile	*next;
+	MEMREGION	*reg;		/* the mapping, the cache holds one link */
+	llong		dev;		/* file identity */
+	ulong		ino;
+	long		offset;		/* mapped range */
+	long		len;
+	struct time	mtime;		/* file state at load time */
+	llong		size;
+};
+
+static struct mfile *mfiles = NULL;
+static long nmfiles = 0;
+
+
+static void
+mfile_release (struct mfile *mf)
+{
+	MEMREGION *reg = mf->reg;
+
+	TRACE (("mmap: release %lx len %lx (links %ld)", reg->loc, reg->len, reg->links));
+
+	reg->links--;
+	if (reg->links == 0)
+		free_region (reg);
+
+	kfree (mf);
+	nmfiles--;
+}
+
+/*
+ * drop the cached mappings no process uses anymore;
+ * returns the number of mappings dropped
+ */
+int
+mmap_flush (void)
+{
+	struct mfile **mfp = &mfiles;
+	int n = 0;
+
+	while (*mfp)
+	{
+		struct mfile *mf = *mfp;
+
+		if (mf->reg->links == 1)
+		{
+			*mfp = mf->next;
+			mfile_release (mf);
+			n++;
+		}
+		else
+			mfp = &(mf->next);
+	}
+
+	return n;
+}
+
+/*
+ * a link of the file mapping reg was dropped; if only the cache
+ * still holds it, release it
+ */
+void
+mmap_unref (MEMREGION *reg)
+{
+	struct mfile **mfp;
+
+	if (reg->links != 1 || !(reg->mflags & M_SHARED))
+		return;
+
+	for (mfp = &mfiles; *mfp; mfp = &((*mfp)->next))
+	{
+		struct mfile *mf = *mfp;
+
+		if (mf->reg == reg)
+		{
+			*mfp = mf->next;
+			mfile_release (mf);
+			return;
+		}
+	}
+}
+
+static struct mfile *
+mfile_lookup (const struct stat *st, long offset, long len)
+{
+	struct mfile **mfp = &mfiles;
+
+	while (*mfp)
+	{
+		struct mfile *mf = *mfp;
+
+		if (mf->ino == st->ino && mf->dev == st->dev
+			&& mf->offset == offset && mf->len == len)
+		{
+			if (mf->size == st->size
+				&& mf->mtime.time == st->mtime.time
+				&& mf->mtime.nanoseconds == st->mtime.nanoseconds)
+			{
+				/* move to front */
+				*mfp = mf->next;
+				mf->next = mfiles;
+				mfiles = mf;
+
+				return mf;
+			}
+
+			/* file changed, existing users keep their copy */
+			*mfp = mf->next;
+			mfile_release (mf);
+			continue;
+		}
+
+		mfp = &(mf->next);
+	}
+
+	return NULL;
+}
+
+static void
+mfile_insert (const struct stat *st, long offset, long len, MEMREGION *reg)
+{
+	struct mfile *mf;
+
+	if (nmfiles >= MMAP_CACHE)
+	{
+		struct mfile **mfp = &mfiles;
+		struct mfile **victim = NULL;
+
+		/* the last unused one */
+		while (*mfp)
+		{
+			if ((*mfp)->reg->links == 1)
+				victim = mfp;
+
+			mfp = &((*mfp)->next);
+		}
+
+		if (!victim)
+			return;
+
+		mf = *victim;
+		*victim = mf->next;
+		mfile_release (mf);
+	}
+
+	mf = kmalloc (sizeof (*mf));
+	if (!mf)
+		return;
+
+	mf->reg = reg;
+	mf->dev = st->dev;
+	mf->ino = st->ino;
+	mf->offset = offset;
+	mf->len = len;
+	mf->mtime = st->mtime;
+	mf->size = st->size;
+
+	mf->next = mfiles;
+	mfiles = mf;
+	nmfiles++;
+
+	reg->links++;
+}
+
+/*
+ * allocate a region and fill it with len bytes of the file at offset;
+ * the region is attached to p and returned with link count 1
+ */
+static MEMREGION *
+mmap_load (struct proc *p, FILEPTR *f, long offset, long len, long *err)
+{
+	MEMREGION *reg;
+	long pos, r;
+
+	reg = get_region (alt, len, PROT_P);
+	if (!reg)
+		reg = get_region (core, len, PROT_P);
+	if (!reg)
+	{
+		/* the cache may hold the memory */
+		mmap_flush ();
+
+		reg = get_region (alt, len, PROT_P);
+		if (!reg)
+			reg = get_region (core, len, PROT_P);
+		if (!reg)
+		{
+			*err = ENOMEM;
+			return NULL;
+		}
+	}
+
+	if (!attach_region (p, reg))
+	{
+		reg->links = 0;
+		free_region (reg);
+
+		*err = ENOMEM;
+		return NULL;
+	}
+
+	/* see _do_malloc */
+	reg->links--;
+	reg->mflags |= M_MMAP;
+
+	/* tail beyond the end of file and page rounding */
+	mint_bzero ((void *) reg->loc, reg->len);
+
+	pos = xdd_lseek (f, 0, SEEK_CUR);
+	r = xdd_lseek (f, offset, SEEK_SET);
+	if (r >= 0)
+		r = xdd_read (f, (char *) reg->loc, len);
+	if (pos >= 0)
+		xdd_lseek (f, pos, SEEK_SET);
+
+	if (r < 0)
+	{
+		DEBUG (("mmap_load: read failed (%li)", r));
+
+		detach_region (p, reg);
+
+		*err = r;
+		return NULL;
+	}
+
+	return reg;
+}
+
+/*
+ * Fmmap(addr, len, prot, flags, fd, offset)
+ *
+ * addr is only a hint and ignored, MAP_FIXED is not supported;
+ * shared mappings must be read-only
+ */
+long _cdecl
+sys_f_mmap (void *addr, long len, short prot, short flags, short fd, long offset)
+{
+	struct proc *p = get_curproc();
+	struct stat st;
+	MEMREGION *reg;
+	FILEPTR *f;
+	long r;
+
+	TRACE (("Fmmap(%p, %lx, %x, %x, %i, %lx)", addr, len, prot, flags, fd, offset));
+
+	if (len <= 0 || offset < 0 || (flags & MAP_FIXED))
+		return EINVAL;
+
+	if ((flags & MAP_TYPE) != MAP_SHARED && (flags & MAP_TYPE) != MAP_PRIVATE)
+		return EINVAL;
+
+	if ((prot & PROT_WRITE) && (flags & MAP_TYPE) == MAP_SHARED)
+	{
+		DEBUG (("Fmmap: writable shared mappings not supported"));
+		return ENODEV;
+	}
+
+	r = GETFILEPTR (&p, &fd, &f);
+	if (r) return r;
+
+	if ((f->flags & O_RWMODE) == O_WRONLY)
+		return EACCES;
+
+	r = sys_ffstat (fd, &st);
+	if (r) return r;
+
+	if (!S_ISREG (st.mode))
+		return ENODEV;
+
+	/* check for memory limits */
+	if (p->maxmem && len > p->maxmem - memused (p))
+	{
+		DEBUG (("Fmmap: mapping would violate memory limits"));
+		return ENOMEM;
+	}
+
+	if (prot & PROT_WRITE)
+	{
+		/* private copy */
+		reg = mmap_load (p, f, offset, len, &r);
+		if (!reg)
+			return r;
+
+		return reg->loc;
+	}
+
+	{
+		struct mfile *mf;
+
+		mf = mfile_lookup (&st, offset, len);
+		if (mf)
+		{
+			reg = mf->reg;
+
+			TRACE (("Fmmap: share %lx (links %ld)", reg->loc, reg->links));
+
+			if (!attach_region (p, reg))
+				return ENOMEM;
+		}
+		else
+		{
+			reg = mmap_load (p, f, offset, len, &r);
+			if (!reg)
+				return r;
+
+			/* fork must not copy it */
+			reg->mflags |= M_SHARED;
+
+			mfile_insert (&st, offset, len, reg);
+		}
+	}
+
+	/* write protect */
+	mark_proc_region (p->p_mem, reg, PROT_PR, p->pid);
+
+	return reg->loc;
+}
+
+/*
+ * Fmunmap(addr, len)
+ *
+ * only complete mappings can be removed, len must be the length
+ * they were mapped with; Mfree() works too
+ */
+long _cdecl
+sys_f_munmap (void *addr, long len)
+{
+	struct proc *p = get_curproc();
+	MEMREGION *reg;
+
+	TRACE (("Fmunmap(%p, %lx)", addr, len));
+
+	reg = proc_addr2region (p, (unsigned long) addr);
+	if (!reg || !(reg->mflags & M_MMAP) || reg->loc != (unsigned long) addr)
+		return EINVAL;
+
+	/* reg->len is rounded up the same way by get_region */
+	if (len <= 0 || ROUND (len) != reg->len)
+		return EINVAL;
+
+	return detach_region_by_addr (p, reg->loc);
+}
@@ -203,7 +203,7 @@ load_all_modules(unsigned long mask)
 	}
 }
 
-static struct kernel_module *loaded_modules = NULL;
+struct kernel_module *loaded_modules = NULL;
 
 static void
 free_km(struct kernel_module *km)
@@ -52,4 +52,6 @@ long _cdecl register_trap2(long _cdecl (*dispatch)(void *), int mode, int flag,
 
 extern DEVDRV module_device;
 
+extern struct kernel_module *loaded_modules;
+
 # endif /* _module_h */
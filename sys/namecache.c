@@ -0,0 +1,321 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ * 
+ * 
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ * 
+ * Generic pathname lookup cache for relpath2cookie().
+ * 
+ * Entries map (fs, dev, directory index, name) to the cookie the
+ * filesystem's lookup returned, or remember that the name doesn't
+ * exist. Both the directory and the result cookie are held with
+ * dup_cookie(), so the filesystem can't recycle an index while it is
+ * in the cache.
+ * 
+ * The xfs_* wrappers purge the affected entries before anything that
+ * changes a directory goes to the filesystem, and whole devices on
+ * media change and unmount. Changes made behind the kernel's back
+ * (networked and host filesystems) are covered by expiring entries
+ * after NC_TIMEOUT.
+ * 
+ * Filesystems that set FS_NO_C_CACHE, or do their own parsing, are
+ * never cached.
+ * 
+ */
+
+# include "namecache.h"
+
+# include "libkern/libkern.h"
+
+# include "arch/timer.h"
+
+# include "filesys.h"
+
+
+# define NC_SIZE	128		/* number of entries */
+# define NC_HASHSIZE	64		/* must be a power of two */
+# define NC_NAMLEN	32		/* longer names aren't cached */
+# define NC_TIMEOUT	(5 * 200)	/* entries expire after 5 seconds */
+
+struct ncentry
+{
+	struct ncentry	*hnext;		/* next in hash chain */
+	struct ncentry	*lnext;		/* LRU list, most recent first */
+	struct ncentry	*lprev;
+	fcookie		dir;		/* directory, dir.fs == NULL if unused */
+	fcookie		res;		/* result, res.fs == NULL if negative */
+	long		stamp;		/* time of entry (200 Hz ticks) */
+	ushort		hash;
+	char		name[NC_NAMLEN];
+};
+
+static struct ncentry nctab[NC_SIZE];
+static struct ncentry *nchash[NC_HASHSIZE];
+static struct ncentry *lru_first, *lru_last;
+
+/*
+ * Incremented on every purge; nc_enter() refuses results of lookups
+ * that raced with a directory change.
+ */
+ulong nc_generation = 0;
+
+
+INLINE int
+nc_cacheable (fcookie *dir, const char *name)
+{
+	FILESYS *fs = dir->fs;
+
+	if (!fs || (fs->fsflags & (FS_NO_C_CACHE | FS_KNOPARSE)))
+		return 0;
+
+	/* "." and ".." depend on mount points and chroot */
+	if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+		return 0;
+
+	return strlen (name) < NC_NAMLEN;
+}
+
+/*
+ * The hash is over the lower cased name, so case insensitive
+ * filesystems find their entries under any spelling.
+ */
+INLINE ushort
+nc_hash (fcookie *dir, const char *name)
+{
+	ulong h = (ulong) dir->fs ^ dir->dev ^ dir->index;
+
+	while (*name)
+		h = (h << 5) + h + tolower ((int)*name++ & 0xff);
+
+	h ^= h >> 16;
+	return (h ^ (h >> 8)) & (NC_HASHSIZE - 1);
+}
+
+INLINE int
+nc_match (struct ncentry *e, fcookie *dir, const char *name)
+{
+	if (e->dir.fs != dir->fs || e->dir.dev != dir->dev
+	    || e->dir.index != dir->index)
+		return 0;
+
+	if (dir->fs->fsflags & FS_CASESENSITIVE)
+		return strcmp (e->name, name) == 0;
+
+	return stricmp (e->name, name) == 0;
+}
+
+static void
+lru_unlink (struct ncentry *e)
+{
+	if (e->lprev)
+		e->lprev->lnext = e->lnext;
+	else
+		lru_first = e->lnext;
+
+	if (e->lnext)
+		e->lnext->lprev = e->lprev;
+	else
+		lru_last = e->lprev;
+}
+
+static void
+lru_link (struct ncentry *e)
+{
+	e->lprev = NULL;
+	e->lnext = lru_first;
+
+	if (lru_first)
+		lru_first->lprev = e;
+	else
+		lru_last = e;
+
+	lru_first = e;
+}
+
+/*
+ * Remove `e' from the cache and drop its cookies; it goes to the end of
+ * the LRU list to be reused first.
+ */
+static void
+nc_remove (struct ncentry *e)
+{
+	struct ncentry **prev;
+
+	for (prev = &nchash[e->hash]; *prev; prev = &(*prev)->hnext)
+	{
+		if (*prev == e)
+		{
+			*prev = e->hnext;
+			break;
+		}
+	}
+
+	release_cookie (&e->dir);
+	if (e->res.fs)
+		release_cookie (&e->res);
+
+	e->dir.fs = NULL;
+	e->res.fs = NULL;
+
+	lru_unlink (e);
+	e->lnext = NULL;
+	e->lprev = lru_last;
+	if (lru_last)
+		lru_last->lnext = e;
+	else
+		lru_first = e;
+	lru_last = e;
+}
+
+static void
+nc_initialize (void)
+{
+	int i;
+
+	for (i = 0; i < NC_SIZE; i++)
+		lru_link (&nctab[i]);
+}
+
+/*
+ * Look up `name' in `dir'. Returns E_OK and a duplicated cookie in
+ * `res' on a hit, ENOENT if the name is known not to exist and NC_MISS
+ * if the filesystem must be asked.
+ */
+long
+nc_lookup (fcookie *dir, const char *name, fcookie *res)
+{
+	struct ncentry *e;
+
+	if (!nc_cacheable (dir, name))
+		return NC_MISS;
+
+	for (e = nchash[nc_hash (dir, name)]; e; e = e->hnext)
+	{
+		if (!nc_match (e, dir, name))
+			continue;
+
+		if (jiffies - e->stamp > NC_TIMEOUT)
+		{
+			nc_remove (e);
+			return NC_MISS;
+		}
+
+		lru_unlink (e);
+		lru_link (e);
+
+		if (!e->res.fs)
+			return ENOENT;
+
+		dup_cookie (res, &e->res);
+		return E_OK;
+	}
+
+	return NC_MISS;
+}
+
+/*
+ * Remember the result of looking up `name' in `dir'; `res' is NULL if
+ * the lookup failed with ENOENT. `gen' is the nc_generation sampled
+ * before the lookup was started.
+ */
+void
+nc_enter (fcookie *dir, const char *name, fcookie *res, ulong gen)
+{
+	struct ncentry *e;
+	ushort hash;
+
+	if (gen != nc_generation || !nc_cacheable (dir, name))
+		return;
+
+	if (!lru_first)
+		nc_initialize ();
+
+	hash = nc_hash (dir, name);
+	for (e = nchash[hash]; e; e = e->hnext)
+	{
+		if (nc_match (e, dir, name))
+		{
+			nc_remove (e);
+			break;
+		}
+	}
+
+	/* reuse the least recently used entry */
+	e = lru_last;
+	if (e->dir.fs)
+		nc_remove (e);
+
+	dup_cookie (&e->dir, dir);
+	if (res)
+		dup_cookie (&e->res, res);
+	else
+		e->res.fs = NULL;
+
+	strcpy (e->name, name);
+	e->stamp = jiffies;
+	e->hash = hash;
+	e->hnext = nchash[hash];
+	nchash[hash] = e;
+
+	lru_unlink (e);
+	lru_link (e);
+}
+
+/*
+ * Forget `name' in `dir', called before the filesystem creates,
+ * removes or renames it.
+ */
+void
+nc_purge (fcookie *dir, const char *name)
+{
+	struct ncentry *e;
+
+	nc_generation++;
+
+	if (!nc_cacheable (dir, name))
+		return;
+
+	for (e = nchash[nc_hash (dir, name)]; e; e = e->hnext)
+	{
+		if (nc_match (e, dir, name))
+		{
+			nc_remove (e);
+			return;
+		}
+	}
+}
+
+/*
+ * Forget everything on device `dev', or everything that points into
+ * it (drive roots looked up on U:).
+ */
+void
+nc_purge_dev (ushort dev)
+{
+	int i;
+
+	nc_generation++;
+
+	for (i = 0; i < NC_SIZE; i++)
+	{
+		struct ncentry *e = &nctab[i];
+
+		if (e->dir.fs && (e->dir.dev == dev
+				  || (e->res.fs && e->res.dev == dev)))
+			nc_remove (e);
+	}
+}
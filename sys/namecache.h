@@ -0,0 +1,53 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ * 
+ * 
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ */
+
+# ifndef _namecache_h
+# define _namecache_h
+
+# include "mint/mint.h"
+# include "mint/file.h"
+
+
+/*
+ * exported definitions
+ */
+
+# define NC_MISS	1	/* nc_lookup(): name not in cache */
+
+
+/*
+ * exported data
+ */
+
+extern ulong nc_generation;
+
+
+/*
+ * exported functions
+ */
+
+long	nc_lookup	(fcookie *dir, const char *name, fcookie *res);
+void	nc_enter	(fcookie *dir, const char *name, fcookie *res, ulong gen);
+void	nc_purge	(fcookie *dir, const char *name);
+void	nc_purge_dev	(ushort dev);
+
+
+# endif /* _namecache_h */
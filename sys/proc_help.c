@@ -46,6 +46,7 @@
 # include "k_fds.h"
 # include "kmemory.h"
 # include "memory.h"
+# include "mmap.h"
 
 # include "proc.h"
 
@@ -315,6 +316,8 @@ free_mem (struct proc *p)
 			m->links--;
 			if (m->links == 0)
 				free_region (m);
+			else if (m->mflags & M_MMAP)
+				mmap_unref (m);
 		}
 	}
 	
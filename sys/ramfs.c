@@ -140,6 +140,10 @@
 
 # ifndef NO_RAMFS
 
+/* ramfsbench.c includes this file for the DIR part only,
+ * with host/kernel.h in place of the kernel headers
+ */
+# ifndef RAMFS_DIRBENCH
 # include "ramfs.h"
 # include "global.h"
 
@@ -159,6 +163,7 @@
 # include "memory.h"
 # include "proc.h"
 # include "time.h"
+# endif
 
 
 /*
@@ -265,6 +270,8 @@ ram_kfree (void *dst, register long size, const char *func)
 /****************************************************************************/
 /* BEGIN definition part */
 
+# ifndef RAMFS_DIRBENCH
+
 /*
  * filesystem
  */
@@ -289,6 +296,7 @@ static long	_cdecl ram_rename	(fcookie *olddir, char *oldname, fcookie *newdir,
 
 static long	_cdecl ram_opendir	(DIR *dirh, int flags);
 static long	_cdecl ram_readdir	(DIR *dirh, char *nm, int nmlen, fcookie *);
+static long	_cdecl ram_readdirx	(DIR *dirh, char *buf, long len);
 static long	_cdecl ram_rewinddir	(DIR *dirh);
 static long	_cdecl ram_closedir	(DIR *dirh);
 
@@ -325,15 +333,16 @@ FILESYS ramfs_filesys =
 	 * FS_EXT_1		extensions level 1 - mknod & unmount
 	 * FS_EXT_2		extensions level 2 - additional place at the end
 	 * FS_EXT_3		extensions level 3 - stat & native UTC timestamps
+	 * FS_EXT_4		extensions level 4 - bulk readdirx
 	 */
 	FS_CASESENSITIVE	|
 	FS_LONGPATH		|
-	FS_NO_C_CACHE		|
 	FS_OWN_MEDIACHANGE	|
 	FS_REENTRANT_L1		|
 	FS_REENTRANT_L2		|
 	FS_EXT_2		|
-	FS_EXT_3		,
+	FS_EXT_3		|
+	FS_EXT_4		,
 
 	root:			ram_root,
 	lookup:			ram_lookup,
@@ -374,7 +383,9 @@ FILESYS ramfs_filesys =
 
 	/* FS_EXT_3 */
 	stat64:			ram_stat64,
-	res1:			0,
+
+	/* FS_EXT_4 */
+	readdirx:		ram_readdirx,
 	res2:			0,
 	res3:			0,
 
@@ -409,6 +420,8 @@ static DEVDRV devtab =
 	readb:			NULL
 };
 
+# endif
+
 
 typedef struct blocks BLOCKS;
 typedef struct symlnk SYMLNK;
@@ -436,6 +449,7 @@ struct dirlst
 {
 	DIRLST	*prev;
 	DIRLST	*next;
+	DIRLST	*hnext;		/* next in hash chain */
 
 	ushort	lock;		/* a reference left */
 	ushort	len;		/* sizeof name */
@@ -450,8 +464,19 @@ struct diroot
 {
 	DIRLST	*start;
 	DIRLST	*end;
+	DIRLST	**hash;		/* name index, NULL for small directories */
+	ushort	count;		/* number of entries */
+	ushort	hmask;		/* size of the name index - 1 */
 };
 
+/* directories get a name index from this number of entries on;
+ * it is doubled whenever the chains get longer than 2 on average
+ */
+# ifndef DIR_HASHMIN
+# define DIR_HASHMIN	16
+# endif
+# define DIR_HASHMAX	4096
+
 
 struct cookie
 {
@@ -523,9 +548,12 @@ INLINE long	__dir_empty	(COOKIE *root);
 INLINE DIRLST *	__dir_next	(COOKIE *root, DIRLST *actual);
 static DIRLST *	__dir_search	(COOKIE *root, const char *name);
 INLINE DIRLST *	__dir_searchI	(COOKIE *root, register const COOKIE *searched);
+INLINE ulong	__dir_hashval	(const char *name);
+static long	__dir_rehash	(COOKIE *root, long size);
 static long	__dir_remove	(COOKIE *root, DIRLST *f);
 static long	__dir_insert	(COOKIE *root, COOKIE *cookie, const char *name);
 
+# ifndef RAMFS_DIRBENCH
 
 static void	__free_data	(COOKIE *rc);
 
@@ -536,6 +564,7 @@ static long	__unlink	(COOKIE *d, const char *name);
 
 static long	__FUTIME	(COOKIE *rc, ulong *timeptr);
 static long	__FTRUNCATE	(COOKIE *rc, long size);
+# endif
 
 /* END definition part */
 /****************************************************************************/
@@ -543,11 +572,13 @@ static long	__FTRUNCATE	(COOKIE *rc, long size);
 /****************************************************************************/
 /* BEGIN global data definition & access implementation */
 
+# ifndef RAMFS_DIRBENCH
 static SUPER super_struct;
 static SUPER *super = &super_struct;
 
 static COOKIE root_inode;
 static COOKIE *Root = &root_inode;
+# endif
 
 # define CURRENT_TIME	xtime.tv_sec
 
@@ -592,6 +623,21 @@ __dir_search (COOKIE *dir, const char *name)
 
 	RAM_DEBUG (("ramfs: __dir_search: search: %s!", name));
 
+	if (dir->data.dir.hash)
+	{
+		tmp = dir->data.dir.hash [__dir_hashval (name) & dir->data.dir.hmask];
+
+		while (tmp)
+		{
+			if (stricmp (tmp->name, name) == 0)
+				return tmp;
+
+			tmp = tmp->hnext;
+		}
+
+		return NULL;
+	}
+
 	while (tmp)
 	{
 		RAM_DEBUG (("ramfs: __dir_search: compare with: %s!", tmp->name));
@@ -625,6 +671,60 @@ __dir_searchI (COOKIE *dir, register const COOKIE *searched)
 	return NULL;
 }
 
+/* case insensitive, like the stricmp in __dir_search */
+INLINE ulong
+__dir_hashval (const char *name)
+{
+	register ulong h = 0;
+	register char c;
+
+	while ((c = *name++) != '\0')
+	{
+		if (isupper (c))
+			c = _tolower (c);
+
+		h = h * 31 + (uchar) c;
+	}
+
+	return h;
+}
+
+/*
+ * (re)build the name index with size chains, size 0 drops it;
+ * without memory the old index (if any) stays as it is
+ */
+static long
+__dir_rehash (COOKIE *dir, long size)
+{
+	DIRLST **hash = NULL;
+	DIRLST *l;
+
+	if (size)
+	{
+		hash = kmalloc (size * sizeof (*hash));
+		if (!hash)
+			return ENOMEM;
+
+		mint_bzero (hash, size * sizeof (*hash));
+
+		for (l = dir->data.dir.start; l; l = l->next)
+		{
+			DIRLST **chain = &hash [__dir_hashval (l->name) & (size - 1)];
+
+			l->hnext = *chain;
+			*chain = l;
+		}
+	}
+
+	if (dir->data.dir.hash)
+		kfree (dir->data.dir.hash, (dir->data.dir.hmask + 1L) * sizeof (*hash));
+
+	dir->data.dir.hash = hash;
+	dir->data.dir.hmask = size ? size - 1 : 0;
+
+	return E_OK;
+}
+
 static long
 __dir_remove (COOKIE *dir, DIRLST *element)
 {
@@ -635,6 +735,16 @@ __dir_remove (COOKIE *dir, DIRLST *element)
 			return EACCES;
 		}
 
+		if (dir->data.dir.hash)
+		{
+			DIRLST **chain = &dir->data.dir.hash [__dir_hashval (element->name) & dir->data.dir.hmask];
+
+			while (*chain != element)
+				chain = &((*chain)->hnext);
+
+			*chain = element->hnext;
+		}
+
 		if (element->prev)
 		{
 			element->prev->next = element->next;
@@ -661,6 +771,10 @@ __dir_remove (COOKIE *dir, DIRLST *element)
 
 		dir->stat.size -= sizeof (*element);
 		kfree (element, sizeof (*element));
+
+		dir->data.dir.count--;
+		if (dir->data.dir.hash && dir->data.dir.count < DIR_HASHMIN / 2)
+			(void) __dir_rehash (dir, 0);
 	}
 
 	return E_OK;
@@ -707,6 +821,23 @@ __dir_insert (COOKIE *dir, COOKIE *cookie, const char *name)
 			new->next = NULL;
 			dir->data.dir.end = new;
 
+			dir->data.dir.count++;
+			if (dir->data.dir.hash)
+			{
+				long size = dir->data.dir.hmask + 1L;
+
+				if (dir->data.dir.count <= 2 * size || size >= DIR_HASHMAX
+					|| __dir_rehash (dir, 2 * size))
+				{
+					DIRLST **chain = &dir->data.dir.hash [__dir_hashval (name) & dir->data.dir.hmask];
+
+					new->hnext = *chain;
+					*chain = new;
+				}
+			}
+			else if (dir->data.dir.count >= DIR_HASHMIN)
+				(void) __dir_rehash (dir, DIR_HASHMIN * 2);
+
 			r = E_OK;
 		}
 		else
@@ -721,6 +852,8 @@ __dir_insert (COOKIE *dir, COOKIE *cookie, const char *name)
 /* END DIR part */
 /****************************************************************************/
 
+# ifndef RAMFS_DIRBENCH
+
 /****************************************************************************/
 /* BEGIN misc part */
 
@@ -1521,6 +1654,53 @@ ram_readdir (DIR *dirh, char *nm, int nmlen, fcookie *fc)
 	return r;
 }
 
+/*
+ * bulk variant of ram_readdir; the stat data is right in the COOKIE,
+ * so a whole buffer of entries is produced without taking a cookie
+ * reference per entry
+ */
+static long _cdecl
+ram_readdirx (DIR *dirh, char *buf, long len)
+{
+	union { char *c; DIRLST **d;} ptr;
+	DIRLST *l;
+	fcookie fc;
+	long used = 0;
+
+	ptr.c = dirh->fsstuff;
+
+	l = *ptr.d;
+	while (l)
+	{
+		struct dirstat *d = (struct dirstat *) (buf + used);
+		long reclen = DIRSTAT_RECLEN (l->len - 1);
+
+		if (reclen > len - used)
+			break;
+
+		d->reclen = reclen;
+		d->namelen = l->len - 1;
+		fc.index = (long) l->cookie;
+		d->ret = ram_stat64 (&fc, &d->st);
+		strcpy (d->name, l->name);
+
+		used += reclen;
+
+		l->lock = 0;
+		l = __dir_next ((COOKIE *) dirh->fc.index, l);
+		if (l) l->lock = 1;
+	}
+
+	*ptr.d = l;
+
+	/* not even the first entry fit */
+	if (l && !used)
+		return ERANGE;
+
+	RAM_DEBUG (("ramfs: ram_readdirx: leave %li bytes", used));
+	return used;
+}
+
 static long _cdecl
 ram_rewinddir (DIR *dirh)
 {
@@ -2702,4 +2882,6 @@ ram_close (FILEPTR *f, int pid)
 /* END device driver */
 /****************************************************************************/
 
+# endif /* RAMFS_DIRBENCH */
+
 # endif
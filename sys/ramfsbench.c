@@ -0,0 +1,118 @@
+/*
+ *	ramfs directory benchmark, built for the build host with
+ *	"make ramfsbench".
+ *
+ *	Runs the DIR part of ramfs.c on one directory with NAMES
+ *	entries: creating them (a search followed by an insert, like
+ *	ram_creat), looking them up in different case, looking up
+ *	names that don't exist and removing them again. Each is done
+ *	with and without the hashed name index.
+ */
+
+# define RAMFS_DIRBENCH
+# define DIR_HASHMIN	hashmin
+
+# include "host/kernel.h"
+
+static long hashmin;
+
+# include "ramfs.c"
+
+
+# define NAMES		10000L
+
+/* never reached, a directory holds at most 65535 entries */
+# define NO_INDEX	65535L
+
+
+static double
+ms (clock_t start)
+{
+	return (double)(clock () - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static int
+run (const char *what)
+{
+	COOKIE dir;
+	char name[16];
+	clock_t start;
+	double create, lookup, miss, remove;
+	long i;
+
+	memset (&dir, 0, sizeof (dir));
+
+	start = clock ();
+	for (i = 0; i < NAMES; i++)
+	{
+		sprintf (name, "file%05ld", i);
+		if (__dir_search (&dir, name) || __dir_insert (&dir, NULL, name))
+		{
+			printf ("%s: create %s failed\n", what, name);
+			return -1;
+		}
+	}
+	create = ms (start);
+
+	start = clock ();
+	for (i = 0; i < NAMES; i++)
+	{
+		sprintf (name, "FILE%05ld", i);
+		if (!__dir_search (&dir, name))
+		{
+			printf ("%s: %s not found\n", what, name);
+			return -1;
+		}
+	}
+	lookup = ms (start);
+
+	start = clock ();
+	for (i = 0; i < NAMES; i++)
+	{
+		sprintf (name, "none%05ld", i);
+		if (__dir_search (&dir, name))
+		{
+			printf ("%s: %s found\n", what, name);
+			return -1;
+		}
+	}
+	miss = ms (start);
+
+	start = clock ();
+	for (i = 0; i < NAMES; i++)
+	{
+		sprintf (name, "file%05ld", i);
+		if (__dir_remove (&dir, __dir_search (&dir, name)))
+		{
+			printf ("%s: remove %s failed\n", what, name);
+			return -1;
+		}
+	}
+	remove = ms (start);
+
+	if (dir.data.dir.start || dir.data.dir.hash || dir.stat.size || memory)
+	{
+		printf ("%s: directory not empty after removing all\n", what);
+		return -1;
+	}
+
+	printf ("%-12s %10.1f %10.1f %10.1f %10.1f\n", what, create, lookup, miss, remove);
+	return 0;
+}
+
+int
+main (void)
+{
+	printf ("%ld names, times in ms\n", NAMES);
+	printf ("%-12s %10s %10s %10s %10s\n", "", "create", "lookup", "miss", "remove");
+
+	hashmin = NO_INDEX;
+	if (run ("linear"))
+		return 1;
+
+	hashmin = 16;	/* the default DIR_HASHMIN */
+	if (run ("hashed"))
+		return 1;
+
+	return 0;
+}
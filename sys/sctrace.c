@@ -0,0 +1,202 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *
+ * system call tracing
+ *
+ * When enabled (sysctl kern.sctrace) the dispatcher in syscall.S
+ * records every GEMDOS, BIOS and XBIOS call into a ring buffer that
+ * can be read from /kern/sctrace at any time; unlike ptrace nobody
+ * is stopped. The ring keeps the last SCTRACE_RECS calls, older
+ * ones are overwritten.
+ *
+ * The kernel isn't preemptive, so reserving a slot needs no lock.
+ * A call that sleeps may find its slot reused by the time it
+ * returns; the sequence number handed to the dispatcher detects that
+ * (and protects against registers not surviving an unwound stack).
+ *
+ */
+
+# include "sctrace.h"
+# include "global.h"
+
+# include "libkern/libkern.h"
+
+# include "arch/timer.h"
+
+# include "kmemory.h"
+# include "proc.h"
+# include "syscall_vectors.h"
+
+
+short sctrace_on = 0;
+long sctrace_pid = 0;			/* 0 = all processes */
+long sctrace_mask = SCTRACE_ALL;
+
+static struct sctrace_rec *ring = NULL;
+static ulong seq = 0;
+
+
+/*
+ * kern.sctrace: nonzero starts a new trace, 0 stops it;
+ * the records stay readable until the next start
+ */
+long
+sctrace_enable (long on)
+{
+	if (!on)
+	{
+		sctrace_on = 0;
+		return E_OK;
+	}
+
+	if (!ring)
+	{
+		ring = kmalloc (SCTRACE_RECS * sizeof (*ring));
+		if (!ring)
+			return ENOMEM;
+	}
+
+	mint_bzero (ring, SCTRACE_RECS * sizeof (*ring));
+	seq = 0;
+
+	sctrace_on = 1;
+	return E_OK;
+}
+
+/*
+ * called from the dispatcher before the call;
+ * returns the number of the record or 0 if not traced
+ */
+ulong _cdecl
+sctrace_enter (Func *tab, long nr, const long *args)
+{
+	struct proc *p = get_curproc();
+	struct sctrace_rec *r;
+	uchar trap;
+	long class;
+
+	if (!ring)
+		return 0;
+
+	if (tab == dos_tab)
+	{
+		trap = 1;
+		class = SCTRACE_GEMDOS;
+	}
+	else if (tab == bios_tab)
+	{
+		trap = 13;
+		class = SCTRACE_BIOS;
+	}
+	else
+	{
+		trap = 14;
+		class = SCTRACE_XBIOS;
+	}
+
+	if (!(sctrace_mask & class))
+		return 0;
+
+	if (sctrace_pid && sctrace_pid != p->pid)
+		return 0;
+
+	/* 0 means untraced */
+	if (++seq == 0)
+		seq = 1;
+
+	r = &ring[seq % SCTRACE_RECS];
+
+	r->seq = seq;
+	r->enter = jiffies;
+	r->leave = 0;
+	r->ret = 0;
+	r->pid = p->pid;
+	r->trap = trap;
+	r->done = 0;
+	r->nr = nr;
+	r->args[0] = args[0];
+	r->args[1] = args[1];
+	r->args[2] = args[2];
+	r->args[3] = args[3];
+
+	return seq;
+}
+
+/*
+ * called from the dispatcher with the return value
+ */
+void _cdecl
+sctrace_leave (ulong s, long ret)
+{
+	struct sctrace_rec *r;
+
+	if (!ring)
+		return;
+
+	r = &ring[s % SCTRACE_RECS];
+
+	/* slot reused in the meantime */
+	if (r->seq != s || r->done)
+		return;
+
+	r->leave = jiffies;
+	r->ret = ret;
+	r->done = 1;
+}
+
+# if WITH_KERNFS
+/*
+ * the ring buffer in binary form, oldest record first
+ */
+long
+kern_get_sctrace (SIZEBUF **buffer, const struct proc *p)
+{
+	SIZEBUF *info;
+	struct sctrace_rec *out;
+	ulong first, last, s;
+
+	UNUSED (p);
+
+	last = seq;
+	first = (last > SCTRACE_RECS) ? last - SCTRACE_RECS + 1 : 1;
+
+	info = kmalloc (sizeof (*info) + SCTRACE_RECS * sizeof (*out));
+	if (!info)
+		return ENOMEM;
+
+	out = (struct sctrace_rec *) info->buf;
+
+	if (ring)
+	{
+		for (s = first; s <= last && s != 0; s++)
+		{
+			struct sctrace_rec *r = &ring[s % SCTRACE_RECS];
+
+			if (r->seq == s)
+				*out++ = *r;
+		}
+	}
+
+	info->len = (char *) out - info->buf;
+	*buffer = info;
+
+	return 0;
+}
+# endif
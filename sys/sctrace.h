@@ -0,0 +1,43 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+# ifndef _sctrace_h
+# define _sctrace_h
+
+# include "mint/mint.h"
+# include "mint/sctrace.h"
+
+
+extern short sctrace_on;	/* tested in syscall.S */
+extern long sctrace_pid;
+extern long sctrace_mask;
+
+long	sctrace_enable		(long on);
+
+ulong	_cdecl sctrace_enter	(Func *tab, long nr, const long *args);
+void	_cdecl sctrace_leave	(ulong seq, long ret);
+
+# if WITH_KERNFS
+long	kern_get_sctrace	(SIZEBUF **buffer, const struct proc *p);
+# endif
+
+
+# endif /* _sctrace_h */
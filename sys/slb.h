@@ -43,6 +43,8 @@
 # include "mint/mint.h"
 # include "mint/slb.h"
 
+extern SHARED_LIB *slb_list;
+
 long _cdecl sys_s_lbopen (char *name, char *path, long min_ver, SHARED_LIB **sl, SLB_EXEC *fn);
 long _cdecl sys_s_lbclose (SHARED_LIB *sl);
 int slb_close_on_exit (int term, int code);
@@ -17,13 +17,25 @@ static void	arp_timeout (long);
 
 /*
  * Hash tables for ARP and RARP.
+ *
+ * The ARP table is consulted for every outgoing packet, so it starts
+ * out with ARP_HASHSIZE buckets and is doubled whenever there are
+ * more than two entries per bucket on average.
  */
-struct arp_entry *arptab[ARP_HASHSIZE];
-struct arp_entry *rarptab[ARP_HASHSIZE];
+static struct arp_entry *arptab_initial[ARP_HASHSIZE];
+struct arp_entry **arptab = arptab_initial;
+ushort arp_hashsize = ARP_HASHSIZE;
+static ushort arp_entries;
+
+static struct arp_entry *rarptab[RARP_HASHSIZE];
 
 
+/*
+ * `size' must be a power of two. The significant bits of IP addresses
+ * on a LAN are in the low bytes, fold the upper ones into them.
+ */
 static short
-arp_hash (uchar *addr, short len)
+arp_hash (uchar *addr, short len, ushort size)
 {
 	ulong v;
 	
@@ -31,7 +43,52 @@ arp_hash (uchar *addr, short len)
 	if (len < 4)
 		v >>= (32 - (len << 3));
 	
-	return v % ARP_HASHSIZE;
+	v ^= v >> 16;
+	v ^= v >> 8;
+	
+	return v & (size - 1);
+}
+
+/*
+ * Double the size of the ARP hash table. If we are out of memory we
+ * just stay with the longer chains.
+ */
+static void
+arp_grow (void)
+{
+	struct arp_entry **ntab, *are, *next;
+	ushort nsize = arp_hashsize * 2;
+	short i, idx;
+	
+	if (nsize > ARP_MAXHASHSIZE)
+		return;
+	
+	ntab = kmalloc (nsize * sizeof (*ntab));
+	if (!ntab)
+	{
+		DEBUG (("arp_grow: out of memory"));
+		return;
+	}
+	mint_bzero (ntab, nsize * sizeof (*ntab));
+	
+	for (i = 0; i < arp_hashsize; i++)
+	{
+		for (are = arptab[i]; are; are = next)
+		{
+			next = are->prnext;
+			idx = arp_hash (are->praddr.adr.bytes, are->praddr.len, nsize);
+			are->prnext = ntab[idx];
+			ntab[idx] = are;
+		}
+	}
+	
+	if (arptab != arptab_initial)
+		kfree (arptab);
+	
+	arptab = ntab;
+	arp_hashsize = nsize;
+	
+	DEBUG (("arp_grow: %d entries, %d buckets", arp_entries, nsize));
 }
 
 /*
@@ -47,13 +104,14 @@ arp_remove (struct arp_entry *are)
 	if (!(are->flags & ATF_PRCOM))
 		return;
 	
-	idx = arp_hash (are->praddr.adr.bytes, are->praddr.len);
+	idx = arp_hash (are->praddr.adr.bytes, are->praddr.len, arp_hashsize);
 	prev = &arptab[idx];
 	for (curr = *prev; curr; prev = &curr->prnext, curr = *prev)
 	{
 		if (curr == are)
 		{
 			*prev = curr->prnext;
+			arp_entries--;
 			arp_deref (are);
 			break;
 		}
@@ -69,7 +127,7 @@ rarp_remove (struct arp_entry *are)
 	if (!(are->flags & ATF_HWCOM))
 		return;
 	
-	idx = arp_hash (are->hwaddr.adr.bytes, are->hwaddr.len);
+	idx = arp_hash (are->hwaddr.adr.bytes, are->hwaddr.len, RARP_HASHSIZE);
 	prev = &rarptab[idx];
 	for (curr = *prev; curr; prev = &curr->hwnext, curr = *prev)
 	{
@@ -85,26 +143,13 @@ rarp_remove (struct arp_entry *are)
 /*
  * Insert an entry into internal hash table.
  */
-# ifdef notused
-static void
-arp_put (struct arp_entry *are)
-{
-	short idx;
-	
-	are->links++;
-	idx = arp_hash(are->praddr.addr, are->praddr.len);
-	are->prnext = arptab[idx];
-	arptab[idx] = are;
-}
-# endif
-
 static void
 rarp_put (struct arp_entry *are)
 {
 	short idx;
 	
 	are->links++;
-	idx = arp_hash (are->hwaddr.adr.bytes, are->hwaddr.len);
+	idx = arp_hash (are->hwaddr.adr.bytes, are->hwaddr.len, RARP_HASHSIZE);
 	are->hwnext = rarptab[idx];
 	rarptab[idx] = are;
 }
@@ -118,11 +163,11 @@ arp_flush (struct netif *nif)
 	struct arp_entry **prev, *curr, *next;
 	short i;
 	
-	for (i = 0; i < ARP_HASHSIZE; i++)
+	/*
+	 * delete from arptab
+	 */
+	for (i = 0; i < arp_hashsize; i++)
 	{
-		/*
-		 * delete from arptab
-		 */
 		prev = &arptab[i];
 		for (curr = *prev; curr; curr = next)
 		{
@@ -130,15 +175,19 @@ arp_flush (struct netif *nif)
 			if (curr->nif == nif)
 			{
 				*prev = next;
+				arp_entries--;
 				arp_deref (curr);
 			}
 			else
 				prev = &curr->prnext;
 		}
-		
-		/*
-		 * delete from rarptab
-		 */
+	}
+	
+	/*
+	 * delete from rarptab
+	 */
+	for (i = 0; i < RARP_HASHSIZE; i++)
+	{
 		prev = &rarptab[i];
 		for (curr = *prev; curr; curr = next)
 		{
@@ -163,7 +212,7 @@ arp_alloc (void)
 	if (are)
 	{
 		mint_bzero (are, sizeof (*are));
-		are->outq.maxqlen = IF_MAXQ;
+		are->outq.maxqlen = ARP_MAXQ;
 	} else
 	{
 		DEBUG (("arp_alloc: out of memory"));
@@ -221,25 +270,16 @@ arp_dosend (struct netif *nif, BUF *buf, short pktype)
 }
 
 /*
- * Send an ARP request to resolve the entry 'are'
+ * Broadcast an ARP request for the entry 'are'
  */
 static void
-arp_sendreq (struct arp_entry *are)
+arp_request (struct arp_entry *are)
 {
 	struct arp_dgram *arphdr;
 	long hwlen, prlen, size;
 	char *myaddr;
 	BUF *arpbuf;
 	
-	if (++are->retries > ARP_RETRIES)
-	{
-		short flags = are->flags;
-		DEBUG (("arp_send: timeout after %d retries", are->retries-1));
-		arp_remove (are);
-		if (flags & ATF_HWCOM)
-			rarp_remove (are);
-		return;
-	}
 	myaddr = arp_myaddr (are->nif, are->prtype);
 	if (!myaddr)
 		return;
@@ -268,9 +308,52 @@ arp_sendreq (struct arp_entry *are)
 	memcpy (ARP_DPR(arphdr), are->praddr.adr.bytes, prlen);
 	memcpy (ARP_DHW(arphdr), are->nif->hwbrcst.adr.bytes, hwlen);
 	
+	are->reqtime = GETTIME ();
+	arp_dosend (are->nif, arpbuf, PKTYPE_ARP);
+}
+
+/*
+ * Send an ARP request to resolve the entry 'are' and arrange for
+ * retransmission.
+ */
+static void
+arp_sendreq (struct arp_entry *are)
+{
 	event_del (&are->tmout);
+	
+	if (++are->retries > ARP_RETRIES)
+	{
+		DEBUG (("arp_send: timeout after %d retries", are->retries-1));
+		
+		/*
+		 * Keep the entry around for a while as a negative
+		 * entry, so packets for this address are dropped
+		 * right away instead of triggering new requests.
+		 */
+		are->state = ARS_FAILED;
+		are->retries = 0;
+		are->nif->out_errors += are->outq.qlen;
+		if_flushq (&are->outq);
+		event_add (&are->tmout, ARP_NEGATIVE, arp_timeout, (long)are);
+		return;
+	}
+	
 	event_add (&are->tmout, ARP_RETRANS, arp_timeout, (long)are);
-	arp_dosend (are->nif, arpbuf, PKTYPE_ARP);
+	arp_request (are);
+}
+
+/*
+ * Mark a resolved entry as confirmed.
+ */
+static void
+arp_reachable (struct arp_entry *are)
+{
+	are->state = ARS_REACHABLE;
+	are->retries = 0;
+	
+	event_del (&are->tmout);
+	if (!(are->flags & ATF_PERM))
+		event_add (&are->tmout, ARP_REACHABLE, arp_timeout, (long)are);
 }
 
 void
@@ -278,28 +361,81 @@ arp_timeout (long arg)
 {
 	struct arp_entry *are = (struct arp_entry *) arg;
 	
-	if (ATF_ISCOM (are))
+	/*
+	 * Double check whether this was a static entry.
+	 * (The check should never fail).
+	 */
+	if (are->flags & ATF_PERM)
+		return;
+	
+	switch (are->state)
 	{
-		/*
-		 * This is an resolved entry which has timed out.
-		 * Delete it.
-		 * Double check whether this was a static entry.
-		 * (The check should never fail).
-		 */
-		if (!(are->flags & ATF_PERM))
-		{
+		case ARS_INCOMPLETE:
+			/*
+			 * No answer arrived yet. Send a retransmit.
+			 */
+			arp_sendreq (are);
+			break;
+		
+		case ARS_REACHABLE:
+			/*
+			 * Not confirmed for a while, the next packet sent
+			 * to this address will trigger a new request.
+			 */
+			are->state = ARS_STALE;
+			event_add (&are->tmout, ARP_EXPIRE, arp_timeout, (long)are);
+			break;
+		
+		case ARS_STALE:
+		case ARS_FAILED:
+			/*
+			 * Delete it.
+			 */
 			arp_remove (are);
 			rarp_remove (are);
-		}
+			break;
 	}
-	else if (are->flags & ATF_PRCOM)
+}
+
+/*
+ * Called by if_send() for stale entries. Reconfirm the entry with a
+ * new request, but at most once every ARP_RATELIMIT ticks. The old
+ * hardware address is used until the answer arrives.
+ */
+void
+arp_refresh (struct arp_entry *are)
+{
+	if (are->state != ARS_STALE)
+		return;
+	
+	if ((GETTIME () - are->reqtime) >= ARP_RATELIMIT)
+		arp_request (are);
+}
+
+/*
+ * Queue a packet on an unresolved entry. If the queue is full the
+ * oldest packet is dropped, the newest ones are most likely to be
+ * of use once the entry resolves.
+ */
+long
+arp_queue (struct arp_entry *are, BUF *buf)
+{
+	BUF *b;
+	
+	if (are->state == ARS_FAILED)
 	{
-		/*
-		 * This is an unresolved ARP entry for which no
-		 * answer arrived yet. Send a retransmit.
-		 */
-		arp_sendreq (are);
+		buf_deref (buf, BUF_NORMAL);
+		are->nif->out_errors++;
+		return EHOSTUNREACH;
 	}
+	
+	if (are->outq.qlen >= are->outq.maxqlen && (b = if_dequeue (&are->outq)))
+	{
+		buf_deref (b, BUF_NORMAL);
+		are->nif->out_errors++;
+	}
+	
+	return if_enqueue (&are->outq, buf, IF_PRIORITIES-1);
 }
 
 /*
@@ -316,7 +452,7 @@ arp_lookup (short flags, struct netif *nif, short type, short len, char *addr)
 	struct arp_entry *are;
 	short idx;
 	
-	idx = arp_hash ((unsigned char *)addr, len);
+	idx = arp_hash ((unsigned char *)addr, len, arp_hashsize);
 	for (are = arptab[idx]; are; are = are->prnext)
 	{
 		if (are->flags & ATF_PRCOM &&
@@ -335,6 +471,7 @@ arp_lookup (short flags, struct netif *nif, short type, short len, char *addr)
 	
 	are->links = 2;
 	are->flags = ATF_PRCOM;
+	are->state = ARS_INCOMPLETE;
 	
 	are->hwtype = nif->hwtype;
 	are->hwaddr.len = nif->hwlocal.len;
@@ -348,6 +485,9 @@ arp_lookup (short flags, struct netif *nif, short type, short len, char *addr)
 	are->prnext = arptab[idx];
 	arptab[idx] = are;
 	
+	if (++arp_entries > 2 * arp_hashsize)
+		arp_grow ();
+	
 	if (!(flags & ARLK_NORESOLV))
 		arp_sendreq (are);
 	
@@ -365,7 +505,7 @@ rarp_lookup (short flags, struct netif *nif, short type, short len, char *addr)
 	short idx;
 	
 	UNUSED(flags);
-	idx = arp_hash ((unsigned char *)addr, len);
+	idx = arp_hash ((unsigned char *)addr, len, RARP_HASHSIZE);
 	for (are = rarptab[idx]; are; are = are->hwnext)
 	{
 		if (are->flags & ATF_HWCOM
@@ -468,10 +608,7 @@ arp_input (struct netif *nif, BUF *buf)
 		memcpy (are->hwaddr.adr.bytes, shw, arphdr->hwlen);
 		are->flags |= ATF_HWCOM;
 		rarp_put (are);
-		event_del (&are->tmout);
-		if (!(are->flags & ATF_PERM))
-			event_add (&are->tmout, ARP_EXPIRE, arp_timeout,
-				(long)are);
+		arp_reachable (are);
 		/*
 		 * Send all accumulated packets
 		 */
@@ -714,10 +851,7 @@ arp_ioctl (short cmd, void *arg)
 			are->flags &= ~ATF_USRMASK;
 			are->flags |= areq->flags & ATF_USRMASK;
 			rarp_put (are);
-			event_del (&are->tmout);
-			if (!(are->flags & ATF_PERM))
-				event_add (&are->tmout, ARP_EXPIRE, arp_timeout,
-					(long)are);
+			arp_reachable (are);
 			/*
 			 * Send all accumulated packets (if any)
 			 */
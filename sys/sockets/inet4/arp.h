@@ -66,15 +66,30 @@ struct arp_entry
 
 	struct event	tmout;		/* retransmit/timeout event */
 	ushort		retries;	/* number of retries so far */
+	ushort		state;		/* ARS_* state */
+	long		reqtime;	/* GETTIME() of last request sent */
 
 	struct arp_entry *prnext;	/* link to next entry in pr chain */
 	struct arp_entry *hwnext;	/* link to next entry in hw chain */
 };
 
+/* arp_entry.state */
+# define ARS_INCOMPLETE	0	/* request sent, packets are queued */
+# define ARS_REACHABLE	1	/* resolved and recently confirmed */
+# define ARS_STALE	2	/* resolved, reconfirm on next use */
+# define ARS_FAILED	3	/* unresolvable, drop packets (negative entry) */
+
 # define ARP_RETRIES	4			/* 4 retries before giving up*/
 # define ARP_RETRANS	(1000L / EVTGRAN)	/* retry after 1 sec */
-# define ARP_EXPIRE	(1200000L / EVTGRAN)	/* remove entry after 20 min */
-# define ARP_HASHSIZE	47			/* hash table size */
+# define ARP_REACHABLE	(600000L / EVTGRAN)	/* stale after 10 min */
+# define ARP_EXPIRE	(600000L / EVTGRAN)	/* remove stale entry after 10 min */
+# define ARP_NEGATIVE	(20000L / EVTGRAN)	/* keep failed entry 20 sec */
+# define ARP_RATELIMIT	200L			/* min. GETTIME() ticks between
+						 * requests for an entry (1 sec) */
+# define ARP_MAXQ	8			/* max. packets queued per entry */
+# define ARP_HASHSIZE	64			/* initial hash table size */
+# define ARP_MAXHASHSIZE 4096			/* hash table size limit */
+# define RARP_HASHSIZE	32
 # define ARP_RESERVE	100
 
 /*
@@ -101,9 +116,10 @@ struct arp_req
 # define ATF_ISCOM(are)	(((are)->flags & ATF_COM) == ATF_COM)
 
 /*
- * arp hash table
+ * arp hash table, grows with the number of entries
  */
-extern struct arp_entry *arptab[ARP_HASHSIZE];
+extern struct arp_entry **arptab;
+extern ushort arp_hashsize;
 
 long			arp_init (void);
 void			arp_free (struct arp_entry *);
@@ -111,6 +127,8 @@ void			arp_input (struct netif *, BUF *);
 void			rarp_input (struct netif *, BUF *);
 void			arp_flush (struct netif *);
 long			arp_ioctl (short, void *);
+long			arp_queue (struct arp_entry *, BUF *);
+void			arp_refresh (struct arp_entry *);
 struct arp_entry *	arp_lookup (short flags, struct netif *, short type, short len, char *);
 struct arp_entry *	rarp_lookup (short flags, struct netif *, short type, short len, char *);
 
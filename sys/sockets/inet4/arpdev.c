@@ -76,13 +76,13 @@ arpdev_read (FILEPTR *fp, char *buf, long nbytes)
 	for (space = nbytes; (unsigned long)space >= sizeof (info); fp->pos++)
 	{
 		i = fp->pos;
-		for (j = 0; j < ARP_HASHSIZE && i >= 0; j++)
+		for (j = 0; j < arp_hashsize && i >= 0; j++)
 		{
 			are = arptab[j];
 			for (; are && --i >= 0; are = are->prnext);
 		}
 		
-		if (j >= ARP_HASHSIZE)
+		if (j >= arp_hashsize)
 			break;
 		
 		mint_bzero (&info, sizeof (info));
@@ -0,0 +1,445 @@
+/*
+ *	Internet checksum primitives, with combined copy and checksum.
+ *
+ *	TCP and UDP used to copy user data into a BUF and then run a
+ *	second pass over the same bytes to checksum them. On the 68k
+ *	the memory bandwidth is the limiting factor, so we sum up the
+ *	data while it passes through the registers anyway.
+ *
+ *	The inner loops work on 32 byte blocks and come in three
+ *	flavours: 68000 (which cannot do long accesses at odd addresses),
+ *	68020 and up (dbra loop, X flag carried across iterations) and
+ *	ColdFire (no dbra, no movem postincrement, X flag folded in
+ *	every block). The plain C versions are only used to build
+ *	csumbench for the build host.
+ */
+
+# include "csum.h"
+
+# include "mint/socket.h"
+
+
+# if defined(__mc68020__) || defined(__mc68030__) || defined(__mc68040__) || defined(__mc68060__) || defined(__mcoldfire__)
+# define CSUM_UNALIGNED_OK	1
+# endif
+
+/*
+ * The dbra based loops use a 16 bit counter.
+ */
+# define CSUM_MAXBLOCKS		0x8000L
+
+/*
+ * A single byte at an even offset is the first byte of a 16 bit word,
+ * the high byte on the 68k.
+ */
+# if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+# define CSUM_LEADBYTE(b)	((ulong) (b))
+# else
+# define CSUM_LEADBYTE(b)	((ulong) (b) << 8)
+# endif
+
+# ifndef __m68k__
+
+static ulong
+csum_blocks (const void *buf, long nblocks, ulong sum)
+{
+	const ulong *p = buf;
+	short i;
+
+	while (nblocks--)
+	{
+		for (i = 0; i < 8; i++)
+			sum = csum_add (sum, p[i]);
+		p += 8;
+	}
+
+	return sum;
+}
+
+static ulong
+csum_blocks_copy (const void *src, void *dst, long nblocks, ulong sum)
+{
+	const ulong *s = src;
+	ulong *d = dst;
+	short i;
+
+	while (nblocks--)
+	{
+		for (i = 0; i < 8; i++)
+		{
+			ulong v = s[i];
+
+			d[i] = v;
+			sum = csum_add (sum, v);
+		}
+		s += 8;
+		d += 8;
+	}
+
+	return sum;
+}
+
+# else /* __m68k__ */
+
+/*
+ * Sum up `nblocks' (1 <= nblocks <= CSUM_MAXBLOCKS) 32 byte blocks.
+ */
+static ulong
+csum_blocks (const void *buf, long nblocks, ulong sum)
+{
+	__asm__ volatile (
+#ifdef __mcoldfire__
+		"1:\n"
+		"\tmoveml	%1@, %%d2-%%d5\n"
+		"\taddl	%%d2, %0\n"		/* clears X */
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmoveml	%1@(16), %%d2-%%d5\n"	/* X not affected */
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tlea	%1@(32), %1\n"
+		"\tmoveq	#0, %%d2\n"		/* X not affected */
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d2, %0\n"		/* carry of the carry */
+		"\tsubql	#1, %2\n"		/* X clobbered */
+		"\tbnes	1b\n"
+#else
+		"\tsubql	#1, %2\n"		/* clears X */
+		"1:\n"
+		"\tmoveml	%1@+, %%d2-%%d5\n"	/* X not affected */
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmoveml	%1@+, %%d2-%%d5\n"
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tdbra	%2, 1b\n"		/* X not affected */
+		"\tmoveq	#0, %%d2\n"
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d2, %0\n"
+#endif
+		: "+d"(sum), "+a"(buf), "+d"(nblocks)
+		:
+		: "d2", "d3", "d4", "d5", "cc", "memory"
+		);
+
+	return sum;
+}
+
+/*
+ * Copy `nblocks' (1 <= nblocks <= CSUM_MAXBLOCKS) 32 byte blocks from
+ * `src' to `dst' and sum them up on the way.
+ */
+static ulong
+csum_blocks_copy (const void *src, void *dst, long nblocks, ulong sum)
+{
+	__asm__ volatile (
+#if defined(__mcoldfire__)
+		"1:\n"
+		"\tmoveml	%1@, %%d2-%%d5\n"
+		"\taddl	%%d2, %0\n"		/* clears X */
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmoveml	%%d2-%%d5, %2@\n"	/* X not affected */
+		"\tmoveml	%1@(16), %%d2-%%d5\n"
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmoveml	%%d2-%%d5, %2@(16)\n"
+		"\tlea	%1@(32), %1\n"
+		"\tlea	%2@(32), %2\n"
+		"\tmoveq	#0, %%d2\n"		/* X not affected */
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d2, %0\n"		/* carry of the carry */
+		"\tsubql	#1, %3\n"		/* X clobbered */
+		"\tbnes	1b\n"
+#elif defined(CSUM_UNALIGNED_OK)
+		/*
+		 * Plain moves pipeline better than movem on the
+		 * 68040/68060 and are no slower on the 68020/68030.
+		 */
+		"\tsubql	#1, %3\n"		/* clears X */
+		"1:\n"
+		"\tmovel	%1@+, %%d2\n"		/* X not affected */
+		"\tmovel	%1@+, %%d3\n"
+		"\tmovel	%1@+, %%d4\n"
+		"\tmovel	%1@+, %%d5\n"
+		"\taddxl	%%d2, %0\n"
+		"\tmovel	%%d2, %2@+\n"
+		"\taddxl	%%d3, %0\n"
+		"\tmovel	%%d3, %2@+\n"
+		"\taddxl	%%d4, %0\n"
+		"\tmovel	%%d4, %2@+\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmovel	%%d5, %2@+\n"
+		"\tmovel	%1@+, %%d2\n"
+		"\tmovel	%1@+, %%d3\n"
+		"\tmovel	%1@+, %%d4\n"
+		"\tmovel	%1@+, %%d5\n"
+		"\taddxl	%%d2, %0\n"
+		"\tmovel	%%d2, %2@+\n"
+		"\taddxl	%%d3, %0\n"
+		"\tmovel	%%d3, %2@+\n"
+		"\taddxl	%%d4, %0\n"
+		"\tmovel	%%d4, %2@+\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmovel	%%d5, %2@+\n"
+		"\tdbra	%3, 1b\n"		/* X not affected */
+		"\tmoveq	#0, %%d2\n"
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d2, %0\n"
+#else
+		/*
+		 * 68000: movem is the cheapest way to load, but there
+		 * is no postincrement store version of it.
+		 */
+		"\tsubql	#1, %3\n"		/* clears X */
+		"1:\n"
+		"\tmoveml	%1@+, %%d2-%%d5\n"	/* X not affected */
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmovel	%%d2, %2@+\n"
+		"\tmovel	%%d3, %2@+\n"
+		"\tmovel	%%d4, %2@+\n"
+		"\tmovel	%%d5, %2@+\n"
+		"\tmoveml	%1@+, %%d2-%%d5\n"
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d3, %0\n"
+		"\taddxl	%%d4, %0\n"
+		"\taddxl	%%d5, %0\n"
+		"\tmovel	%%d2, %2@+\n"
+		"\tmovel	%%d3, %2@+\n"
+		"\tmovel	%%d4, %2@+\n"
+		"\tmovel	%%d5, %2@+\n"
+		"\tdbra	%3, 1b\n"		/* X not affected */
+		"\tmoveq	#0, %%d2\n"
+		"\taddxl	%%d2, %0\n"
+		"\taddxl	%%d2, %0\n"
+#endif
+		: "+d"(sum), "+a"(src), "+a"(dst), "+d"(nblocks)
+		:
+		: "d2", "d3", "d4", "d5", "cc", "memory"
+		);
+
+	return sum;
+}
+
+# endif /* __m68k__ */
+
+/*
+ * Returns the partial checksum over `len' bytes at `buf' added to `sum'.
+ */
+ulong
+csum_partial (const void *buf, long len, ulong sum)
+{
+	const uchar *p = buf;
+	long n;
+
+	if (len <= 0)
+		return sum;
+
+# ifndef CSUM_UNALIGNED_OK
+	if ((long) p & 1)
+	{
+		/*
+		 * The first byte is the high byte of the first word,
+		 * everything after it is shifted by one.
+		 */
+		sum = csum_add (sum, CSUM_LEADBYTE (*p));
+		return csum_block_add (sum, csum_partial (p + 1, len - 1, 0), 1);
+	}
+# endif
+
+	for (n = len >> 5; n > 0; n -= CSUM_MAXBLOCKS)
+	{
+		long blocks = MIN (n, CSUM_MAXBLOCKS);
+
+		sum = csum_blocks (p, blocks, sum);
+		p += blocks << 5;
+	}
+
+	for (len &= 31; len >= 4; len -= 4, p += 4)
+		sum = csum_add (sum, *(const ulong *) p);
+
+	if (len & 2)
+	{
+		sum = csum_add (sum, *(const ushort *) p);
+		p += 2;
+	}
+
+	if (len & 1)
+		sum = csum_add (sum, CSUM_LEADBYTE (*p));
+
+	return sum;
+}
+
+/*
+ * Copy `len' bytes from `src' to `dst' and return their partial
+ * checksum added to `sum'.
+ */
+ulong
+csum_partial_copy (const void *src, void *dst, long len, ulong sum)
+{
+	const uchar *s = src;
+	uchar *d = dst;
+	long n;
+
+	if (len <= 0)
+		return sum;
+
+# ifndef CSUM_UNALIGNED_OK
+	if (((long) s | (long) d) & 1)
+	{
+		if (((long) s & (long) d) & 1)
+		{
+			/*
+			 * Both odd, move the first byte by hand and
+			 * go on aligned.
+			 */
+			*d = *s;
+			sum = csum_add (sum, CSUM_LEADBYTE (*s));
+			return csum_block_add (sum,
+				csum_partial_copy (s + 1, d + 1, len - 1, 0), 1);
+		}
+
+		/*
+		 * Mutually misaligned, there is no way to do long
+		 * accesses on both sides. Rare enough to not care.
+		 */
+		memcpy (d, s, len);
+		return csum_partial (d, len, sum);
+	}
+# endif
+
+	for (n = len >> 5; n > 0; n -= CSUM_MAXBLOCKS)
+	{
+		long blocks = MIN (n, CSUM_MAXBLOCKS);
+
+		sum = csum_blocks_copy (s, d, blocks, sum);
+		s += blocks << 5;
+		d += blocks << 5;
+	}
+
+	for (len &= 31; len >= 4; len -= 4, s += 4, d += 4)
+	{
+		ulong v = *(const ulong *) s;
+
+		*(ulong *) d = v;
+		sum = csum_add (sum, v);
+	}
+
+	if (len & 2)
+	{
+		ushort v = *(const ushort *) s;
+
+		*(ushort *) d = v;
+		sum = csum_add (sum, v);
+		s += 2;
+		d += 2;
+	}
+
+	if (len & 1)
+	{
+		*d = *s;
+		sum = csum_add (sum, CSUM_LEADBYTE (*s));
+	}
+
+	return sum;
+}
+
+/*
+ * Add the TCP/UDP pseudo header to the partial sum `sum' and return
+ * the final checksum.
+ */
+ushort
+csum_tcpudp (ulong srcadr, ulong dstadr, ushort len, short proto, ulong sum)
+{
+	sum = csum_add (sum, srcadr);
+	sum = csum_add (sum, dstadr);
+	sum = csum_add (sum, ((ulong) proto << 16) | len);
+
+	return csum_fold (sum);
+}
+
+/*
+ * Like iov2buf_cpy() and buf2iov_cpy(), but additionally add the
+ * partial checksum of the copied data to `*sum'. The data in `buf'
+ * is assumed to start at an even offset of the datagram.
+ */
+long
+iov2buf_cpy_csum (char *buf, long nbytes, const struct iovec *iov, short niov, long skip, ulong *sum)
+{
+	long cando, todo = nbytes;
+
+	if (niov <= 0 || todo <= 0 || skip < 0)
+		return 0;
+
+	for (; skip > 0 && niov; ++iov, --niov)
+		skip -= iov->iov_len;
+
+	if (skip < 0)
+	{
+		cando = MIN (-skip, todo);
+		*sum = csum_block_add (*sum, csum_partial_copy (
+			iov[-1].iov_base + skip + iov[-1].iov_len, buf, cando, 0),
+			nbytes - todo);
+		buf  += cando;
+		todo -= cando;
+	}
+
+	for (; todo > 0 && niov; ++iov, --niov)
+	{
+		cando = MIN (todo, iov->iov_len);
+		*sum = csum_block_add (*sum, csum_partial_copy (
+			iov->iov_base, buf, cando, 0),
+			nbytes - todo);
+		todo -= cando;
+		buf  += cando;
+	}
+
+	return (nbytes - todo);
+}
+
+long
+buf2iov_cpy_csum (char *buf, long nbytes, const struct iovec *iov, short niov, long skip, ulong *sum)
+{
+	long cando, todo = nbytes;
+
+	if (niov <= 0 || todo <= 0 || skip < 0)
+		return 0;
+
+	for (; skip > 0 && niov; ++iov, --niov)
+		skip -= iov->iov_len;
+
+	if (skip < 0)
+	{
+		cando = MIN (-skip, todo);
+		*sum = csum_block_add (*sum, csum_partial_copy (
+			buf, iov[-1].iov_base + skip + iov[-1].iov_len, cando, 0),
+			nbytes - todo);
+		buf  += cando;
+		todo -= cando;
+	}
+
+	for (; todo > 0 && niov; ++iov, --niov)
+	{
+		cando = MIN (todo, iov->iov_len);
+		*sum = csum_block_add (*sum, csum_partial_copy (
+			buf, iov->iov_base, cando, 0),
+			nbytes - todo);
+		todo -= cando;
+		buf  += cando;
+	}
+
+	return (nbytes - todo);
+}
@@ -0,0 +1,75 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+# ifndef _csum_h
+# define _csum_h
+
+# include "global.h"
+
+# include "mint/iov.h"
+
+
+/*
+ * Partial checksums are 32 bit one's complement sums with end around
+ * carry. They are only folded down to 16 bits (and complemented) once
+ * the whole datagram including the pseudo header has been summed up.
+ */
+
+INLINE ulong
+csum_add (ulong sum, ulong add)
+{
+	sum += add;
+	return sum + (sum < add);
+}
+
+/*
+ * Add the partial sum `sum2' of a block that starts at byte offset
+ * `offset' of the datagram to `sum'. Blocks at odd offsets have their
+ * bytes swapped relative to the datagram, which is undone by rotating
+ * the partial sum by 8 bits.
+ */
+INLINE ulong
+csum_block_add (ulong sum, ulong sum2, long offset)
+{
+	if (offset & 1)
+		sum2 = (sum2 << 8) | (sum2 >> 24);
+
+	return csum_add (sum, sum2);
+}
+
+INLINE ushort
+csum_fold (ulong sum)
+{
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return (ushort)(~sum & 0xffff);
+}
+
+ulong	csum_partial		(const void *, long, ulong);
+ulong	csum_partial_copy	(const void *, void *, long, ulong);
+ushort	csum_tcpudp		(ulong, ulong, ushort, short, ulong);
+
+long	iov2buf_cpy_csum	(char *, long, const struct iovec *, short, long, ulong *);
+long	buf2iov_cpy_csum	(char *, long, const struct iovec *, short, long, ulong *);
+
+
+# endif /* _csum_h */
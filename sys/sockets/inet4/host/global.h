@@ -0,0 +1,30 @@
+/*
+ *	Stand-in for ../global.h to build csumbench with the host
+ *	compiler (make csumbench). Only provides what csum.c needs.
+ *
+ *	The checksum code relies on long being 32 bit like on MiNT,
+ *	so the MiNT type names are mapped to fixed size types. The
+ *	system headers that might use the names themselves are pulled
+ *	in before.
+ */
+
+# ifndef _global_h
+# define _global_h
+
+# include <stdint.h>
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <sys/types.h>
+
+# define ulong		uint32_t
+# define ushort		uint16_t
+# define uchar		uint8_t
+
+# define INLINE		static inline
+
+# define MIN(a,b)	((a) < (b) ? (a) : (b))
+
+
+# endif /* _global_h */
@@ -11,6 +11,7 @@
 # include "ip.h"
 # include "loopback.h"
 # include "route.h"
+# include "tcputil.h"
 # include "igmp.h"
 
 # include "mint/asm.h"
@@ -484,6 +485,46 @@ if_close (struct netif *nif)
 	return 0;
 }
 
+/*
+ * Cut a large TCP send into mss sized segments for an interface that
+ * can't do it itself and send them one by one.
+ */
+static long
+if_send_gso (struct netif *nif, BUF *buf, ulong nexthop, short addrtype)
+{
+	struct ip_dgram *iph = (struct ip_dgram *) buf->dstart;
+	long mss, r, ret = 0;
+	BUF *seg, *next;
+	
+	/*
+	 * The route may have changed to an interface with smaller mtu
+	 * since the segment size was chosen.
+	 */
+	mss = MIN ((long) IF_GSO_SIZE (buf),
+		nif->mtu - IP_HDRLEN (buf) - TCP_HDRLEN ((struct tcp_dgram *) IP_DATA (buf)));
+	
+	if (iph->proto != IPPROTO_TCP || mss <= 0)
+	{
+		DEBUG (("if_send_gso: cannot segment, dropping packet"));
+		buf_deref (buf, BUF_NORMAL);
+		return EINVAL;
+	}
+	
+	seg = tcp_gso_segment (buf, mss, !(nif->capabilities & IFCAP_TXCSUM));
+	if (!seg)
+		return ENOMEM;
+	
+	for (; seg; seg = next)
+	{
+		next = seg->next;
+		r = if_send (nif, seg, nexthop, addrtype);
+		if (r && !ret)
+			ret = r;
+	}
+	
+	return ret;
+}
+
 long
 if_send (struct netif *nif, BUF *buf, ulong nexthop, short addrtype)
 {
@@ -498,6 +539,9 @@ if_send (struct netif *nif, BUF *buf, ulong nexthop, short addrtype)
 		return ENETUNREACH;
 	}
 	
+	if (IF_GSO_SIZE (buf) && !(nif->capabilities & IFCAP_TSO))
+		return if_send_gso (nif, buf, nexthop, addrtype);
+	
 	if (nif->hwtype >= HWTYPE_NONE)
 	{
 		DEBUG (("if_send(%s): >= HWTYPE_NONE", nif->name));
@@ -552,11 +596,14 @@ if_send (struct netif *nif, BUF *buf, ulong nexthop, short addrtype)
 			
 			if (ATF_ISCOM (are))
 			{
+				if (are->state == ARS_STALE)
+					arp_refresh (are);
+				
 				ret = (*nif->output) (nif, buf, (char *)are->hwaddr.adr.bytes,
 					are->hwaddr.len, PKTYPE_IP);
 			}
 			else
-				ret = if_enqueue (&are->outq, buf, IF_PRIORITIES-1);
+				ret = arp_queue (are, buf);
 			
 			arp_deref (are);
 			return ret;
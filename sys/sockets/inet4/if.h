@@ -22,6 +22,20 @@
 # define IFF_IGMP               0x0400  /* Supports multicast */
 # define IFF_MASK		(IFF_UP|IFF_DEBUG|IFF_NOTRAILERS|IFF_NOARP)
 
+/* net interface capabilities */
+# define IFCAP_RXCSUM		0x0001	/* if verifies TCP/UDP checksums */
+# define IFCAP_TXCSUM		0x0002	/* if fills in TCP/UDP checksums,
+					 * the stack leaves them zero */
+# define IFCAP_TSO		0x0004	/* if segments large TCP sends and
+					 * fills in their checksums */
+
+/*
+ * Large TCP sends carry the segment size they must be cut into in the
+ * upper word of buf->info; the lower word is the priority as usual.
+ * if_send() segments them unless the interface has IFCAP_TSO.
+ */
+# define IF_GSO_SIZE(buf)	((ushort)((ulong)(buf)->info >> 16))
+
 # define IF_NAMSIZ		16	/* maximum if name len */
 # define IF_MAXQ		60	/* maximum if queue len */
 # define IF_SLOWTIMEOUT		1000	/* one second */
@@ -151,7 +165,8 @@ struct netif
 					 * depends on the device driver)
 					 */
 	void		(*igmp_mac_filter)(struct netif *, ulong, char action);
-	long		reserved[2];
+	ulong		capabilities;	/* hardware offload, IFCAP_* */
+	long		reserved[1];
 };
 
 /* interface statistics */
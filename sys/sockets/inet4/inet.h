@@ -76,6 +76,8 @@ struct in_ip_ops
 				ulong sadr, ulong dadr);
 	long	(*input) 	(struct netif *, BUF *, ulong sadr,
 				ulong dadr);
+	short			flags;
+# define IPO_CHAIN	0x0001	/* input accepts chained fragments */
 };	
 
 struct in_proto
@@ -231,6 +231,32 @@ ip_priority (short pri, uchar tos)
 	return MAX (pri, newpri);
 }
 
+/*
+ * Return nonzero if the interface datagrams to `daddr' are routed
+ * through fills in TCP/UDP checksums itself. `len' is the length of
+ * the transport datagram; anything that needs fragmenting must be
+ * checksummed by the stack.
+ */
+short
+ip_csum_offload (ulong daddr, ulong len)
+{
+	struct route *rt;
+	short r = 0;
+	
+	if ((daddr & 0xf0000000ul) == INADDR_MULTICAST)
+		return 0;
+	
+	rt = route_get (daddr);
+	if (rt)
+	{
+		r = (rt->nif->capabilities & IFCAP_TXCSUM)
+			&& len + IP_MINLEN <= rt->nif->mtu;
+		route_deref (rt);
+	}
+	
+	return r;
+}
+
 void
 ip_register (struct in_ip_ops *proto)
 {
@@ -340,8 +366,11 @@ ip_send (ulong saddr, ulong daddr, BUF *buf, short proto, short flags, struct ip
 	struct ip_options *opts = _opts ? _opts : &def_opts;
 	struct route *rt;
 	short addrtype;
+	ulong gso;
 	long r;
 	
+	gso = (flags & IP_GSO) ? (ushort) buf->info : 0;
+	
 	/*
 	 * Allocate and fill in IP header
 	 */
@@ -367,7 +396,7 @@ ip_send (ulong saddr, ulong daddr, BUF *buf, short proto, short flags, struct ip
 	iph->daddr   = daddr;
 	iph->chksum  = 0;
 	
-	nbuf->info = ip_priority (opts->pri, iph->tos);
+	nbuf->info = ip_priority (opts->pri, iph->tos) | (gso << 16);
 
 	/*
 	 * Route datagram to next interface
@@ -459,7 +488,8 @@ ip_input (struct netif *nif, BUF *buf)
 		buf_deref (buf, BUF_NORMAL);
 		return;
 	}
-	if (chksum (iph, iph->hdrlen * sizeof (short)))
+	if (!(nif->flags & IFF_LOOPBACK)
+	    && chksum (iph, iph->hdrlen * sizeof (short)))
 	{
 		DEBUG (("ip_input: bad checksum"));
 		buf_deref (buf, BUF_NORMAL);
@@ -536,16 +566,36 @@ ip_input (struct netif *nif, BUF *buf)
 		 */
 		if ((buf = ip_defrag (buf)))
 		{
+		    iph = (struct ip_dgram *) buf->dstart;
 		    for (p = allipprotos; p; p = p->next)
 		    {
-			if ((p->proto == iph->proto || p->proto == IPPROTO_RAW)
-			    && !(*p->input) (nif, buf, iph->saddr, iph->daddr))
+			if (p->proto != iph->proto && p->proto != IPPROTO_RAW)
+				continue;
+			
+			/*
+			 * Reassembled datagrams are passed as a chain of
+			 * fragments only to protocols that can handle it.
+			 */
+			if (buf->link3 && !(p->flags & IPO_CHAIN))
+			{
+				buf = ip_pullup (buf);
+				if (!buf)
+					break;
+				iph = (struct ip_dgram *) buf->dstart;
+			}
+			
+			if (!(*p->input) (nif, buf, iph->saddr, iph->daddr))
 				break;
 		    }
 		    if (!p)
 		    {
 			DEBUG (("ip_input: %d: No such proto", iph->proto));
-			icmp_send (ICMPT_DSTUR,ICMPC_PROTOUR,iph->saddr,buf,0);
+			buf = ip_pullup (buf);
+			if (buf)
+			{
+				iph = (struct ip_dgram *) buf->dstart;
+				icmp_send (ICMPT_DSTUR,ICMPC_PROTOUR,iph->saddr,buf,0);
+			}
 		    }
 		}
 		buf = buf2;
@@ -554,6 +604,7 @@ ip_input (struct netif *nif, BUF *buf)
 			route_deref (rt);
 			return;
 		}
+		iph = (struct ip_dgram *) buf->dstart;
 	}
 	
 # ifdef DONT_FORWARD
@@ -674,7 +725,10 @@ ip_frag (BUF *buf, struct netif *nif, ulong nexthop, short addrtype)
 	BUF *fragbuf;
 	char *data;
 	
-	if (iph->length <= nif->mtu)
+	/*
+	 * Large sends are segmented by if_send() or the interface.
+	 */
+	if (iph->length <= nif->mtu || IF_GSO_SIZE (buf))
 	{
 		iph->chksum = 0;
 		iph->chksum = chksum (iph, iph->hdrlen * sizeof (short));
@@ -762,35 +816,93 @@ ip_frag (BUF *buf, struct netif *nif, ulong nexthop, short addrtype)
 	return 0;
 }
 
+/*
+ * IP reassembly.
+ *
+ * Datagrams being reassembled are kept in a hash table keyed on
+ * (saddr, daddr, id, proto). The fragments of one datagram are kept
+ * in an array sorted by offset, so placing a new fragment and checking
+ * it for overlaps is a binary search. As overlapping fragments are
+ * rejected, the running byte count tells when all holes are filled.
+ *
+ * Complete datagrams are not copied together. The fragments are linked
+ * through `link3' in offset order, the first one carrying the IP header
+ * with the total length, the others with their IP headers stripped.
+ * Protocols that set IPO_CHAIN get this chain, for all others
+ * ip_input() pulls it up into a single BUF.
+ */
+
+struct fragent
+{
+	ushort		off;		/* data offset in bytes */
+	ushort		len;		/* data length in bytes */
+	BUF		*buf;		/* the fragment */
+};
+
 struct fragment
 {
-	BUF		*buf;		/* chain of fragments */
-	short		id;		/* IP datagram id */
+	struct fragment	*next;		/* next in hash chain */
 	ulong		saddr;		/* IP source address */
-	long		totlen;		/* total datagram length */
-	long		curlen;		/* current datagram length */
+	ulong		daddr;		/* IP destination address */
+	ushort		id;		/* IP datagram id */
+	uchar		proto;		/* IP protocol */
+	short		nfrags;		/* # of fragments received */
+	short		maxfrags;	/* # of slots in `frags' */
+	long		totlen;		/* total data length, 0 if unknown */
+	long		curlen;		/* data length received so far */
+	struct fragent	*frags;		/* fragments, sorted by offset */
 	struct event	tmout;		/* timeout event */
 };
 
-# define IPFRAG_HEADS	16		/* max # of fragment lists */
+# define IPFRAG_HASHSIZE	16		/* must be a power of two */
+# define IPFRAG_MAXQUEUES	32		/* max # of datagrams in reassembly */
+# define IPFRAG_NFRAGS		8		/* initial # of fragment slots */
 # define IPFRAG_TMOUT	(60000/EVTGRAN)	/* timeout reassambly after 1 min */
 
-static struct fragment allfrags[IPFRAG_HEADS];
+static struct fragment *fragtab[IPFRAG_HASHSIZE];
+static short nfragqueues;
+
+INLINE short
+frag_hash (ulong saddr, ulong daddr, ushort id, uchar proto)
+{
+	ulong v = saddr ^ daddr ^ id ^ proto;
+	
+	v ^= v >> 16;
+	v ^= v >> 8;
+	
+	return v & (IPFRAG_HASHSIZE - 1);
+}
 
+/*
+ * Unlink `frag' from the hash table and free it. The fragments are
+ * freed too if `freebufs' is set.
+ */
 static void
-frag_delete (struct fragment *frag)
+frag_delete (struct fragment *frag, short freebufs)
 {
-	BUF *buf, *next;
+	struct fragment **prev;
+	short i;
 	
-	buf = frag->buf;
-	frag->buf = 0;
-	for (; buf; buf = next)
+	prev = &fragtab[frag_hash (frag->saddr, frag->daddr, frag->id, frag->proto)];
+	for (; *prev; prev = &(*prev)->next)
 	{
-		next = buf->link3;
-		buf_deref (buf, BUF_NORMAL);
+		if (*prev == frag)
+		{
+			*prev = frag->next;
+			break;
+		}
+	}
+	
+	if (freebufs)
+	{
+		for (i = 0; i < frag->nfrags; i++)
+			buf_deref (frag->frags[i].buf, BUF_NORMAL);
 	}
 	
 	event_del (&frag->tmout);
+	kfree (frag->frags);
+	kfree (frag);
+	nfragqueues--;
 }
 
 static void
@@ -801,135 +913,302 @@ frag_timeout (long arg)
 	DEBUG (("frag_timeout: reassambly from id %x saddr 0x%lx timed out",
 		frag->id, frag->saddr));
 	
-	icmp_send (ICMPT_TIMEX, ICMPC_FRAGEX, frag->saddr, frag->buf, 0);
-	frag->buf = frag->buf->link3;
-	frag_delete (frag);
+	/*
+	 * Only send the ICMP error if we got the first fragment,
+	 * icmp_send() takes it over.
+	 */
+	if (frag->nfrags > 0 && frag->frags[0].off == 0)
+	{
+		BUF *buf = frag->frags[0].buf;
+		short i;
+		
+		for (i = 1; i < frag->nfrags; i++)
+			frag->frags[i-1] = frag->frags[i];
+		frag->nfrags--;
+		
+		icmp_send (ICMPT_TIMEX, ICMPC_FRAGEX, frag->saddr, buf, 0);
+	}
+	
+	frag_delete (frag, 1);
 }
 
-static BUF *
-frag_pullup (struct fragment *frag)
+static struct fragment *
+frag_create (struct ip_dgram *iph)
 {
-	struct ip_dgram *iph;
-	BUF *nbuf, *oldbuf;
-	long length, offset;
-	
-	if (frag->totlen == 0 || frag->totlen != frag->curlen)
-		return 0;
-	
-	TRACE (("frag_pullup: reassembling datagram from id %x saddr 0x%lx",
-		frag->id, frag->saddr));
+	struct fragment *frag;
+	short idx;
 	
-	iph = (struct ip_dgram *) frag->buf->dstart;
-	length = iph->hdrlen * sizeof (long);
-	
-	nbuf = buf_alloc (length + frag->totlen, 0, BUF_NORMAL);
-	if (!nbuf)
+	if (nfragqueues >= IPFRAG_MAXQUEUES)
 	{
-		DEBUG (("frag_pullup: no space for new buf"));
-		frag_delete (frag);
-		return 0;
+		DEBUG (("frag_create: too many datagrams in reassembly"));
+		return NULL;
 	}
-	memcpy (nbuf->dend, iph, length);
-	nbuf->dend += length;
 	
-	for (offset = 0; (oldbuf = frag->buf);)
+	frag = kmalloc (sizeof (*frag));
+	if (!frag)
+		return NULL;
+	
+	mint_bzero (frag, sizeof (*frag));
+	frag->frags = kmalloc (IPFRAG_NFRAGS * sizeof (struct fragent));
+	if (!frag->frags)
 	{
-		iph = (struct ip_dgram *)oldbuf->dstart;
-		if (offset != (iph->fragoff & IP_FRAGOFF)*8)
-		{
-			DEBUG (("frag_pullup: maleformed fragment list"));
-			frag_delete (frag);
-			return 0;
-		}
-		length = iph->length - iph->hdrlen * sizeof (long);
-		memcpy (nbuf->dend, IP_DATA (oldbuf), length);
-		nbuf->dend += length;
-		offset += length;
-		frag->buf = oldbuf->link3;
-		buf_deref (oldbuf, BUF_NORMAL);
+		kfree (frag);
+		return NULL;
 	}
-	iph = (struct ip_dgram *)nbuf->dstart;
-	iph->length = offset;
-	iph->fragoff = 0;
-	
-	event_del (&frag->tmout);
-	return nbuf;
+	frag->maxfrags = IPFRAG_NFRAGS;
+	frag->saddr = iph->saddr;
+	frag->daddr = iph->daddr;
+	frag->id = iph->id;
+	frag->proto = iph->proto;
+	
+	idx = frag_hash (frag->saddr, frag->daddr, frag->id, frag->proto);
+	frag->next = fragtab[idx];
+	fragtab[idx] = frag;
+	nfragqueues++;
+	
+	event_add (&frag->tmout, IPFRAG_TMOUT, frag_timeout, (long)frag);
+	return frag;
 }
 
+/*
+ * Insert the fragment `buf' into `frag'. Duplicate, overlapping and
+ * malformed fragments are dropped.
+ */
 static void
 frag_insert (struct fragment *frag, BUF *buf)
 {
-# define OFFSET(x) (((struct ip_dgram *)(x)->dstart)->fragoff & IP_FRAGOFF)
 	struct ip_dgram *iph = (struct ip_dgram *) buf->dstart;
-	BUF **prev, *curr;
-	long offset, datalen;
+	struct fragent *fe;
+	long off, len, hdrlen;
+	short lo, hi, mid;
 	
-	prev = &frag->buf;
-	curr = frag->buf;
-	offset = iph->fragoff & IP_FRAGOFF;
-	for (; curr; prev = &curr->link3, curr = curr->link3)
+	hdrlen = iph->hdrlen * sizeof (long);
+	off = (iph->fragoff & IP_FRAGOFF) * 8;
+	len = iph->length - hdrlen;
+	
+	if (len <= 0 || off + len + hdrlen > 0xffffL
+	    || ((iph->fragoff & IP_MF) && (len & 7)))
 	{
-		if (OFFSET (curr) > offset)
-			break;
-		else if (OFFSET (curr) == offset)
+		DEBUG (("frag_insert: dropping malformed fragment"));
+		buf_deref (buf, BUF_NORMAL);
+		return;
+	}
+	
+	if (!(iph->fragoff & IP_MF))
+	{
+		if (frag->totlen && frag->totlen != off + len)
 		{
-			DEBUG (("frag_insert: dropping duplicate fragment"));
+			DEBUG (("frag_insert: inconsistent last fragment"));
 			buf_deref (buf, BUF_NORMAL);
 			return;
 		}
+		frag->totlen = off + len;
+		
+		/*
+		 * Fragments queued before the end was known may
+		 * lie beyond it
+		 */
+		while (frag->nfrags > 0)
+		{
+			fe = &frag->frags[frag->nfrags - 1];
+			if (fe->off + fe->len <= frag->totlen)
+				break;
+			
+			DEBUG (("frag_insert: dropping fragment beyond end of datagram"));
+			frag->curlen -= fe->len;
+			buf_deref (fe->buf, BUF_NORMAL);
+			frag->nfrags--;
+		}
 	}
-	buf->link3 = curr;
-	*prev = buf;
-	
-	datalen = iph->length - iph->hdrlen * sizeof (long);
-	frag->curlen += datalen;
-	if (!curr && !(iph->fragoff & IP_MF))
-		frag->totlen = offset*8 + datalen;
-# if 0
-	if (event_delta (&frag->tmout) < iph->ttl*(1000/EVTGRAN))
-		event_reset (&frag->tmout, iph->ttl*(1000/EVTGRAN));
-# endif
+	
+	if (frag->totlen && off + len > frag->totlen)
+	{
+		DEBUG (("frag_insert: fragment beyond end of datagram"));
+		buf_deref (buf, BUF_NORMAL);
+		return;
+	}
+	
+	/*
+	 * Find the first fragment with an offset >= off
+	 */
+	lo = 0;
+	hi = frag->nfrags;
+	while (lo < hi)
+	{
+		mid = (lo + hi) >> 1;
+		if (frag->frags[mid].off < off)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	
+	if ((lo < frag->nfrags && frag->frags[lo].off < off + len)
+	    || (lo > 0 && frag->frags[lo-1].off + frag->frags[lo-1].len > off))
+	{
+		DEBUG (("frag_insert: dropping duplicate fragment"));
+		buf_deref (buf, BUF_NORMAL);
+		return;
+	}
+	
+	if (frag->nfrags >= frag->maxfrags)
+	{
+		fe = kmalloc (2 * frag->maxfrags * sizeof (*fe));
+		if (!fe)
+		{
+			DEBUG (("frag_insert: out of memory"));
+			buf_deref (buf, BUF_NORMAL);
+			return;
+		}
+		memcpy (fe, frag->frags, frag->nfrags * sizeof (*fe));
+		kfree (frag->frags);
+		frag->frags = fe;
+		frag->maxfrags *= 2;
+	}
+	
+	for (hi = frag->nfrags; hi > lo; hi--)
+		frag->frags[hi] = frag->frags[hi-1];
+	
+	fe = &frag->frags[lo];
+	fe->off = off;
+	fe->len = len;
+	fe->buf = buf;
+	
+	frag->nfrags++;
+	frag->curlen += len;
+}
+
+/*
+ * If `frag' is complete link the fragments together, free the
+ * reassembly queue and return the chain.
+ */
+static BUF *
+frag_chain (struct fragment *frag)
+{
+	struct ip_dgram *iph;
+	BUF *head, *b;
+	short i;
+	
+	if (frag->totlen == 0 || frag->totlen != frag->curlen)
+		return 0;
+	
+	/* no holes */
+	if (frag->frags[0].off != 0)
+		return 0;
+	
+	for (i = 1; i < frag->nfrags; i++)
+	{
+		if (frag->frags[i].off != frag->frags[i-1].off + frag->frags[i-1].len)
+			return 0;
+	}
+	
+	TRACE (("frag_chain: reassembled datagram from id %x saddr 0x%lx",
+		frag->id, frag->saddr));
+	
+	head = frag->frags[0].buf;
+	iph = (struct ip_dgram *) head->dstart;
+	iph->length = iph->hdrlen * sizeof (long) + frag->totlen;
+	iph->fragoff = 0;
+	
+	for (i = 1, b = head; i < frag->nfrags; i++)
+	{
+		b->link3 = frag->frags[i].buf;
+		b = b->link3;
+		b->dstart = IP_DATA (b);
+	}
+	b->link3 = NULL;
+	
+	frag_delete (frag, 0);
+	return head;
 }
 
 BUF *
 ip_defrag (BUF *buf)
 {
 	struct ip_dgram *iph = (struct ip_dgram *) buf->dstart;
-	struct fragment *frag, *free;
-	short i;
+	struct fragment *frag;
 	
 	if ((iph->fragoff & (IP_MF|IP_FRAGOFF)) == 0)
+	{
+		/*
+		 * link3 is stale from the interface queue
+		 */
+		buf->link3 = NULL;
 		return buf;
+	}
 	
-	free = 0;
-	for (i = IPFRAG_HEADS, frag = allfrags; i > 0; --i, frag++)
+	frag = fragtab[frag_hash (iph->saddr, iph->daddr, iph->id, iph->proto)];
+	for (; frag; frag = frag->next)
 	{
-		if (frag->buf)
-		{
-			if (iph->id == (ushort)frag->id && iph->saddr == frag->saddr)
-			{
-				frag_insert (frag, buf);
-				return frag_pullup (frag);
-			}
-		} else	free = frag;
+		if (iph->id == frag->id && iph->saddr == frag->saddr
+		    && iph->daddr == frag->daddr && iph->proto == frag->proto)
+			break;
 	}
 	
-	if (free)
+	if (!frag)
 	{
-		free->totlen = 0;
-		free->curlen = 0;
-		free->id = iph->id;
-		free->saddr = iph->saddr;
-		event_add (&free->tmout,IPFRAG_TMOUT,frag_timeout,(long)free);
-		frag_insert (free, buf);
+		frag = frag_create (iph);
+		if (!frag)
+		{
+			DEBUG (("ip_defrag: no more fragment slots, dropping dgram"));
+			buf_deref (buf, BUF_NORMAL);
+			return 0;
+		}
 	}
-	else
+	
+	frag_insert (frag, buf);
+	return frag_chain (frag);
+}
+
+/*
+ * Free a (possibly chained) datagram.
+ */
+void
+ip_chain_free (BUF *buf)
+{
+	BUF *next;
+	
+	for (; buf; buf = next)
 	{
-		DEBUG (("ip_defrag: no more fragment slots, dropping dgram"));
+		next = buf->link3;
 		buf_deref (buf, BUF_NORMAL);
 	}
+}
+
+/*
+ * Copy a chained datagram into a single BUF. The chain is freed in any
+ * case; returns NULL if out of memory.
+ */
+BUF *
+ip_pullup (BUF *buf)
+{
+	BUF *nbuf, *b;
+	long length;
 	
-	return 0;
+	if (!buf->link3)
+		return buf;
+	
+	for (length = 0, b = buf; b; b = b->link3)
+		length += b->dend - b->dstart;
+	
+	nbuf = buf_alloc (length, 0, BUF_NORMAL);
+	if (!nbuf)
+	{
+		DEBUG (("ip_pullup: no space for new buf"));
+		ip_chain_free (buf);
+		return 0;
+	}
+	
+	for (b = buf; b; b = b->link3)
+	{
+		length = b->dend - b->dstart;
+		memcpy (nbuf->dend, b->dstart, length);
+		nbuf->dend += length;
+	}
+	nbuf->info = buf->info;
+	nbuf->link3 = NULL;
+	
+	ip_chain_free (buf);
+	return nbuf;
 }
 
 long
@@ -98,6 +98,8 @@ struct ip_options
  */
 # define IP_DONTROUTE	0x01
 # define IP_BROADCAST	0x02
+# define IP_GSO		0x04	/* buf->info holds the segment size of
+				 * a large TCP send */
 
 extern struct in_ip_ops *allipprotos;
 extern short ip_dgramid;
@@ -110,6 +112,7 @@ short	ip_same_addr (ulong, ulong);
 ulong	ip_dst_addr (ulong);
 short	ip_chk_addr (ulong, struct route *);
 short	ip_priority (short, uchar);
+short	ip_csum_offload (ulong, ulong);
 
 struct in_ip_ops;
 
@@ -120,6 +123,8 @@ long	ip_send (ulong, ulong, BUF *, short, short, struct ip_options *);
 long	ip_output (BUF *);
 
 BUF *	ip_defrag (BUF *);
+BUF *	ip_pullup (BUF *);
+void	ip_chain_free (BUF *);
 
 long	ip_setsockopt (struct ip_options *, short, short, char *, long);
 long	ip_getsockopt (struct ip_options *, short, short, char *, long *);
@@ -894,7 +894,6 @@ tcp_input (struct netif *iface, BUF *buf, ulong saddr, ulong daddr)
 	struct tcb *tcb;
 	ulong pktlen;
 	
-	UNUSED(iface);
 	pktlen = (long)buf->dend - (long)tcph;
 	if (pktlen < TCP_MINLEN)
 	{
@@ -903,7 +902,13 @@ tcp_input (struct netif *iface, BUF *buf, ulong saddr, ulong daddr)
 		return 0;
 	}
 	
-	if (tcp_checksum (tcph, pktlen, saddr, daddr))
+	/*
+	 * Unlike UDP this can't be left to the copy in tcp_recv(): the
+	 * segment is acked and changes the connection state long before
+	 * the data is read, so it has to be verified here.
+	 */
+	if (!(iface->capabilities & IFCAP_RXCSUM)
+	    && tcp_checksum (tcph, pktlen, saddr, daddr))
 	{
 		DEBUG (("tcp_input: bad checksum"));
 		buf_deref (buf, BUF_NORMAL);
@@ -77,6 +77,8 @@
 # define TCP_DROPTHRESH	1
 
 # define TCP_RESERVE	140
+# define TCP_GSOMAX	(31 * 1024L)	/* max. size of large sends, bufs
+					 * are at most 32k */
 # define TCP_MINLEN	(sizeof (struct tcp_dgram))
 
 # define TCP_DATA(th)	((char *)(th) + (th)->hdrlen * 4)
@@ -163,6 +165,7 @@ struct tcb
 # define TCBF_NDELAY	0x10		/* disable nagle algorithm */
 # define TCBF_DELACK	0x20		/* need delayed ack */
 # define TCBF_ACKVALID	0x40		/* last_ack field valid */
+# define TCBF_HWCSUM	0x80		/* if computes the checksums */
 
 	long		snd_isn;	/* initial send sequence number */
 	long		snd_una;	/* oldest unacknowledged seq number */
@@ -177,6 +180,7 @@ struct tcb
 	short		snd_ppw;	/* # of mss sized pkts that fit into
 					   snd_wndmax */
 	long		snd_mss;	/* send max segment size */
+	long		snd_gso;	/* size of large sends, 0 if none */
 	long		snd_urg;	/* send urgent pointer */
 
 	long		rcv_isn;	/* initial recv sequence number */
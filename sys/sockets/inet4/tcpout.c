@@ -8,6 +8,7 @@
 # include "tcpout.h"
 
 # include "iov.h"
+# include "csum.h"
 # include "tcputil.h"
 
 
@@ -453,9 +454,9 @@ tcp_sndseg (struct tcb *tcb, BUF *b, short nretrans, long wnd1st, long wndnxt)
 {
 	struct tcp_dgram *tcph, *tcph2;
 	long seq1st, seqnxt = 0, offs;
-	ulong todo;
+	ulong todo, sum = 0;
 	BUF *nb, *b2;
-	short cut = 0;
+	short hdrlen, cut = 0, ipflags = 0;
 	
 	todo = (ulong)(b->dend - b->dstart);
 	nb = buf_alloc (TCP_RESERVE + todo, TCP_RESERVE/2, BUF_NORMAL);
@@ -465,7 +466,13 @@ tcp_sndseg (struct tcb *tcb, BUF *b, short nretrans, long wnd1st, long wndnxt)
 		return ENOMEM;
 	}
 	tcph = (struct tcp_dgram *)nb->dstart;
+	hdrlen = TCP_HDRLEN (TH (b));
 	
+	/*
+	 * The header is copied as is and summed up at the end, after
+	 * the fields have been updated. The data is checksummed while
+	 * being copied.
+	 */
 	seq1st = SEQ1ST (b);
 	seqnxt = seq1st + tcp_seglen (b, TH (b));
 	
@@ -492,7 +499,9 @@ tcp_sndseg (struct tcb *tcb, BUF *b, short nretrans, long wnd1st, long wndnxt)
 			todo -= seqnxt - wndnxt;
 			cut |= TCPF_FIN;
 		}
-		memcpy (nb->dstart, b->dstart, todo);
+		memcpy (nb->dstart, b->dstart, hdrlen);
+		sum = csum_partial_copy (b->dstart + hdrlen, nb->dstart + hdrlen,
+			todo - hdrlen, 0);
 		nb->dend += todo;
 	}
 	else
@@ -502,8 +511,8 @@ tcp_sndseg (struct tcb *tcb, BUF *b, short nretrans, long wnd1st, long wndnxt)
 		 * win:  |...
 		 */
 		cut |= TCPF_SYN;
-		memcpy (nb->dstart, b->dstart, TCP_HDRLEN (TH (b)));
-		nb->dend += TCP_HDRLEN (TH (b));
+		memcpy (nb->dstart, b->dstart, hdrlen);
+		nb->dend += hdrlen;
 		
 		if (TH(b)->flags & TCPF_SYN)
 			seq1st++;
@@ -521,7 +530,8 @@ tcp_sndseg (struct tcb *tcb, BUF *b, short nretrans, long wnd1st, long wndnxt)
 			todo -= seqnxt - wndnxt;
 			cut |= TCPF_FIN;
 		}
-		memcpy (nb->dend, TCP_DATA (TH (b)) + offs, todo);
+		sum = csum_partial_copy (TCP_DATA (TH (b)) + offs, nb->dend,
+			todo, 0);
 		nb->dend += todo;
 		
 		tcph->seq = wnd1st;
@@ -569,7 +579,9 @@ tcp_sndseg (struct tcb *tcb, BUF *b, short nretrans, long wnd1st, long wndnxt)
 		 * sequence pointer if necessary.
 		 */
 		DEBUG (("tcp_sndseg: adding %d bytes", nretrans));
-		memcpy (nb->dend, TCP_DATA (tcph2), nretrans);
+		sum = csum_block_add (sum,
+			csum_partial_copy (TCP_DATA (tcph2), nb->dend, nretrans, 0),
+			nb->dend - nb->dstart);
 		nb->dend += nretrans;
 		if (SEQLT (tcb->snd_max, seqnxt))
 			tcb->snd_max = seqnxt;
@@ -596,16 +608,28 @@ tcp_sndseg (struct tcb *tcb, BUF *b, short nretrans, long wnd1st, long wndnxt)
 		}
 	}
 	
-	tcph->chksum = tcp_checksum (tcph, nb->dend - nb->dstart,
-		tcb->data->src.addr,
-		tcb->data->dst.addr);
+	/*
+	 * Large sends are cut into mss sized segments further down,
+	 * which is where their checksums get computed.
+	 */
+	if ((ulong)(nb->dend - nb->dstart) - TCP_HDRLEN (tcph) > (ulong) tcb->snd_mss)
+	{
+		nb->info = tcb->snd_mss;
+		ipflags = IP_GSO;
+	}
+	else if (!(tcb->flags & TCBF_HWCSUM))
+		tcph->chksum = csum_tcpudp (tcb->data->src.addr,
+			tcb->data->dst.addr,
+			nb->dend - nb->dstart,
+			IPPROTO_TCP,
+			csum_partial (tcph, TCP_HDRLEN (tcph), sum));
 	
 	/*
 	 * Everything acked now
 	 */
 	tcb->flags &= ~TCBF_DELACK;
 	return ip_send (tcb->data->src.addr, tcb->data->dst.addr,
-			nb, IPPROTO_TCP, 0, &tcb->data->opts);
+			nb, IPPROTO_TCP, ipflags, &tcb->data->opts);
 }
 
 /*
@@ -742,13 +766,14 @@ tcp_sndhead (struct tcb *tcb)
 # ifdef USE_NAGLE
 	/*
 	 * Kludge cwnd so that the last segment is not sent if
-	 * last segment is not full sized and
+	 * last segment is not full sized (mss, also with large sends) and
 	 * 1) Something unacked is outstanding, or
 	 * 2) Nothing unacked is outstanding but there is more than
 	 *    one segment in the queue.
 	 * Otherwise send what we've got (or what cwnd allows).
 	 */
 	if (!(tcb->flags & TCBF_NDELAY) && b->info > DATLEN (b) &&
+	    DATLEN (b) < tcb->snd_mss - TCP_MAXRETRY &&
 	    (SEQLT (tcb->snd_una, tcb->snd_nxt) || q->qfirst != b))
 		r = MIN (SEQ1ST (b) - tcb->snd_wndack, r);
 # endif /* USE_NAGLE */
@@ -1085,7 +1110,7 @@ tcp_output (struct tcb *tcb, const struct iovec *iov, short niov, long len,
 		}
 		else
 		{
-			effmss = tcb->snd_mss;
+			effmss = tcb->snd_gso ? tcb->snd_gso : tcb->snd_mss;
 			
 			/*
 			 * Leave TCP_MAXRETRY bytes for the technique
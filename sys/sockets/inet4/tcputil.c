@@ -9,7 +9,9 @@
 
 # include "mint/net.h"
 
+# include "csum.h"
 # include "inetutil.h"
+# include "ip.h"
 # include "route.h"
 # include "tcpout.h"
 
@@ -396,12 +398,130 @@ tcp_mss (struct tcb *tcb, ulong faddr, long maxmss)
 		if (2*mss > tcb->data->snd.maxdatalen)
 			mss = tcb->data->snd.maxdatalen/2;
 		
+		/*
+		 * Segments never exceed the mtu, so we can leave the
+		 * checksums to the interface if it is able to.
+		 */
+		if (rt->nif->capabilities & IFCAP_TXCSUM)
+			tcb->flags |= TCBF_HWCSUM;
+		else
+			tcb->flags &= ~TCBF_HWCSUM;
+		
+		/*
+		 * Queue the data in large segments that are cut into
+		 * mss sized ones only by if_send() or the interface.
+		 * Not worth it if not at least two segments fit.
+		 */
+		tcb->snd_gso = MIN (TCP_GSOMAX, tcb->data->snd.maxdatalen/2);
+		if (tcb->snd_gso >= 2*mss)
+			tcb->snd_gso -= tcb->snd_gso % mss;
+		else
+			tcb->snd_gso = 0;
+		
 		route_deref (rt);
 	}
 	
 	return mss;	
 }
 
+/*
+ * Cut the large TCP/IP datagram `buf' into segments carrying at most
+ * `mss' bytes of data each. The segments are linked through `next',
+ * `buf' is freed. The TCP checksums are computed if `csum' is nonzero.
+ * Returns NULL if out of memory.
+ */
+BUF *
+tcp_gso_segment (BUF *buf, long mss, short csum)
+{
+	struct ip_dgram *iph = (struct ip_dgram *) buf->dstart;
+	struct tcp_dgram *tcph = (struct tcp_dgram *) IP_DATA (buf);
+	struct ip_dgram *siph;
+	struct tcp_dgram *stcph;
+	BUF *first = NULL, **prev = &first, *seg;
+	long hdrlen, iphlen, datalen, offset, todo, reserve;
+	char *data;
+	ulong sum;
+	
+	iphlen = IP_HDRLEN (buf);
+	hdrlen = iphlen + TCP_HDRLEN (tcph);
+	data = TCP_DATA (tcph);
+	datalen = (long) buf->dend - (long) data;
+	reserve = (long) buf->dstart - (long) buf->data;
+	
+	for (offset = 0; offset < datalen; offset += todo)
+	{
+		todo = MIN (mss, datalen - offset);
+		
+		seg = buf_alloc (hdrlen + todo + reserve, reserve, BUF_NORMAL);
+		if (!seg)
+		{
+			DEBUG (("tcp_gso_segment: out of bufs"));
+			for (; first; first = seg)
+			{
+				seg = first->next;
+				buf_deref (first, BUF_NORMAL);
+			}
+			buf_deref (buf, BUF_NORMAL);
+			return NULL;
+		}
+		
+		memcpy (seg->dstart, iph, hdrlen);
+		seg->dend += hdrlen;
+		
+		siph = (struct ip_dgram *) seg->dstart;
+		stcph = (struct tcp_dgram *) (seg->dstart + iphlen);
+		
+		if (csum)
+			sum = csum_partial_copy (data + offset, seg->dend, todo, 0);
+		else
+		{
+			memcpy (seg->dend, data + offset, todo);
+			sum = 0;
+		}
+		seg->dend += todo;
+		
+		/*
+		 * PSH and FIN only go with the last segment, the urgent
+		 * pointer is relative to each segment's sequence number.
+		 */
+		stcph->seq += offset;
+		if (offset + todo < datalen)
+			stcph->flags &= ~(TCPF_PSH|TCPF_FIN);
+		if (offset > 0)
+			stcph->flags &= ~TCPF_SYN;
+		if (stcph->flags & TCPF_URG)
+		{
+			if (stcph->urgptr > offset)
+				stcph->urgptr -= offset;
+			else
+			{
+				stcph->flags &= ~TCPF_URG;
+				stcph->urgptr = 0;
+			}
+		}
+		
+		stcph->chksum = 0;
+		if (csum)
+			stcph->chksum = csum_tcpudp (iph->saddr, iph->daddr,
+				hdrlen - iphlen + todo, IPPROTO_TCP,
+				csum_partial (stcph, hdrlen - iphlen, sum));
+		
+		if (offset > 0)
+			siph->id = ip_dgramid++;
+		siph->length = hdrlen + todo;
+		siph->chksum = 0;
+		siph->chksum = chksum (siph, iphlen / 2);
+		
+		seg->info = (ushort) buf->info;
+		seg->next = NULL;
+		*prev = seg;
+		prev = &seg->next;
+	}
+	
+	buf_deref (buf, BUF_NORMAL);
+	return first;
+}
+
 ushort
 tcp_checksum (struct tcp_dgram *dgram, ushort len, ulong srcadr, ulong dstadr)
 {
@@ -50,6 +50,7 @@ short		tcp_valid	(struct tcb *, BUF *);
 long		tcp_options	(struct tcb *, struct tcp_dgram *);
 long		tcp_mss		(struct tcb *, ulong faddr, long);
 ushort		tcp_checksum	(struct tcp_dgram *, ushort, ulong, ulong);
+BUF *		tcp_gso_segment	(BUF *, long, short);
 void		tcp_dump	(BUF *);
 
 /*
@@ -11,6 +11,7 @@
 # include "mint/net.h"
 # include "mint/pathconf.h"
 
+# include "csum.h"
 # include "icmp.h"
 # include "if.h"
 # include "in.h"
@@ -35,6 +36,10 @@ static long	udp_shutdown	(struct in_data *, short);
 static long	udp_setsockopt	(struct in_data *, short, short, char *, long);
 static long	udp_getsockopt	(struct in_data *, short, short, char *, long *);
 
+static long	udp_copyout	(BUF *, struct udp_dgram *, const struct iovec *, short, ulong *);
+static void	udp_dequeue	(struct in_data *, BUF *, long);
+static ulong	udp_sum		(BUF *, struct udp_dgram *);
+
 static long	udp_error	(short, short, BUF *, ulong, ulong);
 static long	udp_input	(struct netif *, BUF *, ulong, ulong);
 
@@ -50,7 +55,8 @@ struct in_proto udp_proto =
 	{	IPPROTO_UDP,
 		0,
 		udp_error,
-		udp_input
+		udp_input,
+		IPO_CHAIN
 	},
 	0
 };
@@ -80,6 +86,18 @@ udp_abort (struct in_data *data, short ostate)
 static long
 udp_detach (struct in_data *data, short wait)
 {
+	BUF *buf;
+	
+	/*
+	 * in_data_destroy() doesn't know about reassembled datagrams
+	 * that are still chained together.
+	 */
+	for (buf = data->rcv.qfirst; buf; buf = buf->next)
+	{
+		ip_chain_free (buf->link3);
+		buf->link3 = NULL;
+	}
+	
 	in_data_destroy (data, wait);
 	return 0;
 }
@@ -233,19 +251,31 @@ udp_send (struct in_data *data, const struct iovec *iov, short niov, short nonbl
 	uh->dstport = dstport;
 	uh->length = sizeof (struct udp_dgram) + size;
 	uh->chksum = 0;
-	copied = iov2buf_cpy (uh->data, size, iov, niov, 0);
 	
-	if (data->flags & IN_CHECKSUM)
+	if ((data->flags & IN_CHECKSUM)
+	    && !ip_csum_offload (dstaddr, uh->length))
 	{
+		ulong sum = 0;
+		
+		/*
+		 * Checksum the data while copying it in
+		 */
+		copied = iov2buf_cpy_csum (uh->data, size, iov, niov, 0, &sum);
+		sum = csum_partial (uh, sizeof (struct udp_dgram), sum);
+		
 		srcaddr = data->src.addr;
 		if (srcaddr == INADDR_ANY)
 			srcaddr = ip_local_addr (dstaddr);
 		if ((dstaddr & 0xf0000000ul) == INADDR_MULTICAST) {
 			srcaddr = data->opts.multicast_ip;
 		}
-		uh->chksum = udp_checksum (uh, srcaddr, dstaddr);
+		uh->chksum = csum_tcpudp (srcaddr, dstaddr, uh->length,
+			IPPROTO_UDP, sum);
 		if (!uh->chksum) uh->chksum = ~0;
 	}
+	else
+		copied = iov2buf_cpy (uh->data, size, iov, niov, 0);
+	
 	buf->dend += sizeof (struct udp_dgram) + size;
 	
 	if (data->flags & IN_BROADCAST)
@@ -290,6 +320,7 @@ udp_recv (struct in_data *data, const struct iovec *iov, short niov, short nonbl
 		return EINVAL;
 	}
 	
+again:
 	while (!data->rcv.qfirst)
 	{
 		if (nonblock)
@@ -327,7 +358,29 @@ udp_recv (struct in_data *data, const struct iovec *iov, short niov, short nonbl
 	buf = data->rcv.qfirst;
 	uh = (struct udp_dgram *) IP_DATA (buf);
 	todo = uh->length - sizeof (struct udp_dgram);
-	copied = buf2iov_cpy (uh->data, todo, iov, niov, 0);
+	
+	if (buf->info & UDP_CSUM_PENDING)
+	{
+		ulong sum = 0;
+		
+		/*
+		 * Verify the checksum udp_input() left to us while
+		 * copying out.
+		 */
+		copied = udp_copyout (buf, uh, iov, niov, &sum);
+		sum = csum_partial (uh, sizeof (struct udp_dgram), sum);
+		
+		if (csum_tcpudp (IP_SADDR (buf), IP_DADDR (buf), uh->length,
+				IPPROTO_UDP, sum))
+		{
+			DEBUG (("udp_recv: Bad checksum"));
+			udp_dequeue (data, buf, todo);
+			goto again;
+		}
+		buf->info &= ~UDP_CSUM_PENDING;
+	}
+	else
+		copied = udp_copyout (buf, uh, iov, niov, 0);
 	
 	if (addr)
 	{
@@ -341,25 +394,82 @@ udp_recv (struct in_data *data, const struct iovec *iov, short niov, short nonbl
 	}
 	
 	if (!(flags & MSG_PEEK))
+		udp_dequeue (data, buf, todo);
+	
+	return copied;
+}
+
+/*
+ * Copy the data of the (possibly chained) datagram `buf' to the user.
+ * If `sum' is nonzero the partial checksum of all the data, including
+ * the part that doesn't fit into the user's buffer, is added to it.
+ */
+static long
+udp_copyout (BUF *buf, struct udp_dgram *uh, const struct iovec *iov, short niov, ulong *sum)
+{
+	BUF *b;
+	char *data = uh->data;
+	long len, todo, copied, offset, n;
+	
+	todo = uh->length - sizeof (struct udp_dgram);
+	copied = 0;
+	
+	for (b = buf, offset = 0; b && todo > 0; b = b->link3, offset += len)
 	{
-		if (!buf->next)
+		if (b != buf)
+			data = b->dstart;
+		
+		len = MIN (b->dend - data, todo);
+		todo -= len;
+		
+		if (sum)
 		{
-			data->rcv.qfirst = data->rcv.qlast = 0;
-			data->rcv.curdatalen = 0;
+			ulong s = 0;
+			
+			n = buf2iov_cpy_csum (data, len, iov, niov, copied, &s);
+			if (n < len)
+				s = csum_block_add (s,
+					csum_partial (data + n, len - n, 0), n);
+			*sum = csum_block_add (*sum, s, offset);
 		}
 		else
 		{
-			data->rcv.qfirst = buf->next;
-			data->rcv.curdatalen -= todo;
-			buf->next->prev = 0;
+			n = buf2iov_cpy (data, len, iov, niov, copied);
+			if (n < len)
+			{
+				copied += n;
+				break;
+			}
 		}
 		
-		buf_deref (buf, BUF_NORMAL);
+		copied += n;
 	}
 	
 	return copied;
 }
 
+/*
+ * Remove the first datagram `buf' carrying `len' bytes of data from
+ * the receive queue and free it.
+ */
+static void
+udp_dequeue (struct in_data *data, BUF *buf, long len)
+{
+	if (!buf->next)
+	{
+		data->rcv.qfirst = data->rcv.qlast = 0;
+		data->rcv.curdatalen = 0;
+	}
+	else
+	{
+		data->rcv.qfirst = buf->next;
+		data->rcv.curdatalen -= len;
+		buf->next->prev = 0;
+	}
+	
+	ip_chain_free (buf);
+}
+
 static long
 udp_shutdown (struct in_data *data, short how)
 {
@@ -405,29 +515,41 @@ udp_input (struct netif *iface, BUF *buf, ulong saddr, ulong daddr)
 {
 	struct udp_dgram *uh = (struct udp_dgram *) IP_DATA (buf);
 	struct in_data *data;
+	BUF *b;
 	ulong pktlen;
+	short csum;
 	
-	UNUSED(iface);
 	pktlen = (long)buf->dend - (long)uh;
+	for (b = buf->link3; b; b = b->link3)
+		pktlen += (long)b->dend - (long)b->dstart;
+	
 	if (pktlen < UDP_MINLEN || pktlen != uh->length)
 	{
 		DEBUG (("udp_input: invalid packet length"));
-		buf_deref (buf, BUF_NORMAL);
-		return 0;
-	}
-	if (uh->chksum && udp_checksum (uh, saddr, daddr))
-	{
-		DEBUG (("udp_input: Bad checksum"));
-		buf_deref (buf, BUF_NORMAL);
+		ip_chain_free (buf);
 		return 0;
 	}
 	
+	/*
+	 * The checksum of datagrams we queue is verified by udp_recv()
+	 * while copying the data out, so it costs no extra pass.
+	 */
+	csum = uh->chksum && !(iface->capabilities & IFCAP_RXCSUM);
+	
 	data = in_data_lookup (udp_proto.datas, saddr, uh->srcport,
 		daddr, uh->dstport);
 	if (!data)
 	{
 		BUF *nbuf;
 		
+		if (csum && csum_tcpudp (saddr, daddr, uh->length,
+				IPPROTO_UDP, udp_sum (buf, uh)))
+		{
+			DEBUG (("udp_input: Bad checksum"));
+			ip_chain_free (buf);
+			return 0;
+		}
+		
 		DEBUG (("udp_input: Destination port %d non existant",
 			uh->dstport));
 		
@@ -448,16 +570,17 @@ udp_input (struct netif *iface, BUF *buf, ulong saddr, ulong daddr)
 	if (pktlen + data->rcv.curdatalen > (ulong)data->rcv.maxdatalen)
 	{
 		DEBUG (("udp_input: Input queue full"));
-		buf_deref (buf, BUF_NORMAL);
+		ip_chain_free (buf);
 		return 0;
 	}
 	if (data->sock->flags & SO_CANTRCVMORE)
 	{
 		DEBUG (("udp_input: Dropping packet, receiver shutdown"));
-		buf_deref (buf, BUF_NORMAL);
+		ip_chain_free (buf);
 		return 0;
 	}
 	buf->next = 0;
+	buf->info = csum ? UDP_CSUM_PENDING : 0;
 	
 	if (data->rcv.qlast)
 	{
@@ -509,6 +632,30 @@ udp_error (short type, short code, BUF *buf, ulong saddr, ulong daddr)
 	return 0;
 }
 
+/*
+ * Partial checksum of the (possibly chained) datagram `buf' starting
+ * with the UDP header `uh'.
+ */
+static ulong
+udp_sum (BUF *buf, struct udp_dgram *uh)
+{
+	BUF *b;
+	char *data = (char *) uh;
+	ulong sum = 0;
+	long len, offset = 0;
+	
+	for (b = buf; b; b = b->link3, offset += len)
+	{
+		if (b != buf)
+			data = b->dstart;
+		
+		len = (long)b->dend - (long)data;
+		sum = csum_block_add (sum, csum_partial (data, len, 0), offset);
+	}
+	
+	return sum;
+}
+
 ushort
 udp_checksum (struct udp_dgram *dgram, ulong srcadr, ulong dstadr)
 {
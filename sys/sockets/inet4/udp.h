@@ -20,6 +20,12 @@ struct udp_dgram
 
 # define UDP_MINLEN		(sizeof (struct udp_dgram))
 
+/*
+ * Flag in BUF->info of queued datagrams whose checksum has not yet
+ * been verified.
+ */
+# define UDP_CSUM_PENDING	0x0001
+
 
 extern struct in_proto udp_proto;
 
@@ -63,6 +63,7 @@
 # include "k_sysctl.h"
 # include "keyboard.h"
 # include "memory.h"
+# include "mmap.h"
 # include "proc.h"
 # include "ptrace.h"
 # include "rendez.h"
@@ -513,15 +514,15 @@ Func dos_tab [DOS_MAX] =
 	/* 0x17b */		sys_p_msgrcv,	/* not implemented */
 	/* 0x17c */		sys_enosys,		/* reserved */
 	/* 0x17d */		sys_m_access,	/* 1.15.12 */
-	/* 0x17e */		sys_enosys,		/* sys_mmap */
-	/* 0x17f */		sys_enosys,		/* sys_munmap */
+	/* 0x17e */	(Func)	sys_f_mmap,	/* 1.19 */
+	/* 0x17f */		sys_f_munmap,	/* 1.19 */
 
 	/* 0x180 */		sys_f_chown16,	/* 1.16 */
 	/* 0x181 */	(Func)	sys_f_chdir,	/* 1.17 */
 	/* 0x182 */	(Func)	sys_f_opendir,	/* 1.17 */
 	/* 0x183 */		sys_f_dirfd,	/* 1.17 */
-	/* 0x184 */		sys_enosys,		/* reserved */
-	/* 0x185 */		sys_enosys,		/* reserved */
+	/* 0x184 */		sys_d_readdirx,	/* 1.19 */
+	/* 0x185 */		sys_p_spawn,	/* 1.19 */
 	/* 0x186 */		sys_enosys,		/* reserved */
 	/* 0x187 */		sys_enosys,		/* reserved */
 	/* 0x188 */		sys_enosys,		/* reserved */
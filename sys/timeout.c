@@ -36,14 +36,21 @@ TIMEOUT *expire_list = NULL;
  */
 # define TIMEOUT_EXPIRE_LIMIT	400	/* 2 secs */
 
+/* dynamic timeouts, created on first use */
+static KMEM_CACHE *timeout_cache = NULL;
+
 static TIMEOUT *
 newtimeout (short fromlist)
 {
 	if (!fromlist)
 	{
-		register TIMEOUT *t;
+		register TIMEOUT *t = NULL;
+		
+		if (!timeout_cache)
+			timeout_cache = kmem_cache_create ("timeout", sizeof (*t), 0);
 		
-		t = kmalloc (sizeof (*t));
+		if (timeout_cache)
+			t = kmem_cache_alloc (timeout_cache);
 		if (t)
 		{
 			t->flags = 0;
@@ -77,7 +84,7 @@ static void
 disposetimeout (TIMEOUT *t)
 {
 	if (t->flags & TIMEOUT_STATIC) t->flags &= ~TIMEOUT_USED;
-	else kfree (t);
+	else kmem_cache_free (timeout_cache, t);
 }
 
 static void
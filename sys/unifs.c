@@ -77,6 +77,7 @@ FILESYS uni_filesys =
 	 * FS_EXT_3		extensions level 3 - stat & native UTC timestamps
 	 */
 	FS_LONGPATH	|
+	FS_NO_C_CACHE	|
 	FS_REENTRANT_L1	|
 	FS_REENTRANT_L2	|
 	FS_EXT_2	,
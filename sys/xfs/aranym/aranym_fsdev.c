@@ -219,7 +219,9 @@ FILESYS arafs_filesys =
 
 	/* FS_EXT_3 */
 	stat64:			ara_stat64,
-	res1:			0,
+
+	/* FS_EXT_4 */
+	readdirx:		NULL,
 	res2:			0,
 	res3:			0,
 
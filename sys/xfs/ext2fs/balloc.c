@@ -57,6 +57,46 @@ memscan (void *addr, long c, long size)
 
 # define in_range(b, first, len)	((b) >= (first) && (b) < (first) + (len))
 
+/*
+ * look for want_bytes consecutive free bytes (8 blocks each) in the
+ * bitmap from bit start on; returns the first bit of the first run
+ * that is long enough, else of the longest one, size if there is none
+ */
+static long
+find_zero_run (uchar *map, long start, long size, long want_bytes)
+{
+	long i = start >> 3;
+	long n = size >> 3;
+	long best = size;
+	long bestlen = 0;
+	
+	while (i < n)
+	{
+		long run;
+		
+		if (map[i])
+		{
+			i++;
+			continue;
+		}
+		
+		run = i;
+		while (i < n && !map[i])
+			i++;
+		
+		if (i - run >= want_bytes)
+			return run << 3;
+		
+		if (i - run > bestlen)
+		{
+			best = run << 3;
+			bestlen = i - run;
+		}
+	}
+	
+	return best;
+}
+
 
 INLINE UNIT *
 load_block_bitmap (SI *s, ulong block_group)
@@ -185,9 +225,14 @@ error_return:
  * is allocated.  Otherwise a forward search is made for a free block; within 
  * each block group the search first looks for an entire free byte in the block
  * bitmap, and then for any free bit if that fails.
+ *
+ * want is the number of blocks the caller is about to write; for more
+ * than 8 blocks the search looks for a free run of that length (in
+ * groups with enough free blocks first) and the preallocation window
+ * is sized to it.
  */
 long
-ext2_new_block (COOKIE *inode, ulong goal, ulong *prealloc_count, ulong *prealloc_block, long *err)
+ext2_new_block (COOKIE *inode, ulong goal, ulong want, ulong *prealloc_count, ulong *prealloc_block, long *err)
 {
 	SI *s = inode->s;
 	ext2_gd *gdp;
@@ -289,6 +334,18 @@ repeat:
 		
 		DEBUG (("Bit not found near goal"));
 		
+		/* large write: look for a free run of the wanted size
+		 */
+		if (want > 8)
+		{
+			k = find_zero_run (u->data, j, EXT2_BLOCKS_PER_GROUP (s), (want + 7) >> 3);
+			if (k < EXT2_BLOCKS_PER_GROUP (s))
+			{
+				j = k;
+				goto search_back;
+			}
+		}
+		
 		/*
 		 * There has been no free block found in the near vicinity
 		 * of the goal: do a search forward through the block groups,
@@ -320,23 +377,35 @@ repeat:
 	/*
 	 * Now search the rest of the groups.  We assume that 
 	 * i and gdp correctly point to the last group visited.
+	 * 
+	 * For large writes first look for a group that can take
+	 * the whole write, then for any group with free blocks.
 	 */
-	for (k = 0; k < s->sbi.s_groups_count; k++)
+	tmp = (want > 8) ? MIN (want, EXT2_BLOCKS_PER_GROUP (s) >> 1) : 1;
+	for (;;)
 	{
-		i++;
-		if (i >= s->sbi.s_groups_count)
-			i = 0;
-		
-		gdp = ext2_get_group_desc (s, i, &u2);
-		if (!gdp)
+		for (k = 0; k < s->sbi.s_groups_count; k++)
 		{
-			*err = EREAD;
-			/* unlock_super (s); */
-			return 0;
+			i++;
+			if (i >= s->sbi.s_groups_count)
+				i = 0;
+			
+			gdp = ext2_get_group_desc (s, i, &u2);
+			if (!gdp)
+			{
+				*err = EREAD;
+				/* unlock_super (s); */
+				return 0;
+			}
+			
+			if (le2cpu16 (gdp->bg_free_blocks_count) >= tmp)
+				break;
 		}
 		
-		if (le2cpu16 (gdp->bg_free_blocks_count) > 0)
+		if (k < s->sbi.s_groups_count || tmp == 1)
 			break;
+		
+		tmp = 1;
 	}
 	
 	if (k >= s->sbi.s_groups_count)
@@ -349,6 +418,13 @@ repeat:
 	if (!u)
 		goto io_error;
 	
+	if (want > 8)
+	{
+		j = find_zero_run (u->data, 0, EXT2_BLOCKS_PER_GROUP (s), (want + 7) >> 3);
+		if (j < EXT2_BLOCKS_PER_GROUP (s))
+			goto search_back;
+	}
+	
 	r = memscan (u->data, 0, EXT2_BLOCKS_PER_GROUP (s) >> 3);
 	j = ((unsigned long)r - (unsigned long)u->data) << 3;
 	if (j < EXT2_BLOCKS_PER_GROUP (s))
@@ -412,6 +488,9 @@ got_block:
 		prealloc_goal = s->sbi.s_prealloc_blocks ?
 			s->sbi.s_prealloc_blocks : EXT2_DEFAULT_PREALLOC_BLOCKS;
 		
+		if (want > prealloc_goal)
+			prealloc_goal = MIN (want, EXT2_MAX_PREALLOC_BLOCKS);
+		
 		*prealloc_count = 0;
 		*prealloc_block = tmp + 1;
 		
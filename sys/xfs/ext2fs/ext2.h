@@ -44,6 +44,7 @@
  */
 # define EXT2_PREALLOCATE
 # define EXT2_DEFAULT_PREALLOC_BLOCKS	8
+# define EXT2_MAX_PREALLOC_BLOCKS	256	/* upper limit for large writes */
 
 /*
  * The second extended file system version
@@ -394,9 +395,36 @@ struct ext2_super_block
 	__u8	s_prealloc_blocks;	/* Nr of blocks to try to preallocate*/
 	__u8	s_prealloc_dir_blocks;	/* Nr to preallocate for dirs */
 	__u16	s_padding1;
-	__u32	s_reserved[204];	/* Padding to the end of the block */
+	/*
+	 * Journaling support, valid if EXT3_FEATURE_COMPAT_HAS_JOURNAL set.
+	 */
+	__u8	s_journal_uuid[16];	/* uuid of journal superblock */
+	__u32	s_journal_inum;		/* inode number of journal file */
+	__u32	s_journal_dev;		/* device number of journal file */
+	__u32	s_last_orphan;		/* start of list of inodes to delete */
+	__u32	s_hash_seed[4];		/* HTREE hash seed */
+	__u8	s_def_hash_version;	/* Default hash version to use */
+	__u8	s_jnl_backup_type;
+	__u16	s_desc_size;		/* size of group descriptor */
+	__u32	s_default_mount_opts;
+	__u32	s_first_meta_bg;	/* First metablock block group */
+	__u32	s_mkfs_time;		/* When the filesystem was created */
+	__u32	s_jnl_blocks[17];	/* Backup of the journal inode */
+	__u32	s_blocks_count_hi;	/* Blocks count */
+	__u32	s_r_blocks_count_hi;	/* Reserved blocks count */
+	__u32	s_free_blocks_hi;	/* Free blocks count */
+	__u16	s_min_extra_isize;	/* All inodes have at least # bytes */
+	__u16	s_want_extra_isize;	/* New inodes should reserve # bytes */
+	__u32	s_flags;		/* Miscellaneous flags */
+	__u32	s_reserved[167];	/* Padding to the end of the block */
 };
 
+/*
+ * Miscellaneous superblock flags (s_flags)
+ */
+# define EXT2_FLAGS_SIGNED_HASH		0x0001	/* Signed dirhash in use */
+# define EXT2_FLAGS_UNSIGNED_HASH	0x0002	/* Unsigned dirhash in use */
+
 /*
  * Codes for operating systems
  */
@@ -427,6 +455,7 @@ struct ext2_super_block
 # define EXT2_HAS_INCOMPAT_FEATURE(sb, mask)	(EXT2_SB(sb)->s_feature_incompat & (mask))
 
 # define EXT2_FEATURE_COMPAT_DIR_PREALLOC	0x0001
+# define EXT2_FEATURE_COMPAT_DIR_INDEX		0x0020
 
 # define EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER	0x0001
 # define EXT2_FEATURE_RO_COMPAT_LARGE_FILE	0x0002
@@ -434,9 +463,14 @@ struct ext2_super_block
 
 # define EXT2_FEATURE_INCOMPAT_COMPRESSION	0x0001
 # define EXT2_FEATURE_INCOMPAT_FILETYPE		0x0002
+# define EXT4_FEATURE_INCOMPAT_EXTENTS		0x0040
+# define EXT4_FEATURE_INCOMPAT_FLEX_BG		0x0200
 
 # define EXT2_FEATURE_COMPAT_SUPP	0
 # define EXT2_FEATURE_INCOMPAT_SUPP	EXT2_FEATURE_INCOMPAT_FILETYPE
+/* incompatible features we can only mount read only */
+# define EXT2_FEATURE_INCOMPAT_RO_SUPP	( EXT4_FEATURE_INCOMPAT_EXTENTS		\
+					| EXT4_FEATURE_INCOMPAT_FLEX_BG		)
 # define EXT2_FEATURE_RO_COMPAT_SUPP	( EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER	\
 					| EXT2_FEATURE_RO_COMPAT_LARGE_FILE	\
 					| EXT2_FEATURE_RO_COMPAT_BTREE_DIR	)
@@ -499,6 +533,89 @@ struct ext2_dir_entry_2
 # define EXT2_DIR_ROUND 	(EXT2_DIR_PAD - 1)
 # define EXT2_DIR_REC_LEN(len)	(((len) + 8 + EXT2_DIR_ROUND) & ~EXT2_DIR_ROUND)
 
+/*
+ * Extent mapped (EXT4_EXTENTS_FL) inodes
+ *
+ * i_block holds the root of the extent tree: a header followed by up
+ * to 4 entries. Interior nodes hold ext4_extent_idx entries, leaves
+ * (depth 0) ext4_extent entries, all sorted by logical block.
+ */
+# define EXT4_EXT_MAGIC			0xf30a
+# define EXT4_EXT_MAX_DEPTH		5
+# define EXT4_EXT_INIT_MAX_LEN		32768	/* longer means unwritten */
+
+struct ext4_extent_header
+{
+	__u16	eh_magic;
+	__u16	eh_entries;		/* number of valid entries */
+	__u16	eh_max;			/* capacity of store in entries */
+	__u16	eh_depth;		/* has tree real underlying blocks? */
+	__u32	eh_generation;
+};
+
+struct ext4_extent
+{
+	__u32	ee_block;		/* first logical block extent covers */
+	__u16	ee_len;			/* number of blocks covered by extent */
+	__u16	ee_start_hi;		/* high 16 bits of physical block */
+	__u32	ee_start_lo;		/* low 32 bits of physical block */
+};
+
+struct ext4_extent_idx
+{
+	__u32	ei_block;		/* index covers logical blocks from 'block' */
+	__u32	ei_leaf_lo;		/* pointer to the physical block of the next level */
+	__u16	ei_leaf_hi;		/* high 16 bits of physical block */
+	__u16	ei_unused;
+};
+
+/*
+ * HTree (EXT2_INDEX_FL) directories
+ *
+ * Block 0 of an indexed directory starts with the "." and ".."
+ * entries, the latter covering the rest of the block; behind them
+ * follow the dx_root_info and the root dx_entry array. Interior index
+ * blocks are a single empty directory entry spanning the block,
+ * followed by a dx_entry array. To readers not knowing about the
+ * index the directory looks like a normal linear one.
+ *
+ * The first dx_entry of each array holds the count/limit pair in
+ * place of the hash.
+ */
+# define DX_HASH_LEGACY			0
+# define DX_HASH_HALF_MD4		1
+# define DX_HASH_TEA			2
+# define DX_HASH_LEGACY_UNSIGNED	3
+# define DX_HASH_HALF_MD4_UNSIGNED	4
+# define DX_HASH_TEA_UNSIGNED		5
+
+# define DX_MAX_LEVELS			2	/* root + 1 interior level */
+
+struct dx_root_info
+{
+	__u32	reserved_zero;
+	__u8	hash_version;
+	__u8	info_length;		/* 8 */
+	__u8	indirect_levels;
+	__u8	unused_flags;
+};
+
+struct dx_countlimit
+{
+	__u16	limit;
+	__u16	count;
+};
+
+struct dx_entry
+{
+	__u32	hash;
+	__u32	block;
+};
+
+/* offsets of the dx_root_info and of the node entries */
+# define DX_ROOT_INFO_OFFSET		(EXT2_DIR_REC_LEN (1) + EXT2_DIR_REC_LEN (2))
+# define DX_NODE_OFFSET			8
+
 
 
 
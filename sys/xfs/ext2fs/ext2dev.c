@@ -249,6 +249,11 @@ e_write (FILEPTR *f, const char *buf, long bytes)
 	written = 0;
 	todo = bytes;
 	
+	/* tell the block allocator how large this write is, so that
+	 * newly allocated blocks come from one contiguous run
+	 */
+	c->i_alloc_want = (offset + bytes + EXT2_BLOCK_SIZE_MASK (s)) >> EXT2_BLOCK_SIZE_BITS (s);
+	
 	/* partial block copy
 	 */
 	if (offset)
@@ -362,6 +367,8 @@ e_write (FILEPTR *f, const char *buf, long bytes)
 	}
 	
 out:
+	c->i_alloc_want = 0;
+	
 	if (pos > c->i_size)
 	{
 		c->i_size = pos;
@@ -446,14 +453,24 @@ e_read (FILEPTR *f, char *buf, long bytes)
 	{
 		long blocks = 1;
 		long data = EXT2_BLOCK_SIZE (s);
+		long count;
 		ulong tmp;
 		
-		tmp = ext2_bmap (c, block++);
+		tmp = ext2_bmap_len (c, block++, &count);
 		if (tmp)
 		{
 			long r;
 			
-			if ((todo - data) >= EXT2_BLOCK_SIZE (s))
+			if (count > 1)
+			{
+				/* extent mapped, take as much of the extent
+				 * as wanted in one transfer
+				 */
+				blocks = MIN (count, todo >> EXT2_BLOCK_SIZE_BITS (s));
+				data = blocks << EXT2_BLOCK_SIZE_BITS (s);
+				block += blocks - 1;
+			}
+			else if ((todo - data) >= EXT2_BLOCK_SIZE (s))
 			{
 				register ulong tmp_new = ext2_bmap (c, block);
 				register long tmp_old = tmp;
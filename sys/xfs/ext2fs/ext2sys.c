@@ -65,6 +65,7 @@ static long	_cdecl e_rename		(fcookie *olddir, char *oldname, fcookie *newdir, c
 
 static long	_cdecl e_opendir	(DIR *dirh, int flag);
 static long	_cdecl e_readdir	(DIR *dirh, char *name, int namelen, fcookie *fc);
+static long	_cdecl e_readdirx	(DIR *dirh, char *buf, long len);
 static long	_cdecl e_rewinddir	(DIR *dirh);
 static long	_cdecl e_closedir	(DIR *dirh);
 
@@ -105,6 +106,7 @@ FILESYS ext2_filesys =
 	 * FS_EXT_1		extensions level 1 - mknod & unmount
 	 * FS_EXT_2		extensions level 2 - additional place at the end
 	 * FS_EXT_3		extensions level 3 - stat & native UTC timestamps
+	 * FS_EXT_4		extensions level 4 - bulk readdirx
 	 */
 	FS_CASESENSITIVE	|
 	FS_LONGPATH		|
@@ -112,7 +114,8 @@ FILESYS ext2_filesys =
 	FS_OWN_MEDIACHANGE	|
 	FS_EXT_1		|
 	FS_EXT_2		|
-	FS_EXT_3		,
+	FS_EXT_3		|
+	FS_EXT_4		,
 
 	root:			e_root,
 	lookup:			e_lookup,
@@ -153,7 +156,9 @@ FILESYS ext2_filesys =
 
 	/* FS_EXT_3 */
 	stat64:			e_stat64,
-	res1:			0,
+
+	/* FS_EXT_4 */
+	readdirx:		e_readdirx,
 	res2:			0,
 	res3:			0,
 
@@ -647,7 +652,6 @@ e_mkdir (fcookie *dir, const char *name, unsigned mode)
 
 	dirc->in.i_version = cpu2le32 (++event);
 	dirc->in.i_links_count = cpu2le16 (le2cpu16 (dirc->in.i_links_count) + 1);
-	dirc->in.i_flags = cpu2le32 (le2cpu32 (dirc->in.i_flags) & ~EXT2_BTREE_FL);
 	mark_inode_dirty (dirc);
 
 	/* update directory cache */
@@ -846,7 +850,6 @@ e_rmdir (fcookie *dir, const char *name)
 
 	dirc->in.i_links_count = cpu2le16 (le2cpu16 (dirc->in.i_links_count) - 1);
 	dirc->in.i_ctime = dirc->in.i_mtime = inode->in.i_ctime;
-	dirc->in.i_flags = cpu2le32 (le2cpu32 (dirc->in.i_flags) & ~EXT2_BTREE_FL);
 	mark_inode_dirty (dirc);
 
 out:
@@ -999,7 +1002,6 @@ e_remove (fcookie *dir, const char *name)
 
 	dirc->in.i_version = cpu2le32 (++event);
 	dirc->in.i_ctime = dirc->in.i_mtime = cpu2le32 (CURRENT_TIME);
-	dirc->in.i_flags = cpu2le32 (le2cpu32 (dirc->in.i_flags) & ~EXT2_BTREE_FL);
 	mark_inode_dirty (dirc);
 
 	inode->in.i_links_count = cpu2le16 (le2cpu16 (inode->in.i_links_count) - 1);
@@ -1288,7 +1290,6 @@ e_rename (fcookie *olddir, char *oldname, fcookie *newdir, const char *newname)
 	{
 		newdirc->in.i_version = cpu2le32 (++event);
 		newdirc->in.i_ctime = newdirc->in.i_mtime = cpu2le32 (CURRENT_TIME);
-		newdirc->in.i_flags = cpu2le32 (le2cpu32 (newdirc->in.i_flags) & ~EXT2_BTREE_FL);
 
 		if (EXT2_ISDIR (le2cpu16 (inode->in.i_mode)))
 		{
@@ -1306,7 +1307,6 @@ e_rename (fcookie *olddir, char *oldname, fcookie *newdir, const char *newname)
 
 	olddirc->in.i_version = cpu2le32 (++event);
 	olddirc->in.i_ctime = olddirc->in.i_mtime = cpu2le32 (CURRENT_TIME);
-	olddirc->in.i_flags = cpu2le32 (le2cpu32 (olddirc->in.i_flags) & ~EXT2_BTREE_FL);
 	mark_inode_dirty (olddirc);
 
 	/* update directory cache */
@@ -1500,6 +1500,66 @@ found:
 	}
 }
 
+/* readdir and stat the cookie it returns; an entry that doesn't fit
+ * is pushed back by restoring the saved position
+ */
+static long _cdecl
+e_readdirx (DIR *dirh, char *buf, long len)
+{
+	union { char *c; struct dirinfo *dirinfo; } dirptr = {dirh->fsstuff};
+	char name[EXT2_NAME_LEN + 1 + 4];
+	char *nm;
+	long used;
+
+	DEBUG (("Ext2-FS [%c]: e_readdirx: #%li", dirh->fc.dev+'A', ((COOKIE *) dirh->fc.index)->inode));
+
+	/* non-TOS readdir puts the inode in front of the name */
+	nm = (dirh->flags & TOS_SEARCH) ? name : name + 4;
+
+	used = 0;
+	for (;;)
+	{
+		struct dirinfo saved = *dirptr.dirinfo;
+		struct dirstat *d = (struct dirstat *) (buf + used);
+		fcookie fc;
+		ushort namelen, reclen;
+		long r;
+
+		r = e_readdir (dirh, name, sizeof (name), &fc);
+		if (r != E_OK)
+		{
+			if (r == ENMFILES || used)
+				break;
+
+			return r;
+		}
+
+		namelen = strlen (nm);
+		reclen = DIRSTAT_RECLEN (namelen);
+		if (len - used < reclen)
+		{
+			*dirptr.dirinfo = saved;
+			e_release (&fc);
+
+			if (!used)
+				return ERANGE;
+
+			break;
+		}
+
+		d->namelen = namelen;
+		d->reclen = reclen;
+		d->ret = e_stat64 (&fc, &d->st);
+		strcpy (d->name, nm);
+
+		e_release (&fc);
+		used += reclen;
+	}
+
+	DEBUG (("Ext2-FS [%c]: e_readdirx leave (%li bytes)", dirh->fc.dev+'A', used));
+	return used;
+}
+
 static long _cdecl
 e_rewinddir (DIR *dirh)
 {
@@ -1986,7 +2046,8 @@ e_fscntl (fcookie *dir, const char *name, int cmd, long arg)
 
 				r = E_OK;
 			}
-			else if (s->s_flags & MS_RDONLY)
+			else if ((s->s_flags & MS_RDONLY)
+				&& !(le2cpu32 (s->sbi.s_sb->s_feature_incompat) & EXT2_FEATURE_INCOMPAT_RO_SUPP))
 			{
 				s->sbi.s_sb->s_state = cpu2le16 (le2cpu16 (s->sbi.s_sb->s_state) & ~EXT2_VALID_FS);
 				bio_MARK_MODIFIED (&bio, s->sbi.s_sb_unit);
@@ -137,6 +137,7 @@ struct cookie
 	ulong	i_next_alloc_goal;
 	ulong	i_prealloc_block;
 	ulong	i_prealloc_count;
+	ulong	i_alloc_want;	/* blocks covered by the current e_write */
 };
 
 INLINE void
@@ -0,0 +1,529 @@
+/*
+ * Filename:     htree.c
+ * Project:      ext2 file system driver for MiNT
+ *
+ * Note:         Please send suggestions, patches or bug reports to
+ *               the MiNT mailing list <freemint-discuss@lists.sourceforge.net>
+ *
+ * Portions copyright 2002 by Theodore Ts'o and Daniel Phillips
+ * (directory hash functions and index layout from the Linux kernel)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+# include "htree.h"
+
+# include "inode.h"
+# include "namei.h"
+
+
+/*
+ * directory hash functions
+ *
+ * These have to produce bit for bit the same values as the Linux
+ * implementation, including the signed/unsigned char variants.
+ */
+
+# define DX_HTREE_EOF		0x7fffffffUL
+
+static ulong
+dx_hack_hash (const char *name, long len, long unsig)
+{
+	ulong hash, hash0 = 0x12a3fe2d, hash1 = 0x37abe8f9;
+
+	while (len--)
+	{
+		long c = unsig ? (long)(uchar) *name : (long)(signed char) *name;
+
+		name++;
+
+		hash = hash1 + (hash0 ^ (ulong)(c * 7152373));
+		if (hash & 0x80000000UL)
+			hash -= 0x7fffffffUL;
+
+		hash1 = hash0;
+		hash0 = hash;
+	}
+
+	return hash0 << 1;
+}
+
+static void
+str2hashbuf (const char *msg, long len, ulong *buf, long num, long unsig)
+{
+	ulong pad, val;
+	long i;
+
+	pad = (ulong) len | ((ulong) len << 8);
+	pad |= pad << 16;
+
+	val = pad;
+	if (len > num * 4)
+		len = num * 4;
+
+	for (i = 0; i < len; i++)
+	{
+		long c = unsig ? (long)(uchar) msg[i] : (long)(signed char) msg[i];
+
+		val = (ulong) c + (val << 8);
+		if ((i % 4) == 3)
+		{
+			*buf++ = val;
+			val = pad;
+			num--;
+		}
+	}
+
+	if (--num >= 0)
+		*buf++ = val;
+
+	while (--num >= 0)
+		*buf++ = pad;
+}
+
+# define TEA_DELTA	0x9E3779B9UL
+
+static void
+TEA_transform (ulong buf[4], const ulong in[4])
+{
+	ulong sum = 0;
+	ulong b0 = buf[0], b1 = buf[1];
+	ulong a = in[0], b = in[1], c = in[2], d = in[3];
+	int n = 16;
+
+	do {
+		sum += TEA_DELTA;
+		b0 += ((b1 << 4) + a) ^ (b1 + sum) ^ ((b1 >> 5) + b);
+		b1 += ((b0 << 4) + c) ^ (b0 + sum) ^ ((b0 >> 5) + d);
+	}
+	while (--n);
+
+	buf[0] += b0;
+	buf[1] += b1;
+}
+
+# define ROL32(x, s)	(((x) << (s)) | ((x) >> (32 - (s))))
+
+# define F(x, y, z)	((z) ^ ((x) & ((y) ^ (z))))
+# define G(x, y, z)	(((x) & (y)) + (((x) ^ (y)) & (z)))
+# define H(x, y, z)	((x) ^ (y) ^ (z))
+
+# define MD4_ROUND(f, a, b, c, d, x, s)	(a += f (b, c, d) + (x), a = ROL32 (a, s))
+
+# define K1	0UL
+# define K2	013240474631UL
+# define K3	015666365641UL
+
+static void
+half_md4_transform (ulong buf[4], const ulong in[8])
+{
+	ulong a = buf[0], b = buf[1], c = buf[2], d = buf[3];
+
+	/* round 1 */
+	MD4_ROUND (F, a, b, c, d, in[0] + K1,  3);
+	MD4_ROUND (F, d, a, b, c, in[1] + K1,  7);
+	MD4_ROUND (F, c, d, a, b, in[2] + K1, 11);
+	MD4_ROUND (F, b, c, d, a, in[3] + K1, 19);
+	MD4_ROUND (F, a, b, c, d, in[4] + K1,  3);
+	MD4_ROUND (F, d, a, b, c, in[5] + K1,  7);
+	MD4_ROUND (F, c, d, a, b, in[6] + K1, 11);
+	MD4_ROUND (F, b, c, d, a, in[7] + K1, 19);
+
+	/* round 2 */
+	MD4_ROUND (G, a, b, c, d, in[1] + K2,  3);
+	MD4_ROUND (G, d, a, b, c, in[3] + K2,  5);
+	MD4_ROUND (G, c, d, a, b, in[5] + K2,  9);
+	MD4_ROUND (G, b, c, d, a, in[7] + K2, 13);
+	MD4_ROUND (G, a, b, c, d, in[0] + K2,  3);
+	MD4_ROUND (G, d, a, b, c, in[2] + K2,  5);
+	MD4_ROUND (G, c, d, a, b, in[4] + K2,  9);
+	MD4_ROUND (G, b, c, d, a, in[6] + K2, 13);
+
+	/* round 3 */
+	MD4_ROUND (H, a, b, c, d, in[3] + K3,  3);
+	MD4_ROUND (H, d, a, b, c, in[7] + K3,  9);
+	MD4_ROUND (H, c, d, a, b, in[2] + K3, 11);
+	MD4_ROUND (H, b, c, d, a, in[6] + K3, 15);
+	MD4_ROUND (H, a, b, c, d, in[1] + K3,  3);
+	MD4_ROUND (H, d, a, b, c, in[5] + K3,  9);
+	MD4_ROUND (H, c, d, a, b, in[0] + K3, 11);
+	MD4_ROUND (H, b, c, d, a, in[4] + K3, 15);
+
+	buf[0] += a;
+	buf[1] += b;
+	buf[2] += c;
+	buf[3] += d;
+}
+
+/* returns 0 for unknown hash versions */
+static long
+dx_hash (SI *s, long version, const char *name, long len, ulong *res)
+{
+	ext2_sb *sb = s->sbi.s_sb;
+	ulong buf[4], in[8];
+	ulong hash;
+	long unsig;
+	long i;
+
+	buf[0] = 0x67452301UL;
+	buf[1] = 0xefcdab89UL;
+	buf[2] = 0x98badcfeUL;
+	buf[3] = 0x10325476UL;
+
+	for (i = 0; i < 4; i++)
+	{
+		if (sb->s_hash_seed[i])
+		{
+			for (i = 0; i < 4; i++)
+				buf[i] = le2cpu32 (sb->s_hash_seed[i]);
+
+			break;
+		}
+	}
+
+	if (version <= DX_HASH_TEA && (le2cpu32 (sb->s_flags) & EXT2_FLAGS_UNSIGNED_HASH))
+		version += DX_HASH_LEGACY_UNSIGNED;
+
+	unsig = (version >= DX_HASH_LEGACY_UNSIGNED);
+
+	switch (version)
+	{
+		case DX_HASH_LEGACY:
+		case DX_HASH_LEGACY_UNSIGNED:
+		{
+			hash = dx_hack_hash (name, len, unsig);
+			break;
+		}
+		case DX_HASH_HALF_MD4:
+		case DX_HASH_HALF_MD4_UNSIGNED:
+		{
+			while (len > 0)
+			{
+				str2hashbuf (name, len, in, 8, unsig);
+				half_md4_transform (buf, in);
+				len -= 32;
+				name += 32;
+			}
+			hash = buf[1];
+			break;
+		}
+		case DX_HASH_TEA:
+		case DX_HASH_TEA_UNSIGNED:
+		{
+			while (len > 0)
+			{
+				str2hashbuf (name, len, in, 4, unsig);
+				TEA_transform (buf, in);
+				len -= 16;
+				name += 16;
+			}
+			hash = buf[0];
+			break;
+		}
+		default:
+		{
+			ALERT (("Ext2-FS: unknown directory hash version %li", version));
+			return 0;
+		}
+	}
+
+	hash &= ~1UL;
+	if (hash == (DX_HTREE_EOF << 1))
+		hash = (DX_HTREE_EOF - 1) << 1;
+
+	*res = hash;
+	return 1;
+}
+
+
+/*
+ * index walk
+ *
+ * Only logical block numbers and array positions are remembered per
+ * level; the units themselves may be recycled by the buffer cache
+ * while further blocks are read.
+ */
+
+struct dx_frame
+{
+	long	block;		/* logical block of this index level */
+	long	offset;		/* offset of the dx_entry array in it */
+	long	count;		/* number of entries in the array */
+	long	at;		/* entry we descended through */
+};
+
+/* validate the dx_entry array of a root or node block */
+static struct dx_entry *
+dx_entries (COOKIE *dir, UNIT *u, long offset, long *count)
+{
+	struct dx_entry *e = (struct dx_entry *) (u->data + offset);
+	struct dx_countlimit *cl = (struct dx_countlimit *) e;
+	long limit = le2cpu16 (cl->limit);
+
+	*count = le2cpu16 (cl->count);
+
+	if (limit != (EXT2_BLOCK_SIZE (dir->s) - offset) / sizeof (*e)
+		|| *count == 0 || *count > limit)
+	{
+		ALERT (("Ext2-FS: bad htree index in directory #%lu", dir->inode));
+		return NULL;
+	}
+
+	return e;
+}
+
+INLINE long
+dx_block (struct dx_entry *e)
+{
+	return le2cpu32 (e->block) & 0x0fffffffUL;
+}
+
+/*
+ * walk from the root down to the leaf that may hold hash; returns
+ * the logical leaf block number or -1 if the index isn't usable
+ */
+static long
+dx_probe (COOKIE *dir, const char *name, long namelen, ulong *hash, struct dx_frame *frames, long *levels)
+{
+	struct dx_root_info *info;
+	struct dx_entry *e;
+	UNIT *u;
+	long offset;
+	long block;
+	long level;
+
+	u = ext2_read (dir, 0, NULL);
+	if (!u)
+		return -1;
+
+	info = (struct dx_root_info *) (u->data + DX_ROOT_INFO_OFFSET);
+	if (info->reserved_zero
+		|| info->info_length < sizeof (*info)
+		|| info->indirect_levels >= DX_MAX_LEVELS)
+	{
+		DEBUG (("Ext2-FS: dx_probe: unsupported htree root in #%lu", dir->inode));
+		return -1;
+	}
+
+	if (!dx_hash (dir->s, info->hash_version, name, namelen, hash))
+		return -1;
+
+	*levels = info->indirect_levels;
+	offset = DX_ROOT_INFO_OFFSET + info->info_length;
+	block = 0;
+
+	for (level = 0; ; level++)
+	{
+		struct dx_entry *p, *q, *m;
+		long count;
+
+		e = dx_entries (dir, u, offset, &count);
+		if (!e)
+			return -1;
+
+		/* first entry whose hash is greater, minus one */
+		p = e + 1;
+		q = e + count - 1;
+		while (p <= q)
+		{
+			m = p + (q - p) / 2;
+			if (le2cpu32 (m->hash) > *hash)
+				q = m - 1;
+			else
+				p = m + 1;
+		}
+
+		frames[level].block = block;
+		frames[level].offset = offset;
+		frames[level].count = count;
+		frames[level].at = (p - 1) - e;
+
+		block = dx_block (p - 1);
+
+		if (level == *levels)
+			return block;
+
+		u = ext2_read (dir, block, NULL);
+		if (!u)
+			return -1;
+
+		offset = DX_NODE_OFFSET;
+	}
+}
+
+/*
+ * a hash collision may continue in the next leaf; returns the next
+ * leaf block number if so, 0 otherwise and -1 on index errors
+ */
+static long
+dx_next_block (COOKIE *dir, ulong hash, struct dx_frame *frames, long levels)
+{
+	struct dx_entry *e;
+	UNIT *u;
+	long level;
+	long block;
+
+	for (level = levels; level >= 0; level--)
+	{
+		if (frames[level].at + 1 < frames[level].count)
+			break;
+	}
+
+	if (level < 0)
+		return 0;
+
+	frames[level].at++;
+
+	u = ext2_read (dir, frames[level].block, NULL);
+	if (!u)
+		return -1;
+
+	e = (struct dx_entry *) (u->data + frames[level].offset) + frames[level].at;
+	if ((le2cpu32 (e->hash) & ~1UL) != hash)
+		return 0;
+
+	block = dx_block (e);
+
+	while (level < levels)
+	{
+		level++;
+
+		u = ext2_read (dir, block, NULL);
+		if (!u)
+			return -1;
+
+		e = dx_entries (dir, u, DX_NODE_OFFSET, &frames[level].count);
+		if (!e)
+			return -1;
+
+		frames[level].block = block;
+		frames[level].offset = DX_NODE_OFFSET;
+		frames[level].at = 0;
+
+		block = dx_block (e);
+	}
+
+	return block;
+}
+
+/* 1 found, 0 not found, -1 corrupted block */
+static long
+dx_search_leaf (COOKIE *dir, UNIT *u, long block, const char *name, long namelen, ext2_d2 **res_dir)
+{
+	ext2_d2 *de = (ext2_d2 *) u->data;
+	char *upper = (char *) de + EXT2_BLOCK_SIZE (dir->s);
+	ulong offset = block << EXT2_BLOCK_SIZE_BITS (dir->s);
+
+	while ((char *) de < upper)
+	{
+		long de_len;
+
+		if ((char *) de + namelen <= upper
+			&& de->inode && de->name_len == namelen
+			&& !memcmp (name, de->name, namelen))
+		{
+			if (!ext2_check_dir_entry ("dx_search_leaf", dir, de, u, offset))
+				return -1;
+
+			*res_dir = de;
+			return 1;
+		}
+
+		de_len = le2cpu16 (de->rec_len);
+		if (de_len <= 0)
+			return -1;
+
+		offset += de_len;
+		de = (ext2_d2 *) ((char *) de + de_len);
+	}
+
+	return 0;
+}
+
+UNIT *
+ext2_dx_find_entry (COOKIE *dir, const char *name, long namelen, ext2_d2 **res_dir, long *err)
+{
+	struct dx_frame frames[DX_MAX_LEVELS];
+	ulong hash;
+	long levels;
+	long block;
+
+	*res_dir = NULL;
+	*err = EINVAL;
+
+	if (!ext2_dx_dir (dir))
+		return NULL;
+
+	block = dx_probe (dir, name, namelen, &hash, frames, &levels);
+
+	while (block >= 0)
+	{
+		UNIT *u;
+		long r;
+
+		u = ext2_read (dir, block, NULL);
+		if (!u)
+			return NULL;
+
+		r = dx_search_leaf (dir, u, block, name, namelen, res_dir);
+		if (r > 0)
+		{
+			DEBUG (("Ext2-FS: ext2_dx_find_entry: found %s in block %li", name, block));
+
+			*err = E_OK;
+			return u;
+		}
+
+		if (r < 0)
+			return NULL;
+
+		block = dx_next_block (dir, hash, frames, levels);
+		if (block == 0)
+		{
+			*err = ENOENT;
+			return NULL;
+		}
+	}
+
+	return NULL;
+}
+
+UNIT *
+ext2_dx_leaf (COOKIE *dir, const char *name, long namelen, long *blk, long *err)
+{
+	struct dx_frame frames[DX_MAX_LEVELS];
+	ulong hash;
+	long levels;
+	long block;
+	UNIT *u;
+
+	*err = EINVAL;
+
+	if (!ext2_dx_dir (dir))
+		return NULL;
+
+	block = dx_probe (dir, name, namelen, &hash, frames, &levels);
+	if (block < 0)
+		return NULL;
+
+	u = ext2_read (dir, block, NULL);
+	if (u)
+	{
+		*blk = block;
+		*err = E_OK;
+	}
+
+	return u;
+}
@@ -0,0 +1,47 @@
+/*
+ * Filename:     htree.h
+ * Project:      ext2 file system driver for MiNT
+ *
+ * Note:         Please send suggestions, patches or bug reports to
+ *               the MiNT mailing list <freemint-discuss@lists.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+# ifndef _htree_h
+# define _htree_h
+
+# include "global.h"
+
+# include <mint/endian.h>
+
+
+/* is dir a hashed directory we can use the index of?
+ */
+INLINE long
+ext2_dx_dir (COOKIE *dir)
+{
+	return (le2cpu32 (dir->in.i_flags) & EXT2_INDEX_FL)
+		&& (le2cpu32 (dir->s->sbi.s_sb->s_feature_compat) & EXT2_FEATURE_COMPAT_DIR_INDEX);
+}
+
+/* both return NULL with *err == EINVAL if the index can't be used;
+ * the caller has to fall back to a linear scan then
+ */
+UNIT *	ext2_dx_find_entry	(COOKIE *dir, const char *name, long namelen, ext2_d2 **res_dir, long *err);
+UNIT *	ext2_dx_leaf		(COOKIE *dir, const char *name, long namelen, long *blk, long *err);
+
+
+# endif /* _htree_h */
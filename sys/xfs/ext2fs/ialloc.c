@@ -391,6 +391,7 @@ repeat:
 	inode->i_next_alloc_goal = 0;
 	inode->i_prealloc_block = 0;
 	inode->i_prealloc_count = 0;
+	inode->i_alloc_want = 0;
 	
 	cookie_install (inode);
 	inc_inode_version (inode, gdp, mode);
@@ -629,6 +629,125 @@ block_bmap (COOKIE *inode, long block, long nr)
 	return tmp;
 }
 
+/*
+ * map block through the extent tree; *count is set to the number of
+ * physically contiguous blocks from there on (1 for holes)
+ */
+static long
+ext4_ext_bmap (COOKIE *inode, long block, long *count)
+{
+	struct ext4_extent_header *eh = (struct ext4_extent_header *) inode->in.i_block;
+	long depth = -1;
+	
+	*count = 1;
+	
+	for (;;)
+	{
+		long entries = le2cpu16 (eh->eh_entries);
+		long lo, hi;
+		
+		if (le2cpu16 (eh->eh_magic) != EXT4_EXT_MAGIC
+			|| entries > le2cpu16 (eh->eh_max)
+			|| (depth >= 0 && le2cpu16 (eh->eh_depth) != depth - 1)
+			|| le2cpu16 (eh->eh_depth) > EXT4_EXT_MAX_DEPTH)
+		{
+			ALERT (("Ext2-FS: ext4_ext_bmap: bad extent header in inode #%li", inode->inode));
+			return 0;
+		}
+		
+		depth = le2cpu16 (eh->eh_depth);
+		
+		if (depth == 0)
+		{
+			struct ext4_extent *ex = (struct ext4_extent *) (eh + 1);
+			long start, len;
+			
+			/* last extent starting at or before block */
+			lo = 0; hi = entries - 1;
+			while (lo <= hi)
+			{
+				long m = (lo + hi) >> 1;
+				
+				if (le2cpu32 (ex[m].ee_block) > block)
+					hi = m - 1;
+				else
+					lo = m + 1;
+			}
+			
+			if (hi < 0)
+				return 0;
+			
+			ex += hi;
+			
+			start = le2cpu32 (ex->ee_block);
+			len = le2cpu16 (ex->ee_len);
+			
+			/* unwritten extents read as zeros */
+			if (len > EXT4_EXT_INIT_MAX_LEN)
+				return 0;
+			
+			if (block >= start + len)
+				return 0;
+			
+			if (ex->ee_start_hi)
+			{
+				ALERT (("Ext2-FS: ext4_ext_bmap: block beyond 32 bit in inode #%li", inode->inode));
+				return 0;
+			}
+			
+			*count = start + len - block;
+			return le2cpu32 (ex->ee_start_lo) + (block - start);
+		}
+		else
+		{
+			struct ext4_extent_idx *ix = (struct ext4_extent_idx *) (eh + 1);
+			UNIT *u;
+			
+			lo = 0; hi = entries - 1;
+			while (lo <= hi)
+			{
+				long m = (lo + hi) >> 1;
+				
+				if (le2cpu32 (ix[m].ei_block) > block)
+					hi = m - 1;
+				else
+					lo = m + 1;
+			}
+			
+			if (hi < 0)
+				return 0;
+			
+			ix += hi;
+			
+			if (ix->ei_leaf_hi)
+			{
+				ALERT (("Ext2-FS: ext4_ext_bmap: block beyond 32 bit in inode #%li", inode->inode));
+				return 0;
+			}
+			
+			u = bio.read (inode->s->di, le2cpu32 (ix->ei_leaf_lo), EXT2_BLOCK_SIZE (inode->s));
+			if (!u)
+				return 0;
+			
+			eh = (struct ext4_extent_header *) u->data;
+		}
+	}
+}
+
+/*
+ * like ext2_bmap, but also returns how many blocks from block on are
+ * physically contiguous, as far as that is known without extra reads
+ */
+long
+ext2_bmap_len (COOKIE *inode, long block, long *count)
+{
+	if (le2cpu32 (inode->in.i_flags) & EXT4_EXTENTS_FL)
+		return ext4_ext_bmap (inode, block, count);
+	
+	*count = 1;
+	return ext2_bmap (inode, block);
+}
+
 long
 ext2_bmap (COOKIE *inode, long block)
 {
@@ -644,6 +763,13 @@ ext2_bmap (COOKIE *inode, long block)
 		return 0;
 	}
 	
+	if (le2cpu32 (inode->in.i_flags) & EXT4_EXTENTS_FL)
+	{
+		long count;
+		
+		return ext4_ext_bmap (inode, block, &count);
+	}
+	
 	if (block >= EXT2_NDIR_BLOCKS + addr_per_block +
 		(1UL << (addr_per_block_bits << 1)) +
 		((1UL << (addr_per_block_bits << 1)) << addr_per_block_bits))
@@ -771,17 +897,17 @@ ext2_alloc_block (COOKIE *inode, ulong goal, long *err)
 		
 		if (EXT2_ISREG (le2cpu16 (inode->in.i_mode)))
 		{
-			result = ext2_new_block (inode, goal, 
+			result = ext2_new_block (inode, goal, inode->i_alloc_want,
 					&(inode->i_prealloc_count),
 					&(inode->i_prealloc_block), err);
 		}
 		else
 		{
-			result = ext2_new_block (inode, goal, 0, 0, err);
+			result = ext2_new_block (inode, goal, 1, 0, 0, err);
 		}
 	}
 # else
-	result = ext2_new_block (inode, goal, NULL, NULL, err);
+	result = ext2_new_block (inode, goal, inode->i_alloc_want, NULL, NULL, err);
 # endif
 	
 	DEBUG (("ext2_alloc_block: leave (result = %ld, *err = %li)", result, *err));
@@ -74,6 +74,7 @@ void	dump_inode_cache	(char *buf, long bufsize);
 void	ext2_delete_inode	(COOKIE *inode);
 
 long	ext2_bmap		(COOKIE *inode, long block);
+long	ext2_bmap_len		(COOKIE *inode, long block, long *count);
 UNIT *	ext2_read		(COOKIE *inode, long block, long *err);
 
 void	ext2_discard_prealloc	(COOKIE *inode);
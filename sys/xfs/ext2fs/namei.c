@@ -30,6 +30,7 @@
 
 # include <mint/endian.h>
 
+# include "htree.h"
 # include "inode.h"
 # include "super.h"
 
@@ -387,8 +388,24 @@ ext2_search_entry (COOKIE *dir, const char *name, long namelen)
 		}
 	}
 
-	/* 3. search on disk
+	/* 3. search on disk, through the hash index if there is one
 	 */
+	if (ext2_dx_dir (dir))
+	{
+		UNIT *u;
+		ext2_d2 *de;
+		long err;
+
+		u = ext2_dx_find_entry (dir, name, namelen, &de, &err);
+		if (u)
+			return d_get_dir (dir, le2cpu32 (de->inode), de->name, de->name_len);
+
+		if (err == ENOENT)
+			goto failure;
+
+		/* index not usable, scan linear */
+	}
+
 	for (block = 0, offset = 0; offset < size; block++)
 	{
 		UNIT *u;
@@ -544,6 +561,16 @@ ext2_find_entry (COOKIE *dir, const char *name, long namelen, ext2_d2 **res_dir)
 	s = super [dir->dev];
 	size = le2cpu32 (dir->in.i_size);
 
+	if (ext2_dx_dir (dir))
+	{
+		UNIT *u;
+		long err;
+
+		u = ext2_dx_find_entry (dir, name, namelen, res_dir, &err);
+		if (u || err == ENOENT)
+			return u;
+	}
+
 	for (block = 0, offset = 0; offset < size; block++)
 	{
 		UNIT *u;
@@ -593,6 +620,60 @@ failure:
 	return NULL;
 }
 
+/*
+ * try to place a new entry into the directory block u;
+ * returns the entry or NULL with *err set (ENOSPC if the block is full)
+ */
+static ext2_d2 *
+ext2_add_to_block (COOKIE *dir, UNIT *u, ulong offset, const char *name, long namelen, long *err)
+{
+	ext2_d2 *de = (ext2_d2 *) u->data;
+	char *upper = (char *) de + EXT2_BLOCK_SIZE (dir->s);
+	ushort rec_len = EXT2_DIR_REC_LEN (namelen);
+
+	while ((char *) de < upper)
+	{
+		if (!ext2_check_dir_entry ("ext2_add_to_block", dir, de, u, offset))
+		{
+			*err = ENOENT;
+			return NULL;
+		}
+
+		if (ext2_match (namelen, name, de))
+		{
+			*err = EEXIST;
+			return NULL;
+		}
+
+		if ((de->inode == 0 && le2cpu16 (de->rec_len) >= rec_len)
+			|| (le2cpu16 (de->rec_len) >= EXT2_DIR_REC_LEN (de->name_len) + rec_len))
+		{
+			if (de->inode)
+			{
+				ext2_d2 *de1 = (ext2_d2 *) ((char *) de + EXT2_DIR_REC_LEN (de->name_len));
+
+				de1->rec_len = cpu2le16 (le2cpu16 (de->rec_len) - EXT2_DIR_REC_LEN (de->name_len));
+				de->rec_len = cpu2le16 (EXT2_DIR_REC_LEN (de->name_len));
+				de = de1;
+			}
+
+			de->inode = 0;
+			de->name_len = namelen;
+			de->file_type = 0;
+			memcpy (de->name, name, namelen);
+
+			*err = E_OK;
+			return de;
+		}
+
+		offset += le2cpu16 (de->rec_len);
+		de = (ext2_d2 *) ((char *) de + le2cpu16 (de->rec_len));
+	}
+
+	*err = ENOSPC;
+	return NULL;
+}
+
 /*
  *	ext2_add_entry()
  *
@@ -612,6 +693,7 @@ ext2_add_entry (COOKIE *dir, const char *name, long namelen, ext2_d2 **res_dir,
 
 	ulong offset;
 	ushort rec_len;
+	long dx;
 
 	*res_dir = NULL;
 
@@ -644,6 +726,40 @@ ext2_add_entry (COOKIE *dir, const char *name, long namelen, ext2_d2 **res_dir,
 		return NULL;
 	}
 
+	/* hashed directory: the entry belongs into the leaf the index
+	 * points to; if that one is full the index is given up below
+	 * (splitting leaves isn't supported) and e2fsck -D can rebuild it
+	 */
+	dx = ext2_dx_dir (dir);
+	if (dx)
+	{
+		long block;
+
+		u = ext2_dx_leaf (dir, name, namelen, &block, err);
+		if (u)
+		{
+			offset = (ulong) block << EXT2_BLOCK_SIZE_BITS (s);
+
+			de = ext2_add_to_block (dir, u, offset, name, namelen, err);
+			if (de)
+			{
+				dir->in.i_mtime = dir->in.i_ctime = cpu2le32 (CURRENT_TIME);
+				dir->in.i_version = cpu2le32 (++event);
+				mark_inode_dirty (dir);
+
+				bio_MARK_MODIFIED (&bio, u);
+
+				clear_lastlookup (dir);
+
+				*res_dir = de;
+				return u;
+			}
+
+			if (*err != ENOSPC)
+				return NULL;
+		}
+	}
+
 	u = ext2_read (dir, 0, err);
 	if (!u)
 	{
@@ -680,7 +796,7 @@ ext2_add_entry (COOKIE *dir, const char *name, long namelen, ext2_d2 **res_dir,
 				de->inode = 0;
 				de->rec_len = cpu2le16 (EXT2_BLOCK_SIZE (s));
 				dir->in.i_size = cpu2le32 (offset + EXT2_BLOCK_SIZE (s));
-				dir->in.i_flags = cpu2le32 (le2cpu32 (dir->in.i_flags) & ~EXT2_BTREE_FL);
+				dir->in.i_flags = cpu2le32 (le2cpu32 (dir->in.i_flags) & ~EXT2_INDEX_FL);
 				mark_inode_dirty (dir);
 			}
 			else
@@ -721,7 +837,9 @@ ext2_add_entry (COOKIE *dir, const char *name, long namelen, ext2_d2 **res_dir,
 			memcpy (de->name, name, namelen);
 
 			dir->in.i_mtime = dir->in.i_ctime = cpu2le32 (CURRENT_TIME);
-			dir->in.i_flags = cpu2le32 (le2cpu32 (dir->in.i_flags) & ~EXT2_BTREE_FL);
+			/* not in the leaf the index points to */
+			if (dx)
+				dir->in.i_flags = cpu2le32 (le2cpu32 (dir->in.i_flags) & ~EXT2_INDEX_FL);
 			dir->in.i_version = cpu2le32 (++event);
 			mark_inode_dirty (dir);
 
@@ -68,6 +68,12 @@ ext2_setup_super (SI *s)
 		s->s_flags |= MS_RDONLY;
 	}
 	
+	if (le2cpu32 (sb->s_feature_incompat) & EXT2_FEATURE_INCOMPAT_RO_SUPP)
+	{
+		ALERT (("Ext2-FS [%c]: ext4 features (extents) supported read only, forcing read only mode", s->dev+'A'));
+		s->s_flags |= MS_RDONLY;
+	}
+	
 	if (!(s->s_flags & MS_RDONLY))
 	{
 		if (!(le2cpu16 (sb->s_state) & EXT2_VALID_FS))
@@ -252,7 +258,8 @@ read_ext2_sb_info (ushort drv)
 		if (le2cpu32 (sb->s_rev_level) > EXT2_GOOD_OLD_REV)
 		{
 					
-			if (le2cpu32 (sb->s_feature_incompat) & ~EXT2_FEATURE_INCOMPAT_SUPP)
+			if (le2cpu32 (sb->s_feature_incompat)
+				& ~(EXT2_FEATURE_INCOMPAT_SUPP | EXT2_FEATURE_INCOMPAT_RO_SUPP))
 			{
 				ALERT (("Ext2-FS [%c]: couldn't mount because of "
 					"unsupported optional features.", drv+'A'));
@@ -261,6 +268,7 @@ read_ext2_sb_info (ushort drv)
 			}
 			
 			if (!BIO_WP_CHECK (di) &&
+				!(le2cpu32 (sb->s_feature_incompat) & EXT2_FEATURE_INCOMPAT_RO_SUPP) &&
 				(le2cpu32 (sb->s_feature_ro_compat) & ~EXT2_FEATURE_RO_COMPAT_SUPP))
 			{
 				ALERT (("Ext2-FS [%c]: couldn't mount RDWR because of "
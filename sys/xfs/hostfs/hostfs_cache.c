@@ -0,0 +1,338 @@
+/*
+ * The Host OS filesystem access driver - attribute cache.
+ *
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/*
+ * Every host call is a trap out of the emulated CPU, so attributes
+ * and failed lookups are cached here.
+ *
+ * The host may reuse the index of a cookie once its last reference
+ * is released. A cache entry therefore keeps its own host reference
+ * (dupcookie). That costs a host call, so an entry only takes one
+ * on the second miss of the same key; files stat'ed only once don't
+ * pay for it.
+ *
+ * Entries expire after HOSTFS_CACHE_TTL to catch changes made on the
+ * host side. Changes made through this driver invalidate them at once:
+ * per file for attribute changes and writes, globally for everything
+ * that changes a directory.
+ *
+ * Successful lookups and directory listings are not cached. Each of
+ * them hands the kernel a cookie with a fresh host reference, which
+ * the kernel releases later. Serving one from the cache would still
+ * need a dupcookie call per name, and that call costs as much as the
+ * lookup or readdir it replaces. The readdir position is also kept on
+ * the host side, in the DIR handle of the emulator.
+ */
+
+#include "global.h"
+#include "hostfs_cache.h"
+#include "hostfs_nfapi.h"
+
+#include "arch/timer.h"
+
+
+#define HOSTFS_CACHE_TTL	200	/* 1 s in 200 Hz ticks */
+
+#define HC_ATTR		64	/* attribute entries, power of 2 */
+#define HC_NOENT	64	/* failed lookup entries, power of 2 */
+#define HC_NAMELEN	32	/* longer names are not cached */
+
+/* entry states */
+#define HC_FREE		0
+#define HC_SEEN		1	/* missed once, no host reference */
+#define HC_HELD		2	/* ref is a host reference */
+
+/* valid attributes */
+#define HC_XATTR	0x1
+#define HC_STAT		0x2
+
+struct hc_attr
+{
+	ushort	dev;		/* key */
+	ushort	state;
+	long	index;
+	fcookie	ref;		/* our reference if HC_HELD */
+	ushort	valid;
+	ushort	res;
+	ulong	gen;
+	long	stamp;
+	XATTR	xattr;
+	STAT	stat;
+};
+
+struct hc_noent
+{
+	ushort	dev;		/* key: directory and name */
+	ushort	state;
+	long	index;
+	char	name[HC_NAMELEN];
+	fcookie	ref;		/* our reference on the directory if HC_HELD */
+	ulong	gen;
+	long	stamp;
+};
+
+static struct hc_attr attr_tab[HC_ATTR];
+static struct hc_noent noent_tab[HC_NOENT];
+
+static ulong hostfs_gen = 1;
+
+
+static ulong
+hc_hash (fcookie *fc)
+{
+	ulong h = (ulong) fc->index;
+
+	return (h ^ (h >> 7) ^ (h >> 15) ^ fc->dev);
+}
+
+static int
+hc_fresh (ulong gen, long stamp)
+{
+	return (gen == hostfs_gen) && ((*_hz_200 - stamp) < HOSTFS_CACHE_TTL);
+}
+
+/*
+ * common path for a miss; returns the entry if it holds
+ * a host reference for fc, NULL otherwise
+ */
+static struct hc_attr *
+hc_attr_miss (fcookie *fc)
+{
+	struct hc_attr *hc = &attr_tab[hc_hash (fc) & (HC_ATTR - 1)];
+
+	if (hc->state != HC_FREE && hc->dev == fc->dev && hc->index == fc->index)
+	{
+		if (hc->state == HC_HELD)
+		{
+			if (!hc_fresh (hc->gen, hc->stamp))
+				hc->valid = 0;
+
+			return hc;
+		}
+
+		/* second miss, take a reference */
+		if (nf_call(HOSTFS(XFS_DUPCOOKIE), &hc->ref, fc) == E_OK)
+		{
+			hc->state = HC_HELD;
+			hc->valid = 0;
+			return hc;
+		}
+
+		hc->state = HC_FREE;
+		return NULL;
+	}
+
+	if (hc->state == HC_HELD)
+		nf_call(HOSTFS(XFS_RELEASE), &hc->ref);
+
+	hc->dev = fc->dev;
+	hc->index = fc->index;
+	hc->state = HC_SEEN;
+	hc->valid = 0;
+
+	return NULL;
+}
+
+static struct hc_attr *
+hc_attr_hit (fcookie *fc, ushort what)
+{
+	struct hc_attr *hc = &attr_tab[hc_hash (fc) & (HC_ATTR - 1)];
+
+	if (hc->state == HC_HELD && (hc->valid & what)
+		&& hc->dev == fc->dev && hc->index == fc->index
+		&& hc_fresh (hc->gen, hc->stamp))
+	{
+		return hc;
+	}
+
+	return NULL;
+}
+
+static void
+hc_attr_stamp (struct hc_attr *hc, ushort what)
+{
+	if (!hc->valid)
+	{
+		hc->gen = hostfs_gen;
+		hc->stamp = *_hz_200;
+	}
+
+	hc->valid |= what;
+}
+
+long
+hostfs_cache_xattr (fcookie *fc, XATTR *xattr)
+{
+	struct hc_attr *hc = hc_attr_hit (fc, HC_XATTR);
+
+	if (!hc)
+		return 0;
+
+	*xattr = hc->xattr;
+	return 1;
+}
+
+void
+hostfs_cache_set_xattr (fcookie *fc, const XATTR *xattr)
+{
+	struct hc_attr *hc = hc_attr_miss (fc);
+
+	if (hc)
+	{
+		hc->xattr = *xattr;
+		hc_attr_stamp (hc, HC_XATTR);
+	}
+}
+
+long
+hostfs_cache_stat (fcookie *fc, STAT *stat)
+{
+	struct hc_attr *hc = hc_attr_hit (fc, HC_STAT);
+
+	if (!hc)
+		return 0;
+
+	*stat = hc->stat;
+	return 1;
+}
+
+void
+hostfs_cache_set_stat (fcookie *fc, const STAT *stat)
+{
+	struct hc_attr *hc = hc_attr_miss (fc);
+
+	if (hc)
+	{
+		hc->stat = *stat;
+		hc_attr_stamp (hc, HC_STAT);
+	}
+}
+
+static struct hc_noent *
+hc_noent_slot (fcookie *dir, const char *name)
+{
+	ulong h = hc_hash (dir);
+
+	while (*name)
+		h = h * 31 + (uchar) *name++;
+
+	return &noent_tab[h & (HC_NOENT - 1)];
+}
+
+long
+hostfs_cache_noent (fcookie *dir, const char *name)
+{
+	struct hc_noent *hc;
+
+	if (strlen (name) >= HC_NAMELEN)
+		return 0;
+
+	hc = hc_noent_slot (dir, name);
+
+	return hc->state == HC_HELD
+		&& hc->dev == dir->dev && hc->index == dir->index
+		&& hc_fresh (hc->gen, hc->stamp)
+		&& !strcmp (hc->name, name);
+}
+
+void
+hostfs_cache_set_noent (fcookie *dir, const char *name)
+{
+	struct hc_noent *hc;
+
+	if (strlen (name) >= HC_NAMELEN)
+		return;
+
+	hc = hc_noent_slot (dir, name);
+
+	if (hc->state != HC_FREE
+		&& hc->dev == dir->dev && hc->index == dir->index
+		&& !strcmp (hc->name, name))
+	{
+		/* second miss, take a reference */
+		if (hc->state == HC_SEEN)
+		{
+			if (nf_call(HOSTFS(XFS_DUPCOOKIE), &hc->ref, dir) != E_OK)
+			{
+				hc->state = HC_FREE;
+				return;
+			}
+
+			hc->state = HC_HELD;
+		}
+
+		hc->gen = hostfs_gen;
+		hc->stamp = *_hz_200;
+		return;
+	}
+
+	if (hc->state == HC_HELD)
+		nf_call(HOSTFS(XFS_RELEASE), &hc->ref);
+
+	hc->dev = dir->dev;
+	hc->index = dir->index;
+	strcpy (hc->name, name);
+	hc->state = HC_SEEN;
+}
+
+/* attributes of fc changed */
+void
+hostfs_cache_drop (fcookie *fc)
+{
+	struct hc_attr *hc = &attr_tab[hc_hash (fc) & (HC_ATTR - 1)];
+
+	if (hc->dev == fc->dev && hc->index == fc->index)
+		hc->valid = 0;
+}
+
+/* a directory changed, invalidate everything */
+void
+hostfs_cache_invalidate (void)
+{
+	hostfs_gen++;
+}
+
+/* release all host references (unmount, media change) */
+void
+hostfs_cache_flush (void)
+{
+	int i;
+
+	for (i = 0; i < HC_ATTR; i++)
+	{
+		if (attr_tab[i].state == HC_HELD)
+			nf_call(HOSTFS(XFS_RELEASE), &attr_tab[i].ref);
+
+		attr_tab[i].state = HC_FREE;
+		attr_tab[i].valid = 0;
+	}
+
+	for (i = 0; i < HC_NOENT; i++)
+	{
+		if (noent_tab[i].state == HC_HELD)
+			nf_call(HOSTFS(XFS_RELEASE), &noent_tab[i].ref);
+
+		noent_tab[i].state = HC_FREE;
+	}
+
+	hostfs_gen++;
+}
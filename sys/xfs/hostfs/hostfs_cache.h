@@ -0,0 +1,48 @@
+/*
+ * The Host OS filesystem access driver - attribute cache definitions.
+ *
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _hostfs_cache_h_
+#define _hostfs_cache_h_
+
+# include "mint/mint.h"
+# include "mint/file.h"
+# include "mint/stat.h"
+
+/*
+ * client side cache of file attributes and failed lookups
+ *
+ * the lookup functions return 1 on a hit; entries are valid for
+ * HOSTFS_CACHE_TTL ticks and until the next invalidate
+ */
+
+long	hostfs_cache_xattr	(fcookie *fc, XATTR *xattr);
+void	hostfs_cache_set_xattr	(fcookie *fc, const XATTR *xattr);
+long	hostfs_cache_stat	(fcookie *fc, STAT *stat);
+void	hostfs_cache_set_stat	(fcookie *fc, const STAT *stat);
+
+long	hostfs_cache_noent	(fcookie *dir, const char *name);
+void	hostfs_cache_set_noent	(fcookie *dir, const char *name);
+
+void	hostfs_cache_drop	(fcookie *fc);
+void	hostfs_cache_invalidate	(void);
+void	hostfs_cache_flush	(void);
+
+#endif /* _hostfs_cache_h_ */
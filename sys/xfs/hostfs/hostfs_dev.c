@@ -29,6 +29,7 @@
 #include "global.h"
 #include "hostfs_xfs.h"
 #include "hostfs_dev.h"
+#include "hostfs_cache.h"
 #include "hostfs_nfapi.h"
 #if __KERNEL__ == 1
 #include "filesys.h"
@@ -55,10 +56,13 @@ void _cdecl hostfs_fs_dev_unselect (FILEPTR *f, long proc, int mode);
 
 
 long _cdecl hostfs_fs_dev_open     (FILEPTR *f) {
+	if (f->flags & O_TRUNC)
+		hostfs_cache_drop(&f->fc);
 	return nf_call(HOSTFS(DEV_OPEN), f);
 }
 
 long _cdecl hostfs_fs_dev_write    (FILEPTR *f, const char *buf, long bytes) {
+	hostfs_cache_drop(&f->fc);
 	return nf_call(HOSTFS(DEV_WRITE), f, buf, bytes);
 }
 
@@ -210,10 +214,14 @@ long _cdecl hostfs_fs_dev_ioctl    (FILEPTR *f, int mode, void *buf) {
 	}
 #endif /* ARAnyM_MetaDOS */
 		
+	/* FTRUNCATE, FUTIME, ... */
+	hostfs_cache_drop(&f->fc);
 	return nf_call(HOSTFS(DEV_IOCTL), f, (long)mode, buf);
 }
 
 long _cdecl hostfs_fs_dev_datime   (FILEPTR *f, ushort *timeptr, int rwflag) {
+	if (rwflag)
+		hostfs_cache_drop(&f->fc);
 	return nf_call(HOSTFS(DEV_DATIME), f, timeptr, (long)rwflag);
 }
 
@@ -252,6 +260,8 @@ long _cdecl hostfs_fs_dev_close    (FILEPTR *f, int pid) {
 		}
 	}
 #endif /* ARAnyM_MetaDOS */
+	/* the host may update the times on close */
+	hostfs_cache_drop(&f->fc);
 	return nf_call(HOSTFS(DEV_CLOSE), f, (long)pid);
 }
 
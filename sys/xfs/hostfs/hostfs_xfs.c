@@ -28,6 +28,7 @@
 #include "global.h"
 
 #include "hostfs_xfs.h"
+#include "hostfs_cache.h"
 #include "hostfs_nfapi.h"
 
 #include "mint/arch/nf_ops.h"
@@ -58,13 +59,23 @@ long     _cdecl hostfs_fs_root       (int drv, fcookie *fc)
 static
 long     _cdecl hostfs_fs_lookup     (fcookie *dir, const char *name, fcookie *fc)
 {
-	return nf_call(HOSTFS(XFS_LOOKUP), dir, name, fc);
+	long r;
+
+	if (hostfs_cache_noent(dir, name))
+		return ENOENT;
+
+	r = nf_call(HOSTFS(XFS_LOOKUP), dir, name, fc);
+	if (r == ENOENT)
+		hostfs_cache_set_noent(dir, name);
+
+	return r;
 }
 
 static
 long     _cdecl hostfs_fs_creat      (fcookie *dir, const char *name,
 								   unsigned int mode, int attrib, fcookie *fc)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_CREATE), dir, name, (long)mode, (long)attrib, fc);
 }
 
@@ -77,42 +88,57 @@ DEVDRV * _cdecl hostfs_fs_getdev     (fcookie *fc, long *devspecial)
 static
 long     _cdecl hostfs_fs_getxattr   (fcookie *file, XATTR *xattr)
 {
-	return nf_call(HOSTFS(XFS_GETXATTR), file, xattr);
+	long r;
+
+	if (hostfs_cache_xattr(file, xattr))
+		return E_OK;
+
+	r = nf_call(HOSTFS(XFS_GETXATTR), file, xattr);
+	if (r == E_OK)
+		hostfs_cache_set_xattr(file, xattr);
+
+	return r;
 }
 
 static
 long     _cdecl hostfs_fs_chattr     (fcookie *file, int attr)
 {
+	hostfs_cache_drop(file);
 	return nf_call(HOSTFS(XFS_CHATTR), file, (long)attr);
 }
 
 static
 long     _cdecl hostfs_fs_chown      (fcookie *file, int uid, int gid)
 {
+	hostfs_cache_drop(file);
 	return nf_call(HOSTFS(XFS_CHOWN), file, (long)uid, (long)gid);
 }
 
 static
 long     _cdecl hostfs_fs_chmode     (fcookie *file, unsigned int mode)
 {
+	hostfs_cache_drop(file);
 	return nf_call(HOSTFS(XFS_CHMOD), file, (long)mode);
 }
 
 static
 long     _cdecl hostfs_fs_mkdir      (fcookie *dir, const char *name, unsigned int mode)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_MKDIR), dir, name, (long)mode);
 }
 
 static
 long     _cdecl hostfs_fs_rmdir      (fcookie *dir, const char *name)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_RMDIR), dir, name);
 }
 
 static
 long     _cdecl hostfs_fs_remove     (fcookie *dir, const char *name)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_REMOVE), dir, name);
 }
 
@@ -127,6 +153,7 @@ static
 long     _cdecl hostfs_fs_rename     (fcookie *olddir, char *oldname,
 								   fcookie *newdir, const char *newname)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_RENAME), olddir, oldname, newdir, newname);
 }
 
@@ -184,6 +211,7 @@ static
 long     _cdecl hostfs_fs_symlink    (fcookie *dir, const char *name,
 								   const char *to)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_SYMLINK), dir, name, to);
 }
 
@@ -198,6 +226,7 @@ long     _cdecl hostfs_fs_hardlink   (fcookie *fromdir,
 								   const char *fromname,
 								   fcookie *todir, const char *toname)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_HARDLINK), fromdir, fromname, todir, toname);
 }
 
@@ -211,7 +240,13 @@ long     _cdecl hostfs_fs_fscntl     (fcookie *dir, const char *name,
 static
 long     _cdecl hostfs_fs_dskchng    (int drv, int mode)
 {
-	return nf_call(HOSTFS(XFS_DSKCHNG), (long)drv, (long)mode);
+	long r;
+
+	r = nf_call(HOSTFS(XFS_DSKCHNG), (long)drv, (long)mode);
+	if (r)
+		hostfs_cache_flush();
+
+	return r;
 }
 
 static
@@ -235,19 +270,30 @@ long     _cdecl hostfs_fs_sync       (void)
 static
 long     _cdecl hostfs_fs_mknod      (fcookie *dir, const char *name, ulong mode)
 {
+	hostfs_cache_invalidate();
 	return nf_call(HOSTFS(XFS_MKNOD), dir, name, mode);
 }
 
 static
 long     _cdecl hostfs_fs_unmount    (int drv)
 {
+	hostfs_cache_flush();
 	return nf_call(HOSTFS(XFS_UNMOUNT), (long)drv);
 }
 
 static
 long     _cdecl hostfs_fs_stat64     (fcookie *file, STAT *xattr)
 {
-	return nf_call(HOSTFS(XFS_STAT64), file, xattr);
+	long r;
+
+	if (hostfs_cache_stat(file, xattr))
+		return E_OK;
+
+	r = nf_call(HOSTFS(XFS_STAT64), file, xattr);
+	if (r == E_OK)
+		hostfs_cache_set_stat(file, xattr);
+
+	return r;
 }
 
 /*
@@ -12,63 +12,92 @@
 # include "bitmap.h"
 
 
-static long	alloc_bit	(ushort *buf, long num, long last);
-static long	free_bit	(ushort *buf, long bitnum);
+# define BITS_PER_BLOCK	(BLOCK_SIZE * 8)
+# define WORDS_PER_BLOCK	(BLOCK_SIZE / 2)
+
+static long	find_zero	(ushort *buf, ushort *bcount, long from, long to);
+static long	alloc_bit	(ushort *buf, ushort *bcount, long num, long *last);
+static long	free_bit	(ushort *buf, ushort *bcount, long bitnum);
 
 INLINE long	bitcount	(register ushort wrd);
 
 
-/* This routine is used for allocating both free inodes and free zones 
- * Search a bitmap for a zero , then return its bit number and change it
- * to a one ...... but without exceeding 'num' bits 
+/* Search the bits from 'from' up to 'to' (exclusive) for a zero,
+ * bitmap blocks without free bits are skipped
  */
 
 static long
-alloc_bit (ushort *buf, register long num, register long last)
+find_zero (ushort *buf, ushort *bcount, long from, long to)
 {
-	register const long end = num >> 4;
-	register long i;
-	register long j;
-	register long k;
-	
-	k = 1;
-	for (i = last >> 4; (i <= end) && (buf[i] == 65535U); i++);
-	
-	if (i > end)
-	{
-		return 0;
-	}
-	else
+	while (from < to)
 	{
-		for (j = 0; j < 16; j++)
+		register long b = from / BITS_PER_BLOCK;
+		register long end = (b + 1) * BITS_PER_BLOCK;
+		
+		if (end > to)
+			end = to;
+		
+		if (bcount[b])
 		{
-			if (!(buf[i] & k))
+			register long i;
+			
+			for (i = from >> 4; (i << 4) < end; i++)
 			{
-				long free;
-				
-				free = i * 16 + j;
-				if (free >= num)
+				if (buf[i] != 65535U)
 				{
-					return 0;
+					register long j;
+					
+					for (j = 0; j < 16; j++)
+					{
+						register long bit = (i << 4) + j;
+						
+						if (!(buf[i] & (1 << j)) && bit >= from && bit < end)
+							return bit;
+					}
 				}
-				
-				buf[i] |= k;
-				
-				return free;
 			}
-			
-			k <<= 1;
 		}
+		
+		from = end;
 	}
 	
-	ALERT (("Minix-FS: alloc_bit: This can't happen !"));
-	return 0;
+	return -1;
+}
+
+/* This routine is used for allocating both free inodes and free zones 
+ * Search a bitmap for a zero , then return its bit number and change it
+ * to a one ...... but without exceeding 'num' bits 
+ * 
+ * The search starts behind the last allocated bit (next fit) and
+ * wraps around once.
+ */
+
+static long
+alloc_bit (ushort *buf, ushort *bcount, long num, long *last)
+{
+	long free;
+	
+	if (*last >= num)
+		*last = 0;
+	
+	free = find_zero (buf, bcount, *last, num);
+	if (free < 0)
+		free = find_zero (buf, bcount, 0, *last);
+	
+	if (free <= 0)
+		return 0;
+	
+	buf[free >> 4] |= 1 << (free & 15);
+	bcount[free / BITS_PER_BLOCK]--;
+	
+	*last = free + 1;
+	return free;
 }
 
 /* zero a bit of a bitmap return 0 if already zero */
 
 static long
-free_bit (ushort *buf, register long bitnum)
+free_bit (ushort *buf, ushort *bcount, register long bitnum)
 {
 	register long index = bitnum >> 4;
 	register ushort bit = 1 << (bitnum & 15);
@@ -77,6 +106,9 @@ free_bit (ushort *buf, register long bitnum)
 	ret = buf[index] & bit;
 	buf[index] &= ~bit;
 	
+	if (ret)
+		bcount[bitnum / BITS_PER_BLOCK]++;
+	
 	return ret;
 }
 
@@ -115,24 +147,59 @@ count_bits (ushort *buf, long num)
 }
 
 
+/* count the free bits of one bitmap, per bitmap block and in total */
+
+static long
+init_counts (ushort *buf, ushort *bcount, long num)
+{
+	long total = 0;
+	long b;
+	
+	for (b = 0; b * BITS_PER_BLOCK < num; b++)
+	{
+		register long n = num - b * BITS_PER_BLOCK;
+		
+		if (n > BITS_PER_BLOCK)
+			n = BITS_PER_BLOCK;
+		
+		bcount[b] = n - count_bits (buf + b * WORDS_PER_BLOCK, n);
+		total += bcount[b];
+	}
+	
+	return total;
+}
+
+void
+init_bitmaps (SI *psblk)
+{
+	psblk->ifree = init_counts (psblk->ibitmap, psblk->ibcount, psblk->sblk->s_ninodes + 1L);
+	psblk->zfree = init_counts (psblk->zbitmap, psblk->zbcount, psblk->sblk->s_zones - psblk->sblk->s_firstdatazn + 1);
+	
+	psblk->ilast = 0;
+	psblk->zlast = 0;
+}
+
+
 long
 alloc_zone (ushort drive)
 {
 	SI *psblk = super_ptr[drive];
 	long save;
 	
-	save = alloc_bit (psblk->zbitmap, psblk->sblk->s_zones - psblk->sblk->s_firstdatazn + 1, psblk->zlast);
-	if (!save)
+	if (!psblk->zfree)
 	{
 		return 0;
 	}
 	
-	psblk->zdirty = 1; /* Mark zone bitmap as dirty */
-	if (save > psblk->zlast)
+	save = alloc_bit (psblk->zbitmap, psblk->zbcount, psblk->sblk->s_zones - psblk->sblk->s_firstdatazn + 1, &psblk->zlast);
+	if (!save)
 	{
-		psblk->zlast = save;
+		return 0;
 	}
 	
+	psblk->zdirty = 1; /* Mark zone bitmap as dirty */
+	psblk->zfree--;
+	
 	return (save + psblk->sblk->s_firstdatazn - 1);
 }
 
@@ -145,19 +212,17 @@ free_zone (ushort drive, long zone)
 	long ret;
 	
 	save = zone + 1 - psblk->sblk->s_firstdatazn;
-	ret = free_bit (psblk->zbitmap, save);
+	ret = free_bit (psblk->zbitmap, psblk->zbcount, save);
 	
 	/* Mark zone bitmap as dirty */
 	psblk->zdirty = 1;
-	if (save < psblk->zlast)
-	{
-		psblk->zlast = save;
-	}
 	
 	if (!ret)
 	{
 		ALERT (("Minix-FS (%c): zone %ld freeing already free zone !", drive+'A', zone));
 	}
+	else
+		psblk->zfree++;
 	
 	return ret;
 }
@@ -169,7 +234,12 @@ alloc_inode (ushort drive)
 	SI *psblk = super_ptr[drive];
 	ushort save;	
 	
-	save = alloc_bit (psblk->ibitmap, psblk->sblk->s_ninodes + 1L, psblk->ilast);
+	if (!psblk->ifree)
+	{
+		return 0;
+	}
+	
+	save = alloc_bit (psblk->ibitmap, psblk->ibcount, psblk->sblk->s_ninodes + 1L, &psblk->ilast);
 	if (!save)
 	{
 		return 0;
@@ -177,10 +247,7 @@ alloc_inode (ushort drive)
 	
 	/* Mark inode bitmap as dirty */
 	psblk->idirty = 1;
-	if (save > psblk->ilast)
-	{
-		psblk->ilast = save;
-	}
+	psblk->ifree--;
 	
 	return save;
 }
@@ -192,11 +259,7 @@ free_inode (ushort drive, ushort inum)
 	SI *psblk = super_ptr[drive];
 	long ret;
 	
-	ret = free_bit (psblk->ibitmap, inum);
-	if (inum < psblk->ilast)
-	{
-		psblk->ilast = inum;
-	}
+	ret = free_bit (psblk->ibitmap, psblk->ibcount, inum);
 	
 	/* Mark inode bitmap as dirty */
 	psblk->idirty = 1;
@@ -205,7 +268,8 @@ free_inode (ushort drive, ushort inum)
 	{
 		ALERT (("Minix-FS (%c): inode %d, freeing already free inode!", drive+'A', inum));
 	}
+	else
+		psblk->ifree++;
 	
 	return ret;
 }
-
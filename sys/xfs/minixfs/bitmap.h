@@ -16,6 +16,7 @@
 
 
 long	count_bits	(ushort *buf, long num);
+void	init_bitmaps	(SI *psblk);
 
 long	alloc_zone	(ushort drive);
 long	free_zone	(ushort drive, long zone);
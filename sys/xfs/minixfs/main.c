@@ -12,6 +12,7 @@
 # include "main.h"
 
 # include "minixsys.h"
+# include "bitmap.h"
 # include "inode.h"
 # include "zone.h"
 # include "version.h"
@@ -221,7 +222,9 @@ minix_sanity (int drv)
 			DEBUG (("Minix-FS (%c): maps = %li -> %li bytes", drv+'A', maps, maps * BLOCK_SIZE));
 			
 			maps *= BLOCK_SIZE;
-			p = kmalloc (maps);
+			
+			/* bitmaps followed by the per block free counters */
+			p = kmalloc (maps + (sblk->s_imap_blks + sblk->s_zmap_blks) * sizeof (ushort));
 			if (!p)
 			{
 				ALERT (("Minix-FS (%c): No memory for bitmaps!", drv+'A'));
@@ -232,6 +235,8 @@ minix_sanity (int drv)
 			
 			psblk->ibitmap = (void *) p;
 			psblk->zbitmap = (void *) (p + BLOCK_SIZE * sblk->s_imap_blks);
+			psblk->ibcount = (void *) (p + maps);
+			psblk->zbcount = psblk->ibcount + sblk->s_imap_blks;
 			
 			r = BIO_RWABS (di, 2, p, maps, 2);
 			if (r)
@@ -242,8 +247,8 @@ minix_sanity (int drv)
 			
 			psblk->idirty = 0;
 			psblk->zdirty = 0;
-			psblk->zlast = 0;
-			psblk->ilast = 0;
+			
+			init_bitmaps (psblk);
 			
 			/* Final step , read in the root directory zone 1 and
 			 * check the '.' and '..' spacing , The spacing
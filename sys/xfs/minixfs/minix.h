@@ -174,8 +174,13 @@ struct super_info
 	ushort	idirty;	/* ibitmap dirty flag */
 	ushort	zdirty;	/* zbitmap dirty flag */
 	
-	long	ilast;	/* search start for free inodes */
-	long	zlast;	/* search start for free zones */
+	long	ilast;	/* search start for free inodes (next fit) */
+	long	zlast;	/* search start for free zones (next fit) */
+	
+	ushort	*ibcount;	/* free inodes per ibitmap block */
+	ushort	*zbcount;	/* free zones per zbitmap block */
+	long	ifree;	/* free inodes */
+	long	zfree;	/* free zones */
 	
 	UNIT	*sunit;	/* actual super block */
 	
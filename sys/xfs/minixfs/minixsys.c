@@ -138,7 +138,9 @@ FILESYS minix_filesys =
 	
 	/* FS_EXT_3 */
 	stat64:			m_stat64,
-	res1:			0, 
+
+	/* FS_EXT_4 */
+	readdirx:		NULL,
 	res2:			0,
 	res3:			0,
 	
@@ -1121,7 +1123,7 @@ m_dfree (fcookie *dir, long int *buffer)
 	SI *psblk = super_ptr[dir->dev];
 	
 	buffer[1] = psblk->sblk->s_zones - psblk->sblk->s_firstdatazn;
-	buffer[0] = buffer[1] - count_bits (psblk->zbitmap, buffer[1] + 1) + 1;
+	buffer[0] = psblk->zfree;
 	buffer[2] = BLOCK_SIZE;
 	buffer[3] = 1L;
 	
@@ -1317,9 +1319,9 @@ m_fscntl (fcookie *dir, const char *name, int cmd, long int arg)
 			
 			inf->blocksize = BLOCK_SIZE;
 			inf->blocks = psblk->sblk->s_zones - psblk->sblk->s_firstdatazn;
-			inf->free_blocks = inf->blocks - count_bits (psblk->zbitmap, inf->blocks + 1) + 1;
+			inf->free_blocks = psblk->zfree;
 			inf->inodes = psblk->sblk->s_ninodes;
-			inf->free_inodes = inf->inodes - count_bits (psblk->ibitmap, inf->inodes + 1) + 1;
+			inf->free_inodes = psblk->ifree;
 			
 			return E_OK;
 		}
@@ -1374,8 +1376,8 @@ m_fscntl (fcookie *dir, const char *name, int cmd, long int arg)
 			inf->total_inodes = psblk->sblk->s_ninodes;
 			inf->version = 2;
 			inf->increment = psblk->incr;		
-			inf->free_inodes = inf->total_inodes - count_bits (psblk->ibitmap, inf->total_inodes + 1) + 1;
-			inf->free_zones = inf->total_zones - count_bits (psblk->zbitmap, inf->total_zones + 1) + 1;
+			inf->free_inodes = psblk->ifree;
+			inf->free_zones = psblk->zfree;
 			
 			return E_OK;
 		}
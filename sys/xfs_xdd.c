@@ -33,6 +33,7 @@
 # include "mint/file.h"
 # include "mint/stat.h"
 
+# include "namecache.h"
 # include "proc.h"
 # include "time.h"
 
@@ -84,6 +85,44 @@ getxattr(FILESYS *fs, fcookie *fc, XATTR *xattr)
 	return r;
 }
 
+/* convert the attributes of a filesystem without FS_EXT_3 */
+void
+xattr2stat64(const XATTR *xattr, STAT *stat)
+{
+	stat->dev	= xattr->dev;
+	stat->ino	= xattr->index;
+	stat->mode	= xattr->mode;
+	stat->nlink	= xattr->nlink;
+	stat->uid	= xattr->uid;
+	stat->gid	= xattr->gid;
+	stat->rdev	= xattr->rdev;
+
+	/* no native UTC extension
+	 * -> convert to unix UTC
+	 */
+	stat->atime.high_time = 0;
+	stat->atime.time = unixtime (xattr->atime, xattr->adate) + timezone;
+	stat->atime.nanoseconds = 0;
+
+	stat->mtime.high_time = 0;
+	stat->mtime.time = unixtime (xattr->mtime, xattr->mdate) + timezone;
+	stat->mtime.nanoseconds = 0;
+
+	stat->ctime.high_time = 0;
+	stat->ctime.time = unixtime (xattr->ctime, xattr->cdate) + timezone;
+	stat->ctime.nanoseconds = 0;
+
+	stat->size	= xattr->size;
+	stat->blocks	= (xattr->blksize < 512) ? xattr->nblocks :
+				xattr->nblocks * (xattr->blksize >> 9);
+	stat->blksize	= xattr->blksize;
+
+	stat->flags	= 0;
+	stat->gen	= 0;
+
+	mint_bzero(stat->res, sizeof(stat->res));
+}
+
 long
 getstat64(FILESYS *fs, fcookie *fc, STAT *stat)
 {
@@ -94,40 +133,7 @@ getstat64(FILESYS *fs, fcookie *fc, STAT *stat)
 
 	r = xfs_getxattr(fs, fc, &xattr);
 	if (!r)
-	{
-		stat->dev	= xattr.dev;
-		stat->ino	= xattr.index;
-		stat->mode	= xattr.mode;
-		stat->nlink	= xattr.nlink;
-		stat->uid	= xattr.uid;
-		stat->gid	= xattr.gid;
-		stat->rdev	= xattr.rdev;
-
-		/* no native UTC extension
-		 * -> convert to unix UTC
-		 */
-		stat->atime.high_time = 0;
-		stat->atime.time = unixtime (xattr.atime, xattr.adate) + timezone;
-		stat->atime.nanoseconds = 0;
-
-		stat->mtime.high_time = 0;
-		stat->mtime.time = unixtime (xattr.mtime, xattr.mdate) + timezone;
-		stat->mtime.nanoseconds = 0;
-
-		stat->ctime.high_time = 0;
-		stat->ctime.time = unixtime (xattr.ctime, xattr.cdate) + timezone;
-		stat->ctime.nanoseconds = 0;
-
-		stat->size	= xattr.size;
-		stat->blocks	= (xattr.blksize < 512) ? xattr.nblocks :
-					xattr.nblocks * (xattr.blksize >> 9);
-		stat->blksize	= xattr.blksize;
-
-		stat->flags	= 0;
-		stat->gen	= 0;
-
-		mint_bzero(stat->res, sizeof(stat->res));
-	}
+		xattr2stat64(&xattr, stat);
 
 	return r;
 }
@@ -359,9 +365,11 @@ xfs_mkdir(FILESYS *fs, fcookie *dir, const char *name, unsigned mode)
 {
 	long r;
 	
+	nc_purge(dir, name);
 	xfs_lock(fs, dir->dev, "xfs_mkdir");
 	r = (*fs->mkdir)(dir, name, mode);
 	xfs_unlock(fs, dir->dev, "xfs_mkdir");
+	nc_purge(dir, name);
 	
 	return r;
 }
@@ -370,9 +378,11 @@ xfs_rmdir(FILESYS *fs, fcookie *dir, const char *name)
 {
 	long r;
 	
+	nc_purge_dev(dir->dev);
 	xfs_lock(fs, dir->dev, "xfs_rmdir");
 	r = (*fs->rmdir)(dir, name);
 	xfs_unlock(fs, dir->dev, "xfs_rmdir");
+	nc_purge_dev(dir->dev);
 	
 	return r;
 }
@@ -381,9 +391,11 @@ xfs_creat(FILESYS *fs, fcookie *dir, const char *name, unsigned mode, int attr,
 {
 	long r;
 	
+	nc_purge(dir, name);
 	xfs_lock(fs, dir->dev, "xfs_creat");
 	r = (*fs->creat)(dir, name, mode, attr, fc);
 	xfs_unlock(fs, dir->dev, "xfs_creat");
+	nc_purge(dir, name);
 	
 	return r;
 }
@@ -392,9 +404,11 @@ xfs_remove(FILESYS *fs, fcookie *dir, const char *name)
 {
 	long r;
 	
+	nc_purge(dir, name);
 	xfs_lock(fs, dir->dev, "xfs_remove");
 	r = (*fs->remove)(dir, name);
 	xfs_unlock(fs, dir->dev, "xfs_remove");
+	nc_purge(dir, name);
 	
 	return r;
 }
@@ -414,9 +428,11 @@ xfs_rename(FILESYS *fs, fcookie *olddir, char *oldname, fcookie *newdir, const c
 {
 	long r;
 	
+	nc_purge_dev(olddir->dev);
 	xfs_lock(fs, olddir->dev, "xfs_rename");
 	r = (*fs->rename)(olddir, oldname, newdir, newname);
 	xfs_unlock(fs, olddir->dev, "xfs_rename");
+	nc_purge_dev(olddir->dev);
 	
 	return r;
 }
@@ -510,9 +526,11 @@ xfs_symlink(FILESYS *fs, fcookie *dir, const char *name, const char *to)
 {
 	long r;
 	
+	nc_purge(dir, name);
 	xfs_lock(fs, dir->dev, "xfs_symlink");
 	r = (*fs->symlink)(dir, name , to);
 	xfs_unlock(fs, dir->dev, "xfs_symlink");
+	nc_purge(dir, name);
 	
 	return r;
 }
@@ -532,9 +550,11 @@ xfs_hardlink(FILESYS *fs, fcookie *fromdir, const char *fromname, fcookie *todir
 {
 	long r;
 	
+	nc_purge(todir, toname);
 	xfs_lock(fs, fromdir->dev, "xfs_hardlink");
 	r = (*fs->hardlink)(fromdir, fromname, todir, toname);
 	xfs_unlock(fs, fromdir->dev, "xfs_hardlink");
+	nc_purge(todir, toname);
 	
 	return r;
 }
@@ -554,10 +574,19 @@ xfs_dskchng(FILESYS *fs, int drv, int mode)
 {
 	long r;
 	
+	/* cached cookies must go before the filesystem invalidates
+	 * them on a forced change, or after it detected one itself
+	 */
+	if (mode)
+		nc_purge_dev(drv);
+	
 	xfs_lock(fs, drv, "xfs_dskchng");
 	r = (*fs->dskchng)(drv, mode);
 	xfs_unlock(fs, drv, "xfs_dskchng");
 	
+	if (!mode && r)
+		nc_purge_dev(drv);
+	
 	return r;
 }
 
@@ -577,9 +606,11 @@ xfs_mknod(FILESYS *fs, fcookie *dir, const char *name, ulong mode)
 {
 	long r;
 	
+	nc_purge(dir, name);
 	xfs_lock(fs, dir->dev, "xfs_mknod");
 	r = (*fs->mknod)(dir, name, mode);
 	xfs_unlock(fs, dir->dev, "xfs_mknod");
+	nc_purge(dir, name);
 	
 	return r;
 }
@@ -588,9 +619,11 @@ xfs_unmount(FILESYS *fs, int drv)
 {
 	long r;
 	
+	nc_purge_dev(drv);
 	xfs_lock(fs, drv, "xfs_unmount");
 	r = (*fs->unmount)(drv);
 	xfs_unlock(fs, drv, "xfs_unmount");
+	nc_purge_dev(drv);
 	
 	return r;
 }
@@ -610,6 +643,19 @@ xfs_stat64(FILESYS *fs, fcookie *fc, STAT *stat)
 	
 	return getstat64(fs, fc, stat);
 }
+long _cdecl
+xfs_readdirx(FILESYS *fs, DIR *dirh, char *buf, long len)
+{
+	long r;
+	
+	assert(fs->fsflags & FS_EXT_4);
+	
+	xfs_lock(fs, dirh->fc.dev, "xfs_readdirx");
+	r = (*fs->readdirx)(dirh, buf, len);
+	xfs_unlock(fs, dirh->fc.dev, "xfs_readdirx");
+	
+	return r;
+}
 
 
 long _cdecl
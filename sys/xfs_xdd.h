@@ -33,6 +33,7 @@
 
 
 long getxattr (FILESYS *fs, fcookie *fc, XATTR *xattr);
+void xattr2stat64 (const XATTR *xattr, STAT *ptr);
 long getstat64 (FILESYS *fs, fcookie *fc, STAT *ptr);
 
 
@@ -80,6 +81,7 @@ long _cdecl xfs_dupcookie(FILESYS *fs, fcookie *dst, fcookie *src);
 long _cdecl xfs_mknod(FILESYS *fs, fcookie *dir, const char *name, ulong mode);
 long _cdecl xfs_unmount(FILESYS *fs, int drv);
 long _cdecl xfs_stat64(FILESYS *fs, fcookie *fc, STAT *stat);
+long _cdecl xfs_readdirx(FILESYS *fs, DIR *dirh, char *buf, long len);
 
 
 long _cdecl xdd_open(FILEPTR *f);
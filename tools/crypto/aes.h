@@ -0,0 +1,31 @@
+/*
+ * This file belongs to FreeMiNT.  It's not in the original MiNT 1.12
+ * distribution.  See the file Changes.MH for a detailed log of changes.
+ * 
+ * 
+ * aes.h
+ * 
+ * AES-128 block cipher (FIPS-197).
+ * 
+ */
+
+# ifndef _aes_h
+# define _aes_h
+
+# include "mytypes.h"
+
+# define AES_ROUNDS	10
+# define AES_BLOCK	16
+
+/* expanded key, either for encryption or for decryption */
+struct aes_key
+{
+	__u32 rk[4 * (AES_ROUNDS + 1)];
+};
+
+void AES_set_encrypt_key (struct aes_key *key, const unsigned char userkey[16]);
+void AES_set_decrypt_key (struct aes_key *key, const unsigned char userkey[16]);
+void AES_encrypt (const struct aes_key *key, const unsigned char in[16], unsigned char out[16]);
+void AES_decrypt (const struct aes_key *key, const unsigned char in[16], unsigned char out[16]);
+
+# endif /* _aes_h */
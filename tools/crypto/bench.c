@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ * 
+ * Throughput benchmark and self test for the crypto layer ciphers,
+ * built as cryptbench next to crypto and with "make host-bench" for
+ * the build host.
+ * 
+ */
+
+# include "aes.h"
+# include "crypt.h"
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+
+
+# define SECSIZE	512
+# define BUFSIZE	(64L * 1024)
+
+static const char *names[] =
+{
+	"blowfish-cbc",
+	"aes-xts",
+	NULL
+};
+
+
+/* FIPS-197, appendix C.1 */
+static int
+aes_selftest (void)
+{
+	static const uchar expect[16] =
+	{
+		0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+		0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+	};
+	struct aes_key key;
+	uchar k[16], b[16];
+	int i;
+	
+	for (i = 0; i < 16; i++)
+	{
+		k[i] = i;
+		b[i] = i * 0x11;
+	}
+	
+	AES_set_encrypt_key (&key, k);
+	AES_encrypt (&key, b, b);
+	if (memcmp (b, expect, 16))
+		return -1;
+	
+	AES_set_decrypt_key (&key, k);
+	AES_decrypt (&key, b, b);
+	for (i = 0; i < 16; i++)
+		if (b[i] != (uchar)(i * 0x11))
+			return -1;
+	
+	return 0;
+}
+
+static double
+run (void *key, char *buf, int decipher)
+{
+	clock_t start, end;
+	long bytes = 0;
+	
+	start = clock ();
+	do {
+		if (decipher)
+			decrypt_block (key, buf, BUFSIZE, 1, SECSIZE);
+		else
+			encrypt_block (key, buf, BUFSIZE, 1, SECSIZE);
+		
+		bytes += BUFSIZE;
+		end = clock ();
+	}
+	while (end - start < CLOCKS_PER_SEC);
+	
+	return (double) bytes / 1024.0 / ((double)(end - start) / CLOCKS_PER_SEC);
+}
+
+int
+main (void)
+{
+	char *buf, *ref;
+	int cipher;
+	long i;
+	
+	if (aes_selftest ())
+	{
+		printf ("AES self test failed\n");
+		return 1;
+	}
+	
+	buf = malloc (BUFSIZE);
+	ref = malloc (BUFSIZE);
+	if (!buf || !ref)
+	{
+		perror ("malloc");
+		return 1;
+	}
+	
+	for (i = 0; i < BUFSIZE; i++)
+		ref[i] = i * 7;
+	
+	printf ("%-16s %12s %12s\n", "cipher", "enc kB/s", "dec kB/s");
+	
+	for (cipher = 0; names[cipher]; cipher++)
+	{
+		void *key = make_key ("benchmark", cipher);
+		double enc, dec;
+		
+		if (!key)
+		{
+			printf ("%-16s not supported\n", names[cipher]);
+			continue;
+		}
+		
+		/* round trip first */
+		memcpy (buf, ref, BUFSIZE);
+		encrypt_block (key, buf, BUFSIZE, 1, SECSIZE);
+		if (!memcmp (buf, ref, SECSIZE))
+		{
+			printf ("%-16s doesn't encrypt\n", names[cipher]);
+			return 1;
+		}
+		decrypt_block (key, buf, BUFSIZE, 1, SECSIZE);
+		if (memcmp (buf, ref, BUFSIZE))
+		{
+			printf ("%-16s round trip failed\n", names[cipher]);
+			return 1;
+		}
+		
+		enc = run (key, buf, 0);
+		dec = run (key, buf, 1);
+		
+		printf ("%-16s %12.0f %12.0f\n", names[cipher], enc, dec);
+		free (key);
+	}
+	
+	return 0;
+}
@@ -27,6 +27,7 @@
  * 
  */
 
+# include "aes.h"
 # include "blowfish.h"
 # include "crypt.h"
 # include "md5.h"
@@ -133,7 +134,7 @@ blow_doblock (BF_KEY *bfk,
 	blocksize = p_secsize;
 	
 # if !defined(__mc68020__) && !defined(__mc68030__) && !defined(__mc68040__) && !defined(__mc68060__) && !defined(__mcoldfire__)
-	if (((ulong) buf & 1L) /* && (mcpu < 20) */)
+	if (((long) buf & 1L) /* && (mcpu < 20) */)
 	{
 		/* Unfortunately, the block isn't word aligned ...
 		 */
@@ -201,11 +202,96 @@ blow_keyinit (BF_KEY *key, char *passphrase)
 }
 
 
+/*
+ * AES-128 in XTS mode, must match the kernel (crypt_IO.c)
+ *
+ * The tweak of the first 16 byte block of a sector is the encrypted
+ * sector number (little endian) and is multiplied by alpha in GF(2^128)
+ * from block to block.
+ */
+struct xts_key
+{
+	struct aes_key	data_enc;
+	struct aes_key	data_dec;
+	struct aes_key	tweak;
+};
+
+static void
+xts_keyinit (struct xts_key *key, char *passphrase)
+{
+	struct MD5Context md5sum;
+	uchar data [16];
+	uchar tweak [16];
+	
+	MD5Init (&md5sum);
+	MD5Update (&md5sum, (uchar *) passphrase, strlen (passphrase));
+	MD5Final (data, &md5sum);
+	
+	MD5Init (&md5sum);
+	MD5Update (&md5sum, data, 16);
+	MD5Update (&md5sum, (uchar *) passphrase, strlen (passphrase));
+	MD5Final (tweak, &md5sum);
+	
+	AES_set_encrypt_key (&key->data_enc, data);
+	AES_set_decrypt_key (&key->data_dec, data);
+	AES_set_encrypt_key (&key->tweak, tweak);
+}
+
+static void
+xts_doblock (struct xts_key *key, int decipher,
+		char *buf, ulong size, u_int32_t rec, u_int32_t p_secsize)
+{
+	assert (((p_secsize % AES_BLOCK) == 0));
+	assert (((size % p_secsize) == 0));
+	
+	for (; size; size -= p_secsize, rec++)
+	{
+		uchar t [16], x [16];
+		ulong n;
+		int i;
+		
+		memset (t, 0, sizeof (t));
+		t[0] = rec;
+		t[1] = rec >> 8;
+		t[2] = rec >> 16;
+		t[3] = rec >> 24;
+		
+		AES_encrypt (&key->tweak, t, t);
+		
+		for (n = p_secsize; n; n -= AES_BLOCK, buf += AES_BLOCK)
+		{
+			uchar carry;
+			
+			for (i = 0; i < AES_BLOCK; i++)
+				x[i] = buf[i] ^ t[i];
+			
+			if (decipher)
+				AES_decrypt (&key->data_dec, x, x);
+			else
+				AES_encrypt (&key->data_enc, x, x);
+			
+			for (i = 0; i < AES_BLOCK; i++)
+				buf[i] = x[i] ^ t[i];
+			
+			/* next tweak */
+			carry = t[15] & 0x80;
+			for (i = 15; i > 0; i--)
+				t[i] = (t[i] << 1) | (t[i - 1] >> 7);
+			t[0] = (t[0] << 1) ^ (carry ? 0x87 : 0);
+		}
+	}
+}
+
+
 typedef struct key KEY;
 struct key
 {
 	int	cipher;
-	BF_KEY	blowfish;
+	union
+	{
+		BF_KEY		blowfish;
+		struct xts_key	xts;
+	} u;
 };
 
 void *
@@ -222,7 +308,14 @@ make_key (char *passphrase, int cipher)
 			/* blowfish */
 			case 0:
 			{
-				blow_keyinit (&(key->blowfish), passphrase);
+				blow_keyinit (&(key->u.blowfish), passphrase);
+				break;
+			}
+			
+			/* aes-xts */
+			case 1:
+			{
+				xts_keyinit (&(key->u.xts), passphrase);
 				break;
 			}
 			
@@ -258,11 +351,19 @@ encrypt_block (void *_key, void *_buf, int32_t bufsize, int32_t recno, int32_t p
 	
 	if (bufsize)
 	{
-		if (key->cipher)
-			return -1;
-		
-		blow_doblock (&(key->blowfish), blow_cbc_encipher,
-				buf, bufsize, recno, p_secsize);
+		switch (key->cipher)
+		{
+			case 0:
+				blow_doblock (&(key->u.blowfish), blow_cbc_encipher,
+						buf, bufsize, recno, p_secsize);
+				break;
+			case 1:
+				xts_doblock (&(key->u.xts), 0,
+						buf, bufsize, recno, p_secsize);
+				break;
+			default:
+				return -1;
+		}
 	}
 	
 	return 0;
@@ -286,11 +387,19 @@ decrypt_block (void *_key, void *_buf, int32_t bufsize, int32_t recno, int32_t p
 	
 	if (bufsize)
 	{
-		if (key->cipher)
-			return -1;
-		
-		blow_doblock (&(key->blowfish), blow_cbc_decipher,
-				buf, bufsize, recno, p_secsize);
+		switch (key->cipher)
+		{
+			case 0:
+				blow_doblock (&(key->u.blowfish), blow_cbc_decipher,
+						buf, bufsize, recno, p_secsize);
+				break;
+			case 1:
+				xts_doblock (&(key->u.xts), 1,
+						buf, bufsize, recno, p_secsize);
+				break;
+			default:
+				return -1;
+		}
 	}
 	
 	return 0;
@@ -0,0 +1,37 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ * 
+ * Stand-in for ../../IO/bswap.h to build cryptbench with the host
+ * compiler (make host-bench).
+ * 
+ * md5.c only uses BSWAP32 to turn the big endian words of the 68k
+ * into the little endian ones MD5 is defined on. On a little endian
+ * host nothing has to be swapped, which keeps the derived keys the
+ * same as on the target.
+ * 
+ */
+
+# ifndef _m68k_bswap_h
+# define _m68k_bswap_h
+
+# if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+# define BSWAP32(x)	(x)
+# else
+# define BSWAP32(x)	(__builtin_bswap32 (x))
+# endif
+
+
+# endif /* _m68k_bswap_h */
@@ -0,0 +1,48 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ * 
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ * 
+ * 
+ * Stand-in for ../../IO/mytypes.h to build cryptbench with the host
+ * compiler (make host-bench).
+ * 
+ * The cipher code relies on long being 32 bit like on MiNT, so ulong
+ * and ushort are mapped to fixed size types. This header must come
+ * before any system header that could use the names itself.
+ * 
+ */
+
+# ifndef _mytypes_h
+# define _mytypes_h
+
+# include <stdint.h>
+# include <sys/types.h>
+
+typedef unsigned char	uchar;
+
+typedef int8_t		__s8;
+typedef int16_t		__s16;
+typedef int32_t		__s32;
+typedef int64_t		__s64;
+
+typedef uint8_t		__u8;
+typedef uint16_t	__u16;
+typedef uint32_t	__u32;
+typedef uint64_t	__u64;
+
+# define ulong		__u32
+# define ushort		__u16
+
+
+# endif /* _mytypes_h */
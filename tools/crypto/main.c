@@ -100,9 +100,11 @@ static char *actions[] =
 static char *ciphers[] =
 {
 	"blowfish",
+	"aes-xts",
 	NULL
 };
 # define BLOWFISH	0
+# define AES_XTS	1
 
 
 char *myname = NULL;
@@ -302,7 +304,7 @@ useful options: \
                           default is encipher \
     -b# [or --buffer #]:  specify buffer size in kb \
                           default is %ikb \
-    -c# [or --cipher #]:  select cipher algorithm (blowfish) \
+    -c# [or --cipher #]:  select cipher algorithm (blowfish, aes-xts) \
                           default is blowfish \
     -m# [or --mode #]:    select mode (robust, fast) \
                           default is robust \
@@ -627,9 +629,9 @@ main (int argc, char **argv)
 	if (auto_passphrase_set)
 	{
 		if (action == DECIPHER)
-			Dsetkey (0, drv, "", 0);
+			Dsetkey (0, drv, "", cipher);
 		else
-			Dsetkey (0, drv, passphrase, 0);
+			Dsetkey (0, drv, passphrase, cipher);
 	}
 	
 	
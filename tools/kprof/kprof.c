@@ -0,0 +1,401 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+/*
+ * kprof: evaluate the kernel's system wide profile
+ *
+ * sysctl -w kern.profile=1	start sampling
+ * kprof -s mint=mint.nm	show where the time went
+ *
+ * Every sample is assigned to the text segment listed in
+ * /kern/profmap it falls into. Symbol tables in nm format
+ * (relative to the start of the text) can be given for any
+ * segment name to resolve the samples down to functions.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// XXX -> header should be in mintlib
+#include "../../sys/mint/kprof.h"
+
+
+#define PROFFILE	"/kern/profile"
+#define MAPFILE		"/kern/profmap"
+
+struct sym
+{
+	unsigned long addr;
+	char *name;
+};
+
+struct symtab
+{
+	struct symtab *next;
+	char *name;		/* segment name */
+	struct sym *syms;
+	long nsyms;
+};
+
+struct seg
+{
+	unsigned long start;
+	unsigned long end;
+	int pid;
+	char type[8];
+	char name[64];
+	struct symtab *tab;
+};
+
+struct hit
+{
+	char *key;
+	long count;
+};
+
+static struct seg *segs;
+static long nsegs;
+
+static struct symtab *symtabs;
+
+static struct hit *hits;
+static long nhits, maxhits;
+
+
+static void *
+xmalloc(size_t size)
+{
+	void *p = malloc(size);
+
+	if (!p)
+	{
+		perror("malloc");
+		exit(1);
+	}
+
+	return p;
+}
+
+static int
+cmp_sym(const void *a, const void *b)
+{
+	const struct sym *s1 = a, *s2 = b;
+
+	if (s1->addr < s2->addr)
+		return -1;
+
+	return s1->addr > s2->addr;
+}
+
+/*
+ * -s name=file: nm output, only text symbols are used
+ */
+static void
+load_symtab(char *arg)
+{
+	struct symtab *tab;
+	char line[256], sym[200];
+	unsigned long addr;
+	char type;
+	char *file;
+	long max = 0;
+	FILE *f;
+
+	file = strchr(arg, '=');
+	if (!file)
+	{
+		fprintf(stderr, "kprof: -s name=file expected\n");
+		exit(1);
+	}
+	*file++ = '\0';
+
+	f = fopen(file, "r");
+	if (!f)
+	{
+		perror(file);
+		exit(1);
+	}
+
+	tab = xmalloc(sizeof(*tab));
+	tab->name = arg;
+	tab->syms = NULL;
+	tab->nsyms = 0;
+
+	while (fgets(line, sizeof(line), f))
+	{
+		if (sscanf(line, "%lx %c %199s", &addr, &type, sym) != 3)
+			continue;
+
+		if (type != 'T' && type != 't')
+			continue;
+
+		if (tab->nsyms == max)
+		{
+			max = max ? max * 2 : 256;
+			tab->syms = realloc(tab->syms, max * sizeof(*tab->syms));
+			if (!tab->syms)
+			{
+				perror("realloc");
+				exit(1);
+			}
+		}
+
+		tab->syms[tab->nsyms].addr = addr;
+		tab->syms[tab->nsyms].name = strdup(sym);
+		tab->nsyms++;
+	}
+
+	fclose(f);
+
+	qsort(tab->syms, tab->nsyms, sizeof(*tab->syms), cmp_sym);
+
+	tab->next = symtabs;
+	symtabs = tab;
+}
+
+static void
+load_map(const char *file)
+{
+	char line[256];
+	long max = 0;
+	FILE *f;
+
+	f = fopen(file, "r");
+	if (!f)
+	{
+		perror(file);
+		exit(1);
+	}
+
+	while (fgets(line, sizeof(line), f))
+	{
+		struct seg *s;
+		struct symtab *tab;
+
+		if (nsegs == max)
+		{
+			max = max ? max * 2 : 64;
+			segs = realloc(segs, max * sizeof(*segs));
+			if (!segs)
+			{
+				perror("realloc");
+				exit(1);
+			}
+		}
+
+		s = &segs[nsegs];
+		if (sscanf(line, "%lx %lx %d %7s %63[^\n]",
+			   &s->start, &s->end, &s->pid, s->type, s->name) != 5)
+			continue;
+
+		s->tab = NULL;
+		for (tab = symtabs; tab; tab = tab->next)
+			if (!strcmp(tab->name, s->name))
+				s->tab = tab;
+
+		nsegs++;
+	}
+
+	fclose(f);
+}
+
+static struct seg *
+find_seg(const struct kprof_sample *sample)
+{
+	long i;
+
+	/* the process' own text first */
+	for (i = 0; i < nsegs; i++)
+		if (segs[i].pid == sample->pid
+		    && sample->pc >= segs[i].start && sample->pc < segs[i].end)
+			return &segs[i];
+
+	for (i = 0; i < nsegs; i++)
+		if (segs[i].pid == 0
+		    && sample->pc >= segs[i].start && sample->pc < segs[i].end)
+			return &segs[i];
+
+	return NULL;
+}
+
+static const char *
+find_sym(struct symtab *tab, unsigned long addr)
+{
+	long lo = 0, hi = tab->nsyms - 1;
+	const char *name = NULL;
+
+	while (lo <= hi)
+	{
+		long mid = (lo + hi) / 2;
+
+		if (tab->syms[mid].addr <= addr)
+		{
+			name = tab->syms[mid].name;
+			lo = mid + 1;
+		}
+		else
+			hi = mid - 1;
+	}
+
+	return name;
+}
+
+static void
+add_hit(const char *key)
+{
+	long i;
+
+	for (i = 0; i < nhits; i++)
+	{
+		if (!strcmp(hits[i].key, key))
+		{
+			hits[i].count++;
+			return;
+		}
+	}
+
+	if (nhits == maxhits)
+	{
+		maxhits = maxhits ? maxhits * 2 : 256;
+		hits = realloc(hits, maxhits * sizeof(*hits));
+		if (!hits)
+		{
+			perror("realloc");
+			exit(1);
+		}
+	}
+
+	hits[nhits].key = strdup(key);
+	hits[nhits].count = 1;
+	nhits++;
+}
+
+static int
+cmp_hit(const void *a, const void *b)
+{
+	const struct hit *h1 = a, *h2 = b;
+
+	return h2->count - h1->count;
+}
+
+static void
+usage(void)
+{
+	fprintf(stderr, "usage: kprof [-p pid] [-n count] [-s name=nmfile]... [profile [map]]\n");
+	exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *proffile = PROFFILE;
+	const char *mapfile = MAPFILE;
+	struct kprof_sample sample;
+	long total = 0, top = 30, i;
+	int pid = 0;
+	FILE *f;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:p:s:")) != -1)
+	{
+		switch (c)
+		{
+			case 'n':
+				top = atol(optarg);
+				break;
+			case 'p':
+				pid = atoi(optarg);
+				break;
+			case 's':
+				load_symtab(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (optind < argc)
+		proffile = argv[optind++];
+	if (optind < argc)
+		mapfile = argv[optind++];
+
+	load_map(mapfile);
+
+	f = fopen(proffile, "rb");
+	if (!f)
+	{
+		perror(proffile);
+		exit(1);
+	}
+
+	while (fread(&sample, sizeof(sample), 1, f) == 1)
+	{
+		char key[160];
+		struct seg *s;
+
+		if (pid && sample.pid != pid)
+			continue;
+
+		s = find_seg(&sample);
+		if (s)
+		{
+			const char *sym = NULL;
+
+			if (s->tab)
+				sym = find_sym(s->tab, sample.pc - s->start);
+
+			if (sym)
+				snprintf(key, sizeof(key), "%-8s %s:%s", s->type, s->name, sym);
+			else
+				snprintf(key, sizeof(key), "%-8s %s", s->type, s->name);
+		}
+		else if (sample.flags & KPROF_SUPER)
+			snprintf(key, sizeof(key), "%-8s %s", "super", "(rom/unknown)");
+		else
+			snprintf(key, sizeof(key), "%-8s pid %d", "user", sample.pid);
+
+		add_hit(key);
+		total++;
+	}
+
+	fclose(f);
+
+	if (!total)
+	{
+		printf("no samples\n");
+		return 0;
+	}
+
+	qsort(hits, nhits, sizeof(*hits), cmp_hit);
+
+	printf("%ld samples (%ld ms)\n\n", total, total * 5);
+	printf("%8s %7s  %s\n", "samples", "%", "where");
+
+	for (i = 0; i < nhits && i < top; i++)
+		printf("%8ld %5ld.%ld  %s\n", hits[i].count,
+			hits[i].count * 100 / total,
+			(hits[i].count * 1000 / total) % 10,
+			hits[i].key);
+
+	return 0;
+}
@@ -0,0 +1,189 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define PORT	5556
+#define SENDING	(16L * 1024 * 1024)
+
+/*
+ * TCP throughput over the loopback interface: a child writes SENDING
+ * bytes in chunks of the given size to 127.0.0.1, the parent reads and
+ * times them.
+ */
+
+static int
+writer (long bufsize)
+{
+	struct sockaddr_in in;
+	char *buf;
+	long nbytes, r;
+	int fd;
+
+	buf = malloc (bufsize);
+	if (!buf)
+	{
+		printf ("out of mem\n");
+		return 1;
+	}
+	memset (buf, 'A', bufsize);
+
+	fd = socket (AF_INET, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		perror ("socket");
+		return 1;
+	}
+
+	memset (&in, 0, sizeof (in));
+	in.sin_family = AF_INET;
+	in.sin_port = htons (PORT);
+	in.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+	if (connect (fd, (struct sockaddr *) &in, sizeof (in)) < 0)
+	{
+		perror ("connect");
+		close (fd);
+		return 1;
+	}
+
+	for (nbytes = 0; nbytes < SENDING; nbytes += r)
+	{
+		r = write (fd, buf, bufsize);
+		if (r < 0)
+		{
+			perror ("write");
+			close (fd);
+			return 1;
+		}
+	}
+
+	close (fd);
+	return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+	struct sockaddr_in in;
+	char *buf;
+	long bufsize;
+	long long nbytes, bytes_per_second;
+	struct timeval start, end;
+	long ms;
+	pid_t pid;
+	int fd, client, status, opt;
+	long r;
+
+	if (argc < 2)
+	{
+		printf ("give the write buffersize and optionally the receive buffersize as args\n");
+		return 0;
+	}
+
+	bufsize = atol (argv[1]);
+	buf = malloc (bufsize);
+	if (!buf)
+	{
+		printf ("out of mem\n");
+		return 1;
+	}
+
+	fd = socket (AF_INET, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		perror ("socket");
+		return 1;
+	}
+
+	opt = 1;
+	setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof (opt));
+
+	if (argc > 2)
+	{
+		/* inherited by the accepted socket */
+		opt = atoi (argv[2]);
+		if (setsockopt (fd, SOL_SOCKET, SO_RCVBUF, &opt, sizeof (opt)) < 0)
+			perror ("setsockopt");
+	}
+
+	memset (&in, 0, sizeof (in));
+	in.sin_family = AF_INET;
+	in.sin_port = htons (PORT);
+	in.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+	if (bind (fd, (struct sockaddr *) &in, sizeof (in)) < 0)
+	{
+		perror ("bind");
+		close (fd);
+		return 1;
+	}
+
+	if (listen (fd, 1) < 0)
+	{
+		perror ("listen");
+		close (fd);
+		return 1;
+	}
+
+	pid = fork ();
+	if (pid < 0)
+	{
+		perror ("fork");
+		close (fd);
+		return 1;
+	}
+
+	if (pid == 0)
+	{
+		close (fd);
+		_exit (writer (bufsize));
+	}
+
+	client = accept (fd, NULL, NULL);
+	if (client < 0)
+	{
+		perror ("accept");
+		kill (pid, SIGTERM);
+		close (fd);
+		return 1;
+	}
+
+	nbytes = 0;
+	gettimeofday (&start, NULL);
+	do {
+		r = read (client, buf, bufsize);
+		if (r < 0)
+		{
+			perror ("read");
+			break;
+		}
+		nbytes += r;
+	}
+	while (r > 0);
+	gettimeofday (&end, NULL);
+
+	close (client);
+	close (fd);
+	waitpid (pid, &status, 0);
+
+	ms = (end.tv_sec - start.tv_sec) * 1000L + (end.tv_usec - start.tv_usec) / 1000;
+	if (ms <= 0)
+		ms = 1;
+
+	printf ("%ld byte writes: received %qd bytes in %ld ms\n",
+		bufsize, nbytes, ms);
+
+	bytes_per_second = nbytes * 1000 / ms;
+	printf ("%qd bytes per second (%qd kb/s)\n",
+		bytes_per_second, bytes_per_second / 1024);
+
+	return 0;
+}
@@ -0,0 +1,246 @@
+/*
+ * This file belongs to FreeMiNT. It's not in the original MiNT 1.12
+ * distribution. See the file CHANGES for a detailed log of changes.
+ *
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This file is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+/*
+ * decode the kernel system call trace buffer
+ *
+ * sysctl -w kern.sctrace=1	start tracing
+ * sctrace			list the recorded calls
+ * sctrace -c			count calls and time per call
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sysenttab.h"
+
+// XXX -> header should be in mintlib
+#include "../../sys/mint/sctrace.h"
+
+#ifdef __MINT__
+long _stksize = 64 * 1024;
+#endif
+
+
+#define TRACEFILE	"/kern/sctrace"
+
+struct count
+{
+	unsigned long calls;
+	unsigned long ticks;
+};
+
+static struct count *counts[3];
+
+
+static struct sysent *
+lookup(const struct sctrace_rec *r, int *trap)
+{
+	struct sysent *tab;
+	unsigned long size;
+
+	switch (r->trap)
+	{
+		case 1:
+			*trap = 0;
+			tab = tab_gemdos;
+			size = tab_gemdos_size;
+			break;
+		case 13:
+			*trap = 1;
+			tab = tab_bios;
+			size = tab_bios_size;
+			break;
+		default:
+			*trap = 2;
+			tab = tab_xbios;
+			size = tab_xbios_size;
+			break;
+	}
+
+	if (r->nr >= size)
+		return NULL;
+
+	return &tab[r->nr];
+}
+
+static void
+print_rec(const struct sctrace_rec *r)
+{
+	struct sysent *ent;
+	int trap, i, n;
+
+	ent = lookup(r, &trap);
+
+	printf("%8lu %5i %8lu.%03lu ", r->seq, r->pid,
+		r->enter / 200, (r->enter % 200) * 5);
+
+	if (ent)
+	{
+		printf("%s(", ent->name);
+		n = (ent->argsize + 3) / 4;
+	}
+	else
+	{
+		printf("trap%i_0x%03x(", r->trap, r->nr);
+		n = 4;
+	}
+
+	if (n > 4)
+		n = 4;
+
+	for (i = 0; i < n; i++)
+		printf("%s0x%lx", i ? ", " : "", r->args[i]);
+
+	if (ent && ent->argsize > 16)
+		printf(", ...");
+
+	if (r->done)
+		printf(") = %li <%lu ms>\n", r->ret, (r->leave - r->enter) * 5);
+	else
+		printf(") ...\n");
+}
+
+static void
+count_rec(const struct sctrace_rec *r)
+{
+	struct count *c;
+	int trap;
+
+	lookup(r, &trap);
+
+	if (!counts[trap])
+	{
+		counts[trap] = calloc(0x10000, sizeof(*c));
+		if (!counts[trap])
+		{
+			perror("calloc");
+			exit(1);
+		}
+	}
+
+	c = &counts[trap][r->nr];
+	c->calls++;
+	if (r->done)
+		c->ticks += r->leave - r->enter;
+}
+
+static void
+print_counts(void)
+{
+	static const int traps[3] = { 1, 13, 14 };
+	int t;
+	long nr;
+
+	printf("%-24s %8s %10s\n", "call", "count", "ms");
+
+	for (t = 0; t < 3; t++)
+	{
+		if (!counts[t])
+			continue;
+
+		for (nr = 0; nr < 0x10000; nr++)
+		{
+			struct count *c = &counts[t][nr];
+			struct sctrace_rec r;
+			struct sysent *ent;
+			char name[32];
+			int trap;
+
+			if (!c->calls)
+				continue;
+
+			r.trap = traps[t];
+			r.nr = nr;
+			ent = lookup(&r, &trap);
+
+			if (ent)
+				snprintf(name, sizeof(name), "%s", ent->name);
+			else
+				snprintf(name, sizeof(name), "trap%i_0x%03lx", traps[t], nr);
+
+			printf("%-24s %8lu %10lu\n", name, c->calls, c->ticks * 5);
+		}
+	}
+}
+
+static void
+usage(const char *myname)
+{
+	fprintf(stderr, "usage: %s [-c] [-p pid] [file]\n", myname);
+	exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *file = TRACEFILE;
+	struct sctrace_rec r;
+	FILE *f;
+	long pid = 0;
+	int summary = 0;
+	int c;
+
+	while ((c = getopt(argc, argv, "cp:")) != -1)
+	{
+		switch (c)
+		{
+			case 'c':
+				summary = 1;
+				break;
+			case 'p':
+				pid = atol(optarg);
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (optind < argc)
+		file = argv[optind];
+
+	f = fopen(file, "rb");
+	if (!f)
+	{
+		perror(file);
+		exit(1);
+	}
+
+	while (fread(&r, sizeof(r), 1, f) == 1)
+	{
+		if (pid && r.pid != pid)
+			continue;
+
+		if (summary)
+			count_rec(&r);
+		else
+			print_rec(&r);
+	}
+
+	fclose(f);
+
+	if (summary)
+		print_counts();
+
+	return 0;
+}
@@ -34,6 +34,7 @@
 #include "xa_rsrc.h"
 
 #include "semaphores.h"
+#include "bstore.h"
 #include "c_window.h"
 #include "desktop.h"
 #include "menuwidg.h"
@@ -1203,6 +1204,7 @@ app_in_front(int lock, struct xa_client *client, bool snd_untopped, bool snd_ont
 			}
 			if (topped && topped != TOP_WINDOW)
 			{
+				bstore_save_area(&topped->r, window_list, topped);
 				wi_move_first(&S.open_windows, topped);
 				upd = true;
 			}
@@ -0,0 +1,329 @@
+/*
+ * XaAES - XaAES Ain't the AES (c) 1992 - 1998 C.Graham
+ *                                 1999 - 2003 H.Robbers
+ *                                        2004 F.Naumann & O.Skancke
+ *
+ * A multitasking AES replacement for FreeMiNT
+ *
+ * This file is part of XaAES.
+ *
+ * XaAES is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * XaAES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with XaAES; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Backing store for window work areas.
+ *
+ * With backing_store = yes XaAES keeps a copy of the work area of
+ * client windows. The copy is taken from the screen just before
+ * something is put over a window (opening, topping or moving another
+ * window, moving the window itself), but only while the work area is
+ * completely visible and no redraw is outstanding. When the window is
+ * uncovered or moved, generate_redraws() blits the exposed parts back
+ * instead of sending WM_REDRAW, so the client isn't woken up at all.
+ *
+ * XaAES can't see the client drawing, so a copy is dropped as soon as
+ * the client might draw: on wind_update(BEG_UPDATE) and when it asks
+ * for the rectangle list of the window. A resized window loses its
+ * copy too. Whenever there is no valid copy the usual WM_REDRAW is
+ * sent.
+ *
+ * The copies live in TT/Fast RAM only. ST-RAM is left to the screen,
+ * DMA and old programs, so when kmalloc falls back to it the copy is
+ * given up and the window is redrawn as usual. The mode is only
+ * switched on if enough TT/Fast RAM is free, and the copies never
+ * take more than half of what was free at startup.
+ */
+
+#include "xa_types.h"
+#include "xa_global.h"
+
+#include "bstore.h"
+#include "mscall.h"
+#include "rectlist.h"
+#include "semaphores.h"
+
+#include "mint/mem.h"
+
+
+/* minimum of free TT/Fast RAM */
+#define BSTORE_MINFREE	(2L * 1024 * 1024)
+
+/* top of ST-RAM, TT/Fast RAM lies above */
+#define phys_top_st	(*(unsigned long *)0x42eL)
+
+static bool bstore_on = false;
+static long bstore_budget = 0;		/* bytes left for copies */
+
+void
+bstore_init(void)
+{
+	long screen_size, free;
+
+	bstore_on = false;
+
+	if (!cfg.backing_store)
+		return;
+
+	/* largest free TT/Fast RAM block, 0 on ST-RAM only machines */
+	free = m_xalloc(-1, F_ALTONLY);
+	screen_size = calc_back(&screen.r, screen.planes);
+
+	if (free < BSTORE_MINFREE || free < 4 * screen_size)
+	{
+		BLOG((false, "backing store disabled: only %ld bytes TT/Fast RAM free", free));
+		return;
+	}
+
+	bstore_budget = free / 2;
+	bstore_on = true;
+
+	BLOG((false, "backing store enabled: %ld bytes for window copies", bstore_budget));
+}
+
+static bool
+bstore_usable(struct xa_window *w)
+{
+	if (!bstore_on || w == root_window || w->nolist || w->dial)
+		return false;
+
+	/* windows of XaAES itself are redrawn internally anyway */
+	if (w->owner == C.Aes || w->owner == C.Hlp || !w->send_message)
+		return false;
+
+	if ((w->owner->status & CS_EXITING))
+		return false;
+
+	return (w->window_status & (XAWS_OPEN|XAWS_ICONIFIED|XAWS_SHADED|XAWS_HIDDEN|XAWS_BELOWROOT)) == XAWS_OPEN;
+}
+
+/*
+ * true if the screen might not show the final contents of the work area
+ */
+static bool
+redraw_pending(struct xa_window *w)
+{
+	struct xa_client *client = w->owner;
+	struct xa_aesmsg_list *msg;
+
+	if (w->rect_lock || client->lost_rdrw_msg || update_locked() == client->p)
+		return true;
+
+	for (msg = client->rdrw_msg; msg; msg = msg->next)
+	{
+		if (msg->message.m[0] == WM_REDRAW && msg->message.m[3] == w->handle)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * kmalloc() a copy, but never in ST-RAM
+ */
+static struct xa_bstore *
+bstore_alloc(long size)
+{
+	struct xa_bstore *bs = kmalloc(sizeof(*bs) + size);
+
+	if (bs && (unsigned long)bs < phys_top_st)
+	{
+		DIAGS(("bstore_alloc: %ld bytes only in ST-RAM", size));
+		kfree(bs);
+		bs = NULL;
+	}
+
+	return bs;
+}
+
+void
+bstore_free(struct xa_window *w)
+{
+	if (w->bstore)
+	{
+		bstore_budget += w->bstore->size;
+		kfree(w->bstore);
+		w->bstore = NULL;
+	}
+}
+
+void
+bstore_invalidate(struct xa_window *w)
+{
+	if (w->bstore)
+		w->bstore->valid = false;
+}
+
+void
+bstore_invalidate_client(struct xa_client *client)
+{
+	struct xa_window *w;
+
+	for (w = window_list; w; w = w->next)
+	{
+		if (w->owner == client)
+			bstore_invalidate(w);
+	}
+}
+
+/*
+ * The screen is going to be repainted for other reasons (palette,
+ * refresh), no copy can be trusted anymore
+ */
+void
+bstore_invalidate_all(void)
+{
+	struct xa_window *w;
+
+	for (w = window_list; w; w = w->next)
+		bstore_invalidate(w);
+}
+
+/*
+ * Copy the work area of 'w' from the screen if it's completely visible
+ */
+void
+bstore_save(struct xa_window *w)
+{
+	struct xa_bstore *bs = w->bstore;
+	struct xa_rect_list *rl;
+	MFDB Mscreen = { 0 };
+	short pnt[8];
+	long size;
+
+	if (!bstore_usable(w))
+		return;
+
+	if (bs && bs->valid
+	    && bs->m.fd_w == w->rwa.g_w && bs->m.fd_h == w->rwa.g_h)
+		return;
+
+	if (w->rwa.g_w <= 0 || w->rwa.g_h <= 0 || redraw_pending(w))
+		return;
+
+	for (rl = w->rect_list.start; rl; rl = rl->next)
+	{
+		if (is_inside(&w->rwa, &rl->r))
+			break;
+	}
+	if (!rl)
+		return;
+
+	size = calc_back(&w->rwa, screen.planes);
+
+	if (bs && bs->size != size)
+	{
+		bstore_free(w);
+		bs = NULL;
+	}
+
+	if (!bs)
+	{
+		if (size > bstore_budget)
+			return;
+
+		bs = bstore_alloc(size);
+		if (!bs)
+			return;
+
+		bs->size = size;
+		bstore_budget -= size;
+		w->bstore = bs;
+	}
+
+	bs->m.fd_addr = bs + 1;
+	bs->m.fd_w = w->rwa.g_w;
+	bs->m.fd_h = w->rwa.g_h;
+	bs->m.fd_wdwidth = (w->rwa.g_w + 15) >> 4;
+	bs->m.fd_stand = 0;
+	bs->m.fd_nplanes = screen.planes;
+
+	(*xa_vdiapi->rtopxy)(pnt, &w->rwa);
+	(*xa_vdiapi->ritopxy)(pnt + 4, 0, 0, w->rwa.g_w, w->rwa.g_h);
+
+	hidem();
+	vro_cpyfm(C.P_handle, S_ONLY, pnt, &Mscreen, &bs->m);
+	showm();
+
+	bs->valid = true;
+
+	DIAGS(("bstore_save: %d of %s, %ld bytes", w->handle, w->owner->name, size));
+}
+
+/*
+ * Save all windows from 'wl' down to 'wend' (exclusive) that 'r' is
+ * about to cover
+ */
+void
+bstore_save_area(const GRECT *r, struct xa_window *wl, struct xa_window *wend)
+{
+	GRECT clip;
+
+	if (!bstore_on)
+		return;
+
+	for (; wl && wl != wend && wl != root_window; wl = wl->next)
+	{
+		if (xa_rect_clip(r, &wl->rwa, &clip))
+			bstore_save(wl);
+	}
+}
+
+/*
+ * Blit the visible parts of 'r' from the copy; false if there is none
+ * and the client must redraw
+ */
+bool
+bstore_restore(struct xa_window *w, const GRECT *r)
+{
+	struct xa_bstore *bs = w->bstore;
+	struct xa_rect_list *rl;
+	MFDB Mscreen = { 0 };
+	short pnt[8];
+	GRECT area, clip;
+	bool hidden = false;
+
+	if (!bs || !bs->valid || !bstore_usable(w))
+		return false;
+
+	if (bs->m.fd_w != w->rwa.g_w || bs->m.fd_h != w->rwa.g_h)
+	{
+		/* resized */
+		bstore_free(w);
+		return false;
+	}
+
+	if (!xa_rect_clip(&w->rwa, r, &area))
+		return true;
+
+	for (rl = w->rect_list.start; rl; rl = rl->next)
+	{
+		if (xa_rect_clip(&rl->r, &area, &clip))
+		{
+			if (!hidden)
+			{
+				hidem();
+				hidden = true;
+			}
+			(*xa_vdiapi->ritopxy)(pnt, clip.g_x - w->rwa.g_x, clip.g_y - w->rwa.g_y, clip.g_w, clip.g_h);
+			(*xa_vdiapi->rtopxy)(pnt + 4, &clip);
+			vro_cpyfm(C.P_handle, S_ONLY, pnt, &bs->m, &Mscreen);
+		}
+	}
+
+	if (hidden)
+		showm();
+
+	return true;
+}
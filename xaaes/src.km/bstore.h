@@ -0,0 +1,41 @@
+/*
+ * XaAES - XaAES Ain't the AES (c) 1992 - 1998 C.Graham
+ *                                 1999 - 2003 H.Robbers
+ *                                        2004 F.Naumann & O.Skancke
+ *
+ * A multitasking AES replacement for FreeMiNT
+ *
+ * This file is part of XaAES.
+ *
+ * XaAES is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * XaAES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with XaAES; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _bstore_h
+#define _bstore_h
+
+#include "global.h"
+
+void bstore_init(void);
+
+void bstore_save(struct xa_window *w);
+void bstore_save_area(const GRECT *r, struct xa_window *wl, struct xa_window *wend);
+bool bstore_restore(struct xa_window *w, const GRECT *r);
+
+void bstore_invalidate(struct xa_window *w);
+void bstore_invalidate_client(struct xa_client *client);
+void bstore_invalidate_all(void);
+void bstore_free(struct xa_window *w);
+
+#endif /* _bstore_h */
@@ -26,6 +26,7 @@
 #include "xa_global.h"
 
 #include "app_man.h"
+#include "bstore.h"
 #include "taskman.h"
 #include "desktop.h"
 #include "k_main.h"
@@ -679,7 +680,7 @@ hide_toolboxwindows(struct xa_client *client)
 // 			wi_move_belowroot(&S.open_windows, wind);
 // 			wind->window_status |= XAWS_BELOWROOT;
 // 			clear_wind_rectlist(wind);
-			update_windows_below(0, &wind->r, NULL, wl, NULL);
+			update_windows_below(0, &wind->r, NULL, wl, NULL, RDRW_ALL);
 		}
 		wind = nxt;
 	}
@@ -720,7 +721,7 @@ show_toolboxwindows(struct xa_client *client)
 					generate_redraws(0, wind, &clip, RDRW_ALL);
 				rl = rl->next;
 			}
-			update_windows_below(0, &wind->r, NULL, wind->next, NULL);
+			update_windows_below(0, &wind->r, NULL, wind->next, NULL, RDRW_ALL);
 		}
 		wind = wind->next;
 	}
@@ -1006,7 +1007,8 @@ generate_redraws(int lock, struct xa_window *wind, GRECT *r, short flags)
 			struct xa_widget *widg;
 			if (xa_rect_clip(&wind->rwa, r, &b))
 			{
-				send_redraw(lock, wind, &b);
+				if (!(flags & RDRW_BSTORE) || !bstore_restore(wind, &b))
+					send_redraw(lock, wind, &b);
 			}
 
 			if ((widg = usertoolbar_installed(wind)) )
@@ -1159,7 +1161,7 @@ bottom_window(int lock, bool snd_untopped, bool snd_ontop, struct xa_window *w)
 		DIAG((D_wind, w->owner, " - menu_owner %s, w_list_owner %s",
 			t_owner(get_menu()), w_owner(window_list)));
 
-		update_windows_below(lock, &w->r, NULL, wl, w);
+		update_windows_below(lock, &w->r, NULL, wl, w, RDRW_ALL);
 	}
 }
 
@@ -1528,7 +1530,7 @@ void remove_window_widgets(int lock, int full)
 		}
 		if( memcmp( &wind->r, &screen.r, sizeof(GRECT) ) )
 		{
-			update_windows_below(lock, &screen.r, NULL, window_list, NULL);
+			update_windows_below(lock, &screen.r, NULL, window_list, NULL, RDRW_ALL);
 		}
 	}
 }
@@ -1576,6 +1578,9 @@ open_window(int lock, struct xa_window *wind, GRECT r)
 		if ((wind->window_status & XAWS_SHADED))
 			wind->r.g_h = wind->sh;
 
+		if (!(wind->dial & created_for_SLIST) && !(wind->active_widgets & STORE_BACK))
+			bstore_save_area(&wind->r, window_list, NULL);
+
 		wind->window_status |= XAWS_OPEN;
 
 		make_rect_list(wind, true, RECT_SYS);
@@ -1694,6 +1699,9 @@ open_window(int lock, struct xa_window *wind, GRECT r)
 		set_active_client(lock, wind->owner);
 		swap_menu(lock|LOCK_DESK, wind->owner, NULL, SWAPM_DESK );
 	}
+	if (!(wind->window_status & XAWS_BELOWROOT))
+		bstore_save_area(&wind->r, wind->next, NULL);
+
 	make_rect_list(wind, true, RECT_SYS);
 	/*
 	 * Context dependant widgets must always follow the window
@@ -2021,6 +2029,7 @@ pull_wind_to_top(int lock, struct xa_window *w)
 		above = w->prev;
 		r = w->r;
 
+		bstore_save_area(&r, window_list, w);
 		wi_move_first(&S.open_windows, w);
 		wl = window_list;
 
@@ -2053,7 +2062,7 @@ pull_wind_to_top(int lock, struct xa_window *w)
 						break;
 					wl = wl->next;
 				}
-				update_windows_below(lock, &r, NULL, below, w);
+				update_windows_below(lock, &r, NULL, below, w, RDRW_ALL|RDRW_BSTORE);
 				break;
 			}
 			wl = wl->next;
@@ -2105,7 +2114,7 @@ static void redraw_menu_area(void)
 			rc.g_w -= rc.g_x;
 		}
 		rc.g_h = r.g_h;
-		update_windows_below(0, &rc, &rc, window_list, NULL);
+		update_windows_below(0, &rc, &rc, window_list, NULL, RDRW_ALL);
 		cfg.menu_bar = mb;
 		if( mb )
 			redraw_menu(0);
@@ -2289,6 +2298,13 @@ move_window(int lock, struct xa_window *wind, bool blit, WINDOW_STATUS newstate,
 	new.g_h = H;
 	old = wind->r;
 
+	/* keep what is about to be covered or exposed */
+	if ((wind->window_status & XAWS_OPEN) && !wind->nolist)
+	{
+		bstore_save(wind);
+		bstore_save_area(&new, wind->next, NULL);
+	}
+
 	if( BELOW_FOREIGN_MENU(old.g_y) )
 	{
 		blit = false;
@@ -2374,7 +2390,7 @@ move_window(int lock, struct xa_window *wind, bool blit, WINDOW_STATUS newstate,
 	if ((wind->window_status & XAWS_OPEN) && !(wind->dial & created_for_SLIST) && !(wind->active_widgets & STORE_BACK))
 	{
 		struct xa_window *nxt = wind->nolist ? (wind->next ? wind->next : window_list) : wind->next;
-		update_windows_below(lock, &old, &new, nxt, NULL);
+		update_windows_below(lock, &old, &new, nxt, NULL, RDRW_ALL|RDRW_BSTORE);
 	}
 
 	/*
@@ -2434,6 +2450,8 @@ close_window(int lock, struct xa_window *wind)
 	if (!(wind->dial & (created_for_SLIST|created_for_CALC)))
 		cancel_winctxt_popup(lock, wind, NULL);
 
+	bstore_free(wind);
+
 	if (wind->nolist)
 	{
 		DIAGS(("close_window: nolist window %d, bkg=%lx",
@@ -2458,7 +2476,7 @@ close_window(int lock, struct xa_window *wind)
 
 			r = wind->r;
 			if (!(wind->active_widgets & STORE_BACK) && !C.shutdown )
-				update_windows_below(lock, &r, NULL, wl, NULL);
+				update_windows_below(lock, &r, NULL, wl, NULL, RDRW_ALL|RDRW_BSTORE);
 
 			unset_focus(wind);
 		}
@@ -2495,7 +2513,7 @@ close_window(int lock, struct xa_window *wind)
 			wl = window_list;
 
 		if( !C.shutdown )
-			update_windows_below(lock, &r, NULL, wl, NULL);
+			update_windows_below(lock, &r, NULL, wl, NULL, RDRW_ALL|RDRW_BSTORE);
 
 		if (is_top)
 		{
@@ -2647,6 +2665,7 @@ delete_window1(int lock, struct xa_window *wind)
 	}
 
 	clear_wind_rectlist(wind);
+	bstore_free(wind);
 
 	if (wind->widg_rows)
 		kfree(wind->widg_rows);
@@ -2826,7 +2845,7 @@ update_all_windows(int lock, struct xa_window *wl)
  * defines the clip rectangle.
  */
 void
-update_windows_below(int lock, const GRECT *old, GRECT *new, struct xa_window *wl, struct xa_window *wend)
+update_windows_below(int lock, const GRECT *old, GRECT *new, struct xa_window *wl, struct xa_window *wend, short flags)
 {
 	GRECT clip;
 	int wlock = lock | LOCK_WINLIST;
@@ -2856,7 +2875,7 @@ update_windows_below(int lock, const GRECT *old, GRECT *new, struct xa_window *w
 				{
 					if (xa_rect_clip(&rl->r, &clip, &d))
 					{
-						generate_redraws(wlock, wl, &d, RDRW_ALL);
+						generate_redraws(wlock, wl, &d, flags);
 					}
 					rl = rl->next;
 				}
@@ -3773,10 +3792,10 @@ set_and_update_window(struct xa_window *wind, bool blit, bool only_wa, GRECT *ne
 					}
 					else if (!resize && !only_wa)
 					{
-						flags = RDRW_ALL;
+						flags = RDRW_ALL|RDRW_BSTORE;
 					}
 					else
-						flags = RDRW_WA;
+						flags = RDRW_WA|RDRW_BSTORE;
 
 					if( flags )
 					{
@@ -3812,7 +3831,7 @@ set_and_update_window(struct xa_window *wind, bool blit, bool only_wa, GRECT *ne
 		} /* if (brl) */
 		else
 		{
-			short flags = only_wa ? RDRW_WA : RDRW_ALL;
+			short flags = (only_wa ? RDRW_WA : RDRW_ALL) | RDRW_BSTORE;
 			newrl = wind->rect_list.start;
 			while (newrl)
 			{
@@ -3823,7 +3842,7 @@ set_and_update_window(struct xa_window *wind, bool blit, bool only_wa, GRECT *ne
 	}
 	else if (newrl)
 	{
-		short flags = only_wa ? RDRW_WA : RDRW_ALL;
+		short flags = (only_wa ? RDRW_WA : RDRW_ALL) | RDRW_BSTORE;
 		while (newrl)
 		{
 			bool joined = false;
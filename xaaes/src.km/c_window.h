@@ -83,7 +83,7 @@ void	display_window(int lock, int which, struct xa_window *w, GRECT *clip);
 bool clip_off_menu( GRECT *cl );
 void	draw_window(int lock, struct xa_window *wind, const GRECT *clip);
 void	update_all_windows(int lock, struct xa_window *wl);
-void	update_windows_below(int lock, const GRECT *old, GRECT *new, struct xa_window *wl, struct xa_window *wend);
+void	update_windows_below(int lock, const GRECT *old, GRECT *new, struct xa_window *wl, struct xa_window *wend, short flags);
 void	redraw_client_windows(int lock, struct xa_client *client);
 
 GRECT	free_icon_pos(int lock, struct xa_window *ignore);
@@ -87,6 +87,7 @@ static struct parser_item parser_tab[] =
 	{ "LOGFILE",               PI_R_T,     C.bootlog_path          , { dat: sizeof(C.bootlog_path)    } },
 	{ "LOGLVL",                PI_R_S,   & C.loglvl   },
 	{ "SAVE_WINDOWS",          PI_R_B,   & cfg.save_windows},
+	{ "BACKING_STORE",         PI_R_B,   & cfg.backing_store},
 	{ "LANG",                  PI_R_T,     cfg.lang		             , { dat: sizeof(cfg.lang)   } },
 	{ "FOCUS",                 PI_R_T,     cfg.focus	             , { dat: sizeof(cfg.focus)   } },
 	{ "PALETTE",               PI_R_T,     cfg.palette             , { dat: sizeof(cfg.palette)   } },
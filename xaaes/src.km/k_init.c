@@ -33,6 +33,7 @@
 #include "xaaes.h"
 
 #include "app_man.h"
+#include "bstore.h"
 #include "c_window.h"
 #include "desktop.h"
 #include "init.h"
@@ -889,6 +890,8 @@ k_init(unsigned short dev, unsigned short mc)
 	BLOG((false, "Display Device: Phys_handle=%d, Virt_handle=%d", C.P_handle, v->handle));
 	BLOG((false, " size=[%d,%d], colours=%d, bitplanes=%d", screen.r.g_w, screen.r.g_h, screen.colours, screen.planes));
 
+	bstore_init();
+
 
 	/* Load the system resource files
 	 */
@@ -31,6 +31,7 @@
 #include "about.h"
 #include "app_man.h"
 #include "xa_appl.h"
+#include "bstore.h"
 #include "c_window.h"
 #include "cnf_xaaes.h"
 #include "desktop.h"
@@ -808,7 +809,8 @@ kernel_key(int lock, struct rawkey *key)
 		case NK_HOME:				/*     "    Home       "     */
 			if( C.update_lock )
 				return true;
-			update_windows_below(lock, &screen.r, NULL, window_list, NULL);
+			bstore_invalidate_all();
+			update_windows_below(lock, &screen.r, NULL, window_list, NULL, RDRW_ALL);
 			redraw_menu(lock);
 			return true;
 		case 'M':				/* ctrl+alt+M  recover mouse */
@@ -47,6 +47,7 @@
 #include "about.h"
 #include "app_man.h"
 #include "adiload.h"
+#include "bstore.h"
 #include "c_window.h"
 #include "cnf_xaaes.h"
 #include "xacookie.h"
@@ -1610,7 +1611,8 @@ void load_grd( void *fn )
 {
 #if WITH_GRADIENTS
 	load_gradients( 0, fn );
-	update_windows_below(0, &screen.r, NULL, window_list, NULL);
+	bstore_invalidate_all();
+	update_windows_below(0, &screen.r, NULL, window_list, NULL, RDRW_ALL);
 	redraw_menu(0);
 #endif
 }
@@ -1619,7 +1621,8 @@ void load_bkg_img( void *fn )
 {
 #if WITH_BKG_IMG
 	do_bkg_img(C.Aes, 3, fn);
-	update_windows_below(0, &screen.r, NULL, window_list, NULL);
+	bstore_invalidate_all();
+	update_windows_below(0, &screen.r, NULL, window_list, NULL, RDRW_ALL);
 #endif
 }
 void load_palette( void *fn )
@@ -1627,7 +1630,8 @@ void load_palette( void *fn )
 	if( !rw_syspalette( READ, screen.palette, 0, fn ) )
 	{
 		set_syspalette(C.Aes->vdi_settings->handle, screen.palette);
-		update_windows_below(0, &screen.r, NULL, window_list, NULL);
+		bstore_invalidate_all();
+	update_windows_below(0, &screen.r, NULL, window_list, NULL, RDRW_ALL);
 	}
 }
 
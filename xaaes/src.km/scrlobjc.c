@@ -80,6 +80,7 @@ static void
 slist_msg_handler(struct xa_window *wind, struct xa_client *to, short amq, short qmf, short *msg);
 
 static void entry_action(struct scroll_info *list, struct scroll_entry *this, const struct moose_data *md);
+static void invalidate_rows(SCROLL_INFO *list);
 
 /*static*/ struct xa_wtxt_inf default_fnt =
 {
@@ -566,6 +567,85 @@ calc_entry_wh(SCROLL_INFO *list, SCROLL_ENTRY *this)
 	return fullredraw;
 }
 
+/*
+ * Entries added with SIF_BULKLOAD are measured when they
+ * are displayed for the first time.
+ * Returns true if the size of the list changed.
+ */
+static bool
+layout_entry(SCROLL_INFO *list, SCROLL_ENTRY *this)
+{
+	short h = this->r.g_h;
+	bool changed = false;
+
+	this->iflags &= ~SEF_NOLAYOUT;
+
+	/* the height was only borrowed from the first entry */
+	this->r.g_h = 0;
+	calc_entry_wh(list, this);
+
+	if (this->r.g_w > list->widest)
+	{
+		list->widest = this->r.g_w;
+		changed = true;
+	}
+
+	if (this->r.g_h != h)
+	{
+		list->total_h += this->r.g_h - h;
+		if (this->r.g_h > list->highest)
+			list->highest = this->r.g_h;
+		invalidate_rows(list);
+		changed = true;
+	}
+
+	return changed;
+}
+
+/*
+ * Quick width of the entries SIF_BULKLOAD left unmeasured, from the
+ * number of characters like calc_entry_wh does for unproportional
+ * fonts; layout_entry replaces it by the real width later.
+ */
+static void
+guess_widths(SCROLL_INFO *list)
+{
+	SCROLL_ENTRY *this;
+
+	if (!list->char_width)
+		return;
+
+	for (this = list->start; this; this = next_entry(this, ENT_VISIBLE, -1, NULL))
+	{
+		struct se_content *c;
+		short w = 0;
+
+		if (!(this->iflags & SEF_NOLAYOUT))
+			continue;
+
+		for (c = this->content; c; c = c->next)
+		{
+			if (c->type == SECONTENT_TEXT)
+			{
+				short l = 0;
+
+				if (c->c.text.text)
+					l = (list->flags & SIF_INLINE_EFFECTS) ? calc_len(c->c.text.text) : c->c.text.slen;
+
+				w += list->char_width * l + 2;
+				if (c->c.text.icon.icon)
+					w += c->c.text.icon.r.g_w;
+			}
+			else if (c->type == SECONTENT_ICON)
+				w += c->c.icon.r.g_w + 2;
+		}
+
+		this->r.g_w = w;
+		if (w > list->widest)
+			list->widest = w;
+	}
+}
+
 
 static short
 draw_nesticon(struct xa_vdi_settings *v, short width, GRECT *xy, SCROLL_ENTRY *this)
@@ -1109,6 +1189,24 @@ draw_slist(int lock, SCROLL_INFO *list, SCROLL_ENTRY *entry, const GRECT *clip)
 	struct scroll_entry *this = list->top;
 	GRECT r, xy;
 
+	{
+		struct scroll_entry *e = this;
+		long y = -list->off_y;
+		bool changed = false;
+
+		/* lay out what is going to be displayed first */
+		while (e && y < wind->wa.g_h)
+		{
+			if ((e->iflags & SEF_NOLAYOUT) && layout_entry(list, e))
+				changed = true;
+			y += e->r.g_h;
+			e = next_entry(e, ENT_VISIBLE, -1, NULL);
+		}
+
+		if (changed)
+			list->slider(list, true);
+	}
+
 	if (xa_rect_clip(clip, &wind->wa, &r))
 	{
 		short TOP = 0;
@@ -1407,6 +1505,104 @@ find_widest(SCROLL_INFO *list, SCROLL_ENTRY *start)
 }
 
 
+/*
+ * Row index: the visible entries in display order with their y offset.
+ * Built on demand with one walk over the list and dropped whenever
+ * entries are added, removed, opened or closed.
+ */
+static void
+invalidate_rows(SCROLL_INFO *list)
+{
+	list->rows_valid = false;
+}
+
+static bool
+build_rows(SCROLL_INFO *list)
+{
+	struct scroll_entry *this;
+	long n = 0, y = 0;
+
+	if (list->rows_valid)
+		return true;
+
+	for (this = list->start; this; this = next_entry(this, ENT_VISIBLE, -1, NULL))
+	{
+		if (n == list->max_rows)
+		{
+			long max = list->max_rows ? list->max_rows << 1 : 256;
+			struct scroll_row *rows = kmalloc(max * sizeof(*rows));
+
+			if (!rows)
+				return false;
+
+			if (list->rows)
+			{
+				memcpy(rows, list->rows, n * sizeof(*rows));
+				kfree(list->rows);
+			}
+			list->rows = rows;
+			list->max_rows = max;
+		}
+		list->rows[n].e = this;
+		list->rows[n].y = y;
+		this->row = n++;
+		y += this->r.g_h;
+	}
+
+	list->num_rows = n;
+	list->rows_valid = true;
+
+	return true;
+}
+
+/*
+ * Row containing y, -1 if there is none
+ */
+static long
+find_row(SCROLL_INFO *list, long y)
+{
+	long lo = 0, hi = list->num_rows - 1, ret = -1;
+
+	if (y < 0)
+		return -1;
+
+	while (lo <= hi)
+	{
+		long mid = (lo + hi) >> 1;
+
+		if (list->rows[mid].y <= y)
+		{
+			ret = mid;
+			lo = mid + 1;
+		}
+		else
+			hi = mid - 1;
+	}
+
+	if (ret >= 0 && y >= list->rows[ret].y + list->rows[ret].e->r.g_h)
+		ret = -1;
+
+	return ret;
+}
+
+/*
+ * Make y the first displayed line without walking the list
+ */
+static bool
+seek_row(SCROLL_INFO *list, long y)
+{
+	long i;
+
+	if (!build_rows(list) || (i = find_row(list, y)) < 0)
+		return false;
+
+	list->top = list->rows[i].e;
+	list->off_y = y - list->rows[i].y;
+	list->start_y = y;
+
+	return true;
+}
+
 static int
 get_entry_lrect(struct scroll_info *l, struct scroll_entry *e, short flags, LRECT *r)
 {
@@ -1416,7 +1612,12 @@ get_entry_lrect(struct scroll_info *l, struct scroll_entry *e, short flags, LREC
 
 	PRDEF( get_entry_lrect, next_entry );
 
-	while (this)
+	if (e && build_rows(l) && e->row < l->num_rows && l->rows[e->row].e == e)
+	{
+		this = e;
+		y = l->rows[e->row].y;
+	}
+	else while (this)
 	{
 		if (e == this)
 			break;
@@ -1997,6 +2198,9 @@ insert_icon(struct scroll_entry *this, short index, OBJECT *icon)
 	return this_sc;
 }
 #endif
+static void
+sort_siblings(SCROLL_INFO *list, SCROLL_ENTRY *this, scrl_compare *greater);
+
 static int
 set(SCROLL_INFO *list,
     SCROLL_ENTRY *entry,
@@ -2141,6 +2345,7 @@ m_state_done:
 				if (xstate != entry->xstate)
 				{
 					entry->xstate = xstate;
+					invalidate_rows(list);
 
 					if (entry->down)
 					{
@@ -2195,6 +2400,7 @@ m_state_done:
 				{
 					get_entry_lrect(list, entry, 1, &r);
 					entry->xstate = xstate;
+					invalidate_rows(list);
 					if (entry->down)
 					{
 						if ((r.w || r.h))
@@ -2283,6 +2489,7 @@ m_state_done:
 				list->flags |= SIF_TREEVIEW;
 			else
 				list->flags &= ~SIF_TREEVIEW;
+			invalidate_rows(list);
 			if (rdrw)
 			{
 				list->redraw(list, NULL);
@@ -2380,6 +2587,7 @@ m_state_done:
 							*setext->fnt = *t->fnt;
 					}
 					frdrw = calc_entry_wh(list, entry);
+					invalidate_rows(list);
 				}
 				if (rdrw)
 				{
@@ -2423,6 +2631,45 @@ m_state_done:
 				list->wi->parent = parent;
 			break;
 		}
+		case SESET_BULKLOAD:
+		{
+			/*
+			 * arg != 0: following sorted adds only append,
+			 * arg == 0: sort what was added and lay out the list
+			 */
+			if (arg)
+			{
+				if (!(list->flags & SIF_TREEVIEW))
+				{
+					list->flags |= SIF_BULKLOAD;
+					list->bulk_last = NULL;
+					list->bulk_sort = NULL;
+				}
+			}
+			else if ((list->flags & SIF_BULKLOAD))
+			{
+				list->flags &= ~SIF_BULKLOAD;
+
+				if (list->bulk_sort && list->bulk_last)
+					sort_siblings(list, list->bulk_last, list->bulk_sort);
+
+				list->bulk_last = NULL;
+				list->bulk_sort = NULL;
+
+				guess_widths(list);
+
+				invalidate_rows(list);
+				if (!seek_row(list, list->start_y))
+				{
+					list->top = list->start;
+					list->start_y = list->off_y = 0;
+				}
+
+				if (rdrw)
+					list->redraw(list, NULL);
+			}
+			break;
+		}
 	}
 
 	if (redrw)
@@ -2892,6 +3139,75 @@ sort_entry(SCROLL_INFO *list, SCROLL_ENTRY **start, SCROLL_ENTRY *new, scrl_comp
 	else
 		*start = list->start;
 }
+
+/*
+ * Sort the siblings of 'this' in place: bottom up merge sort on the
+ * linked list, stable and n log n calls of 'greater'.
+ */
+static void
+sort_siblings(SCROLL_INFO *list, SCROLL_ENTRY *this, scrl_compare *greater)
+{
+	SCROLL_ENTRY *up = this->up, *head, *prev;
+	long k, merges;
+
+	while (this->prev)
+		this = this->prev;
+	head = this;
+
+	for (k = 1; ; k <<= 1)
+	{
+		SCROLL_ENTRY *p = head, *q, *e, *tail = NULL;
+		long psize, qsize;
+
+		head = NULL;
+		merges = 0;
+
+		while (p)
+		{
+			merges++;
+
+			for (q = p, psize = 0; q && psize < k; psize++)
+				q = q->next;
+			qsize = k;
+
+			while (psize > 0 || (qsize > 0 && q))
+			{
+				if (!psize)
+				{
+					e = q, q = q->next, qsize--;
+				}
+				else if (!qsize || !q || !(*greater)(list, p, q))
+				{
+					e = p, p = p->next, psize--;
+				}
+				else
+				{
+					e = q, q = q->next, qsize--;
+				}
+
+				if (tail)
+					tail->next = e;
+				else
+					head = e;
+				tail = e;
+			}
+			p = q;
+		}
+		tail->next = NULL;
+
+		if (merges <= 1)
+			break;
+	}
+
+	for (prev = NULL, this = head; this; prev = this, this = this->next)
+		this->prev = prev;
+
+	if (up)
+		up->down = head;
+	else
+		list->start = head;
+}
+
 /* better control over the content of scroll_entry. */
 static int
 add_scroll_entry(SCROLL_INFO *list,
@@ -2960,7 +3276,16 @@ add_scroll_entry(SCROLL_INFO *list,
 		{
 			((struct se_content *)new->content)->c.text.h = list->start->r.g_h;
 		}
-		PROFRECv(calc_entry_wh,(list, new));
+		if ((list->flags & SIF_BULKLOAD) && list->start)
+		{
+			/* measured when it gets displayed */
+			new->r.g_h = list->start->r.g_h;
+			new->iflags |= SEF_NOLAYOUT;
+		}
+		else
+			PROFRECv(calc_entry_wh,(list, new));
+
+		invalidate_rows(list);
 
 		if (parent)
 		{
@@ -2988,7 +3313,18 @@ add_scroll_entry(SCROLL_INFO *list,
 		}
 		else
 		{
-			if (sort)
+			if (sort && (list->flags & SIF_BULKLOAD))
+			{
+				/* append, SESET_BULKLOAD sorts them all at the end */
+				if (list->bulk_last && list->bulk_last->up == here->up)
+					here = list->bulk_last;
+				while (here->next)
+					here = here->next;
+
+				list->bulk_sort = sort;
+				addmode &= ~SEADD_PRIOR;
+			}
+			else if (sort)
 			{
 				bool usecur = false;
 
@@ -3092,6 +3428,18 @@ add_scroll_entry(SCROLL_INFO *list,
 			}
 		}
 
+		if ((list->flags & SIF_BULKLOAD))
+		{
+			list->bulk_last = new;
+
+			if (new->r.g_w > list->widest)
+				list->widest = new->r.g_w;
+			if (new->r.g_h > list->highest)
+				list->highest = new->r.g_h;
+			list->total_h += new->r.g_h;
+			return 1;
+		}
+
 		if ( (list->flags & SIF_TREEVIEW))
 		{
 			PROFRECv(get_entry_lrect,(list, new, 0, &r));
@@ -3243,6 +3591,9 @@ free_scroll_entry(struct scroll_info *list, struct scroll_entry *this, long *hei
 		return this;
 	}
 
+	invalidate_rows(list);
+	list->bulk_last = NULL;
+
 	this = this->down;
 
 	while (this && level)
@@ -3605,27 +3956,30 @@ scroll_up(SCROLL_INFO *list, long num, bool rdrw)
 	else
 		list->flags &= ~OS_SLID;
 
-	while (n > 0 && (next = next_entry(this, ENT_VISIBLE, -1, NULL)))
+	if (!seek_row(list, list->start_y + n))
 	{
-		h = this->r.g_h;
-		if (list->off_y)
-			h -= list->off_y;
+		while (n > 0 && (next = next_entry(this, ENT_VISIBLE, -1, NULL)))
+		{
+			h = this->r.g_h;
+			if (list->off_y)
+				h -= list->off_y;
 
-		n -= h;
+			n -= h;
 
-		if (n < 0)
-		{
-			list->off_y = n + this->r.g_h;
-			list->start_y += (n + h);
-		}
-		else
-		{
-			list->off_y = 0;
-			list->start_y += h;
-			this = next;
+			if (n < 0)
+			{
+				list->off_y = n + this->r.g_h;
+				list->start_y += (n + h);
+			}
+			else
+			{
+				list->off_y = 0;
+				list->start_y += h;
+				this = next;
+			}
 		}
+		list->top = this;
 	}
-	list->top = this;
 
 	if (rdrw)
 	{
@@ -3674,7 +4028,7 @@ scroll_down(SCROLL_INFO *list, long num, bool rdrw)
 
 	n = max;
 
-	if (list->top)
+	if (list->top && !seek_row(list, list->start_y - n))
 	{
 		while (n > 0 && ((prev = prev_entry(list->top, ENT_VISIBLE)) || list->off_y))
 		{
@@ -4356,6 +4710,11 @@ unset_G_SLIST(struct scroll_info *list)
 		kfree(list->tabs);
 	}
 
+	if (list->rows)
+	{
+		kfree(list->rows);
+	}
+
 	*ob = list->prev_ob;
 	if (list->flags & SIF_KMALLOC)
 		kfree(list);
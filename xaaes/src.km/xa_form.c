@@ -33,6 +33,7 @@
 #include "xaaes.h"
 
 #include "form.h"
+#include "bstore.h"
 #include "c_window.h"
 #include "k_main.h"
 #include "k_mouse.h"
@@ -908,8 +909,11 @@ XA_form_dial(int lock, struct xa_client *client, AESPB *pb)
 			delete_window(lock, wind);
 		}
 		else
+		{
 			/* This was just a redraw request */
-			update_windows_below(lock, (const GRECT *)(&(pb->intin[5])), NULL, window_list, NULL);
+			bstore_invalidate_client(client);
+			update_windows_below(lock, (const GRECT *)(&(pb->intin[5])), NULL, window_list, NULL, RDRW_ALL);
+		}
 
 		bzero(&client->fmd, sizeof(client->fmd));
 		break;
@@ -1331,6 +1331,10 @@ read_directory(struct fsel_data *fs, SCROLL_INFO *list, SCROLL_ENTRY *dir_ent)
 			struct xattr xat, *x;
 			int num = 0, max_namlen = 0, max_szlen = 0;
 
+			/* sort once at the end instead of on every add */
+			if (!fs->rtbuild && !dir_ent)
+				list->set(list, NULL, SESET_BULKLOAD, 1, NOREDRAW);
+
 			while (PROFREC(d_xreaddir,(NAME_MAX, i, nm, &xat, &rep) == 0))
 			{
 				struct scroll_content sc = {{0}};
@@ -1518,6 +1522,8 @@ read_directory(struct fsel_data *fs, SCROLL_INFO *list, SCROLL_ENTRY *dir_ent)
 			d_closedir(i);
 			match_pattern( 0, 0, false);	/* de-init */
 
+			list->set(list, NULL, SESET_BULKLOAD, 0, NOREDRAW);
+
 			/* this is not elaborated
 			 * try to adapt the 1st distance
 			 */
@@ -49,6 +49,7 @@
 #define RDRW_WA		1
 #define RDRW_EXT	2
 #define RDRW_ALL	(RDRW_WA|RDRW_EXT)
+#define RDRW_BSTORE	4	/* work area may be restored from the backing store */
 
 /*
  * 'which' parameter for set_client_mouse() in xa_graf.c
@@ -1437,6 +1438,16 @@ struct xa_wc_cache
 };
 
 /* Window Descriptor */
+/*
+ * Backing store of a windows work area (cfg.backing_store)
+ */
+struct xa_bstore
+{
+	MFDB	m;		/* fd_addr points behind this struct */
+	long	size;		/* bytes allocated for the raster */
+	bool	valid;		/* false once the owner may have drawn */
+};
+
 struct xa_window
 {
 	struct xa_window	*next;	/* Window list stuff - next is the window below */
@@ -1558,6 +1569,8 @@ struct xa_window
 
 	struct xa_data_hdr *xa_data;
 	struct wdlg_info *wdlg;
+
+	struct xa_bstore *bstore;	/* Copy of the work area, see bstore.c */
 };
 
 extern struct xa_window *root_window;
@@ -1573,6 +1586,7 @@ typedef unsigned short SCROLL_ENTRY_TYPE;
 
 #define SEF_WTXTALLOC 0x0001
 #define SEF_WCOLALLOC 0x0002
+#define SEF_NOLAYOUT  0x0004	/* not measured yet, done when it gets displayed */
 typedef unsigned short SCROLL_ENTRY_FLAGS;
 
 #define SIF_KMALLOC		0x0001
@@ -1589,6 +1603,7 @@ typedef unsigned short SCROLL_ENTRY_FLAGS;
 #define SIF_INLINE_EFFECTS	0x0800
 #define SIF_NO_ICONS	0x1000
 #define SIF_ICONS_HAVE_NO_TEXT 0x2000
+#define SIF_BULKLOAD	0x4000	/* SESET_BULKLOAD: append unsorted, sort at the end */
 typedef unsigned short SCROLL_INFO_FLAGS;
 
 #define SETAB_RJUST		0x0001
@@ -1747,6 +1762,8 @@ typedef struct scroll_entry * scrl_search(struct scroll_info *list, struct scrol
 
 #define SESET_PRNTWIND		17
 
+#define SESET_BULKLOAD		18
+
 /* SESET_UNSELECTED arguments */
 #define UNSELECT_ONE	0
 #define UNSELECT_ALL	1
@@ -1901,9 +1918,20 @@ struct scroll_entry
 	long usr_flags;
 	void *data;
 	void (*data_destruct)(void *);
+	long row;			/* position in the row index of the list */
 };
 typedef struct scroll_entry SCROLL_ENTRY;
 
+/*
+ * Row index of a scroll list: the visible entries in display order
+ * with their y offset, for binary search by position.
+ */
+struct scroll_row
+{
+	SCROLL_ENTRY *e;
+	long y;
+};
+
 struct scroll_info
 {
 	struct scroll_info *next;	/* lists in one window linked */
@@ -1946,6 +1974,14 @@ struct scroll_info
 
 	short char_width;		/* remember char-width for this list */
 
+	struct scroll_row *rows;	/* row index, rebuilt on demand */
+	long num_rows;
+	long max_rows;
+	bool rows_valid;
+
+	SCROLL_ENTRY *bulk_last;	/* SIF_BULKLOAD: last entry appended */
+	scrl_compare *bulk_sort;
+
 	scrl_click *dclick;		/* Callback function for double click behaviour */
 	scrl_click *click;		/* Callback function for single click behaviour */
 	scrl_click *click_nesticon;
@@ -2726,6 +2762,7 @@ struct config
 	bool point_to_type;
 	bool fsel_cookie;
 	bool save_windows;
+	bool backing_store;		/* keep copies of window work areas (needs TT/Fast RAM) */
 #if EIFFEL_SUPPORT
 	bool eiffel_support;	/* generate wheel-events on special keys */
 #endif
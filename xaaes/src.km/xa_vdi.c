@@ -64,11 +64,50 @@ ritopxy(short *p, short x, short y, short w, short h)
 	*p   = y + h - 1;
 }
 
+/*
+ * Text metrics cache
+ *
+ * vqt_extent is expensive on NVDI and fVDI, and layout asks for the
+ * same few fonts all the time. Widths are kept per font (id, size,
+ * effects): the width of a string is the sum of the advances of its
+ * characters plus a constant part, which covers effects like italic
+ * or outline that widen a string only once. The advance of a character
+ * is asked for when it is first met; monospaced fonts need just one.
+ * Loading or unloading GDOS fonts flushes the cache.
+ */
+#define METRICS_FONTS	8
+
+struct fnt_metrics
+{
+	short id, point, effects;	/* as requested */
+	short h;			/* height as vqt_extent reports it */
+	short k;			/* constant part of the width */
+	short mono;			/* advance of every character if monospaced */
+	short first_ade, last_ade;
+	unsigned long used;		/* 0 = free slot */
+	short adv[256];			/* -1 = not known yet */
+};
+
+static struct fnt_metrics metrics[METRICS_FONTS];
+static unsigned long metrics_used = 0;
+
+static void
+flush_metrics(void)
+{
+	int i;
+
+	for (i = 0; i < METRICS_FONTS; i++)
+		metrics[i].used = 0;
+}
+
 static void _cdecl
 xa_load_fonts(struct xa_vdi_settings *v)
 {
 	if (v->fonts_loaded ==  -1)
+	{
 		v->fonts_loaded = C.gdos_version ? vst_load_fonts(v->handle, 0) : 0;
+		flush_metrics();
+	}
 }
 static void _cdecl
 xa_unload_fonts(struct xa_vdi_settings *v)
@@ -78,6 +117,7 @@ xa_unload_fonts(struct xa_vdi_settings *v)
 		if (C.gdos_version)
 			vst_unload_fonts(v->handle, 0);
 		v->fonts_loaded = -1;
+		flush_metrics();
 	}
 }
 
@@ -280,8 +320,8 @@ xa_t_alignment(struct xa_vdi_settings *v, short halign, short valign)
 	vst_alignment(v->handle, halign, valign, &dummy, &dummy);
 }
 
-static void _cdecl
-xa_t_extent(struct xa_vdi_settings *v, const char *t, short *w, short *h)
+static void
+t_extent_vdi(struct xa_vdi_settings *v, const char *t, short *w, short *h)
 {
 	short e[8];
 
@@ -295,20 +335,188 @@ xa_t_extent(struct xa_vdi_settings *v, const char *t, short *w, short *h)
 				 */
 }
 
+/*
+ * select the font of m for measuring
+ */
+static void
+metrics_begin(struct xa_vdi_settings *v, struct fnt_metrics *m)
+{
+	xa_t_font(v, m->point, m->id);
+
+	if (m->effects != v->text_effects)
+		vst_effects(v->handle, m->effects);
+}
+
+static void
+metrics_end(struct xa_vdi_settings *v, struct fnt_metrics *m)
+{
+	if (m->effects != v->text_effects)
+		vst_effects(v->handle, v->text_effects);
+}
+
+static struct fnt_metrics *
+get_metrics(struct xa_vdi_settings *v, short id, short point, short effects)
+{
+	struct fnt_metrics *m, *lru = metrics;
+	short wx, wxx, wi, ww, h;
+	int i;
+
+	if (id <= 0 || point <= 0)
+		return NULL;
+
+	for (m = metrics; m < metrics + METRICS_FONTS; m++)
+	{
+		if (m->used && m->id == id && m->point == point && m->effects == effects)
+		{
+			m->used = ++metrics_used;
+			return m;
+		}
+		if (m->used < lru->used)
+			lru = m;
+	}
+
+	m = lru;
+	m->id = id;
+	m->point = point;
+	m->effects = effects;
+
+	for (i = 0; i < 256; i++)
+		m->adv[i] = -1;
+
+	metrics_begin(v, m);
+
+	t_extent_vdi(v, "X", &wx, &m->h);
+	t_extent_vdi(v, "XX", &wxx, &h);
+	t_extent_vdi(v, "i", &wi, &h);
+	t_extent_vdi(v, "W", &ww, &h);
+
+	m->first_ade = v->first_ade;
+	m->last_ade = v->last_ade;
+
+	metrics_end(v, m);
+
+	m->k = (wx << 1) - wxx;
+	m->adv['X'] = wx - m->k;
+	m->adv['i'] = wi - m->k;
+	m->adv['W'] = ww - m->k;
+	m->mono = (wx == wi && wx == ww) ? m->adv['X'] : 0;
+
+	m->used = ++metrics_used;
+
+	return m;
+}
+
+static short
+char_adv(struct xa_vdi_settings *v, struct fnt_metrics *m, unsigned char c, bool *begun)
+{
+	if (m->mono)
+		return m->mono;
+
+	if (m->adv[c] < 0)
+	{
+		char s[2];
+		short w, h;
+
+		if (!*begun)
+		{
+			metrics_begin(v, m);
+			*begun = true;
+		}
+
+		s[0] = c;
+		s[1] = '\0';
+		t_extent_vdi(v, s, &w, &h);
+
+		w -= m->k;
+		m->adv[c] = w > 0 ? w : 0;
+	}
+
+	return m->adv[c];
+}
+
+static short
+text_width(struct xa_vdi_settings *v, struct fnt_metrics *m, const char *t)
+{
+	const unsigned char *s = (const unsigned char *)t;
+	bool begun = false;
+	long w = 0;
+
+	if (!*s)
+		return 0;
+
+	if (m->mono)
+		return strlen(t) * m->mono + m->k;
+
+	for (; *s; s++)
+		w += char_adv(v, m, *s, &begun);
+
+	if (begun)
+		metrics_end(v, m);
+
+	return w + m->k;
+}
+
+/*
+ * advance of c in the current font for clipping, false if the font
+ * doesn't have it (like vqt_width)
+ */
+static bool
+char_width(struct xa_vdi_settings *v, struct fnt_metrics *m, unsigned char c, short *cw)
+{
+	bool begun = false;
+	short tmp;
+
+	if (!m)
+		return vqt_width(v->handle, c, cw, &tmp, &tmp) != -1;
+
+	if (c < m->first_ade || c > m->last_ade)
+		return false;
+
+	*cw = char_adv(v, m, c, &begun);
+
+	if (begun)
+		metrics_end(v, m);
+
+	return true;
+}
+
+static void _cdecl
+xa_t_extent(struct xa_vdi_settings *v, const char *t, short *w, short *h)
+{
+	struct fnt_metrics *m = get_metrics(v, v->font_rid, v->font_rsize, v->text_effects);
+
+	if (m)
+	{
+		*w = text_width(v, m, t);
+		*h = m->h;
+	}
+	else
+		t_extent_vdi(v, t, w, h);
+}
+
 static void _cdecl
 xa_text_extent(struct xa_vdi_settings *v, const char *t, struct xa_fnt_info *f, short *w, short *h)
 {
+	struct fnt_metrics *m;
 	PRDEF( xa_text_extent, xa_t_font );
 	PRDEF( xa_text_extent, effects );
 	PRDEF( xa_text_extent, t_extent);
 
+	m = get_metrics(v, f->font_id, f->font_point, f->effects);
+	if (m)
+	{
+		*w = text_width(v, m, t);
+		*h = m->h;
+		return;
+	}
+
 	PROFRECv( xa_t_font,(v, f->font_point, f->font_id));
 
 	if( f->effects ){
 		PROFRECv( vst_effects,(v->handle, f->effects));
 	}
 
-	PROFRECv( xa_t_extent,(v, t, w, h));
+	PROFRECv( t_extent_vdi,(v, t, w, h));
 
 	if( f->effects ){
 		PROFRECv( vst_effects,(v->handle, 0));
@@ -318,8 +526,9 @@ xa_text_extent(struct xa_vdi_settings *v, const char *t, struct xa_fnt_info *f,
 static const char * _cdecl
 xa_prop_clipped_name(struct xa_vdi_settings *v, const char *s, char *d, int w, short *ret_w, short *ret_h, short method)
 {
+	struct fnt_metrics *m = get_metrics(v, v->font_rid, v->font_rsize, v->text_effects);
 	int swidth = 0;
-	short cw, tmp;
+	short cw;
 	char *dst = d;
 	char end[256];
 
@@ -346,7 +555,7 @@ xa_prop_clipped_name(struct xa_vdi_settings *v, const char *s, char *d, int w, s
 					else	 c = *s++;
 
 
-					if (vqt_width(v->handle, c, &cw, &tmp, &tmp) != -1)
+					if (char_width(v, m, c, &cw))
 					{
 						swidth += cw;
 						if (swidth > w)
@@ -394,7 +603,7 @@ xa_prop_clipped_name(struct xa_vdi_settings *v, const char *s, char *d, int w, s
 		{
 			for(; *s; s++)
 			{
-				if (vqt_width(v->handle, (unsigned char)*s, &cw, &tmp, &tmp) != -1)
+				if (char_width(v, m, (unsigned char)*s, &cw))
 				{
 					swidth += cw;
 
@@ -26,6 +26,7 @@
 #include "xa_global.h"
 
 #include "app_man.h"
+#include "bstore.h"
 #include "c_window.h"
 #include "desktop.h"
 #include "menuwidg.h"
@@ -1327,6 +1328,7 @@ XA_wind_get(int lock, struct xa_client *client, AESPB *pb)
 		DIAG((D_wind, client, "wind_xget: N_INTIN=%d, (%d/%d/%d/%d) on wind=%d for %s",
 			pb->control[N_INTIN], pb->intin[2], pb->intin[3], pb->intin[4], pb->intin[5], w->handle, client->name));
 
+		bstore_invalidate(w);
 		if (is_shaded(w))
 			ro->g_x = ro->g_y = ro->g_w = ro->g_h = 0;
 		else
@@ -1380,6 +1382,8 @@ XA_wind_get(int lock, struct xa_client *client, AESPB *pb)
 
 	case WF_FIRSTXYWH:	/* Generate a rectangle list and return the first entry */
 		w->use_rlc = false;
+		/* the client is going to draw */
+		bstore_invalidate(w);
 		if (is_shaded(w) || !get_rect(&w->rect_list, &w->rwa, true, ro))
 		{
 			ro->g_x = w->r.g_x;
@@ -1914,7 +1918,10 @@ XA_wind_update(int lock, struct xa_client *client, AESPB *pb)
 		if (lock_screen(p, try))
 		{
 			if (client)
+			{
 				client->fmd.lock |= SCREEN_UPD;
+				bstore_invalidate_client(client);
+			}
 			C.update_lock = p;
 			C.updatelock_count++;
 		}